@@ -300,6 +300,26 @@ const char *opus_strerror(int error)
       return error_strings[-error];
 }
 
+OpusAllocator opus_allocator = {NULL, NULL, NULL};
+
+int opus_set_allocator(opus_alloc_callback alloc_func,
+      opus_free_callback free_func, void *user_data)
+{
+#if defined(OVERRIDE_OPUS_ALLOC) || defined(OVERRIDE_OPUS_FREE)
+   (void)alloc_func;
+   (void)free_func;
+   (void)user_data;
+   return OPUS_UNIMPLEMENTED;
+#else
+   if ((alloc_func == NULL) != (free_func == NULL))
+      return OPUS_BAD_ARG;
+   opus_allocator.alloc_func = alloc_func;
+   opus_allocator.free_func = free_func;
+   opus_allocator.user_data = alloc_func ? user_data : NULL;
+   return OPUS_OK;
+#endif
+}
+
 const char *opus_get_version_string(void)
 {
     return "libopus " PACKAGE_VERSION
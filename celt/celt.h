@@ -144,6 +144,12 @@ int celt_encode_with_ec(OpusCustomEncoder * OPUS_RESTRICT st, const opus_val16 *
 int celt_encoder_init(CELTEncoder *st, opus_int32 sampling_rate, int channels,
                       int arch);
 
+int celt_encoder_get_snapshot_size(int channels);
+
+int celt_encoder_save(const CELTEncoder *st, unsigned char *snapshot);
+
+int celt_encoder_restore(CELTEncoder *st, const unsigned char *snapshot);
+
 
 
 /* Decoder stuff */
@@ -151,7 +157,8 @@ int celt_encoder_init(CELTEncoder *st, opus_int32 sampling_rate, int channels,
 int celt_decoder_get_size(int channels);
 
 
-int celt_decoder_init(CELTDecoder *st, opus_int32 sampling_rate, int channels);
+int celt_decoder_init(CELTDecoder *st, opus_int32 sampling_rate, int channels,
+                      int arch);
 
 int celt_decode_with_ec_dred(CELTDecoder * OPUS_RESTRICT st, const unsigned char *data,
       int len, opus_val16 * OPUS_RESTRICT pcm, int frame_size, ec_dec *dec, int accum
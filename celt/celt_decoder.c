@@ -70,6 +70,33 @@
 /*                                                                    */
 /**********************************************************************/
 #define DECODE_BUFFER_SIZE 2048
+/* The decoder history is a sliding window of DECODE_BUFFER_SIZE+overlap
+   samples inside a buffer that has DECODE_BUFFER_SLACK extra samples per
+   channel. Each frame advances the window rather than moving the whole
+   history, which only gets copied back to the start of the buffer once the
+   window reaches the end. Must be at least the largest frame size. */
+#define DECODE_BUFFER_SLACK 1024
+
+#ifdef COMPACT_DECODER
+/* The compact decoder keeps only the MDCT overlap at full precision. The rest
+   of the history is stored as 16-bit samples with one bit of headroom for the
+   pre-emphasised signal, and is expanded into a scratch window (with N samples
+   of slack) for the duration of each call. */
+#define DECODE_MEM_BYTES(overlap, C) ((C)*((overlap)*sizeof(celt_sig)+DECODE_BUFFER_SIZE*sizeof(opus_int16)))
+#define DECODE_MEM_BASE(st) ((st)->decode_work)
+#define DECODE_MEM_STRIDE(st) ((st)->decode_work_stride)
+#ifdef FIXED_POINT
+#define SIG2HIST(x) SATURATE16(PSHR32(x, SIG_SHIFT+1))
+#define HIST2SIG(x) SHL32(EXTEND32(x), SIG_SHIFT+1)
+#else
+#define SIG2HIST(x) ((opus_int16)float2int(MIN32(32767.f, MAX32(-32768.f, .5f*(x)))))
+#define HIST2SIG(x) (2.f*(x))
+#endif
+#else
+#define DECODE_MEM_BYTES(overlap, C) ((C)*(DECODE_BUFFER_SIZE+DECODE_BUFFER_SLACK+(overlap))*sizeof(celt_sig))
+#define DECODE_MEM_BASE(st) ((st)->_decode_mem)
+#define DECODE_MEM_STRIDE(st) (DECODE_BUFFER_SIZE+DECODE_BUFFER_SLACK+(st)->overlap)
+#endif
 
 #define PLC_UPDATE_FRAMES 4
 #define PLC_UPDATE_SAMPLES (PLC_UPDATE_FRAMES*FRAME_SIZE)
@@ -89,6 +116,11 @@ struct OpusCustomDecoder {
    int disable_inv;
    int complexity;
    int arch;
+#ifdef COMPACT_DECODER
+   /* Expanded history, only valid during a decode call */
+   celt_sig *decode_work;
+   int decode_work_stride;
+#endif
 
    /* Everything beyond this point gets cleared on a reset */
 #define DECODER_RESET_START rng
@@ -105,6 +137,7 @@ struct OpusCustomDecoder {
    int postfilter_tapset;
    int postfilter_tapset_old;
    int prefilter_and_fold;
+   int decode_mem_offset;
 
    celt_sig preemph_memD[2];
 
@@ -114,7 +147,7 @@ struct OpusCustomDecoder {
    float plc_preemphasis_mem;
 #endif
 
-   celt_sig _decode_mem[1]; /* Size = channels*(DECODE_BUFFER_SIZE+mode->overlap) */
+   celt_sig _decode_mem[1]; /* Size = DECODE_MEM_BYTES(mode->overlap, channels) */
    /* opus_val16 lpc[],  Size = channels*CELT_LPC_ORDER */
    /* opus_val16 oldEBands[], Size = 2*mode->nbEBands */
    /* opus_val16 oldLogE[], Size = 2*mode->nbEBands */
@@ -157,6 +190,8 @@ void validate_celt_decoder(CELTDecoder *st)
    celt_assert(st->postfilter_tapset >= 0);
    celt_assert(st->postfilter_tapset_old <= 2);
    celt_assert(st->postfilter_tapset_old >= 0);
+   celt_assert(st->decode_mem_offset >= 0);
+   celt_assert(st->decode_mem_offset <= DECODE_BUFFER_SLACK);
 }
 #endif
 
@@ -168,8 +203,8 @@ int celt_decoder_get_size(int channels)
 
 OPUS_CUSTOM_NOSTATIC int opus_custom_decoder_get_size(const CELTMode *mode, int channels)
 {
-   int size = sizeof(struct CELTDecoder)
-            + (channels*(DECODE_BUFFER_SIZE+mode->overlap)-1)*sizeof(celt_sig)
+   int size = sizeof(struct CELTDecoder) - sizeof(celt_sig)
+            + DECODE_MEM_BYTES(mode->overlap, channels)
             + channels*CELT_LPC_ORDER*sizeof(opus_val16)
             + 4*2*mode->nbEBands*sizeof(opus_val16);
    return size;
@@ -192,20 +227,8 @@ CELTDecoder *opus_custom_decoder_create(const CELTMode *mode, int channels, int
 }
 #endif /* CUSTOM_MODES */
 
-int celt_decoder_init(CELTDecoder *st, opus_int32 sampling_rate, int channels)
-{
-   int ret;
-   ret = opus_custom_decoder_init(st, opus_custom_mode_create(48000, 960, NULL), channels);
-   if (ret != OPUS_OK)
-      return ret;
-   st->downsample = resampling_factor(sampling_rate);
-   if (st->downsample==0)
-      return OPUS_BAD_ARG;
-   else
-      return OPUS_OK;
-}
-
-OPUS_CUSTOM_NOSTATIC int opus_custom_decoder_init(CELTDecoder *st, const CELTMode *mode, int channels)
+static int opus_custom_decoder_init_arch(CELTDecoder *st, const CELTMode *mode,
+      int channels, int arch)
 {
    if (channels < 0 || channels > 2)
       return OPUS_BAD_ARG;
@@ -228,13 +251,33 @@ OPUS_CUSTOM_NOSTATIC int opus_custom_decoder_init(CELTDecoder *st, const CELTMod
 #else
    st->disable_inv = 0;
 #endif
-   st->arch = opus_select_arch();
+   st->arch = arch;
 
    opus_custom_decoder_ctl(st, OPUS_RESET_STATE);
 
    return OPUS_OK;
 }
 
+OPUS_CUSTOM_NOSTATIC int opus_custom_decoder_init(CELTDecoder *st, const CELTMode *mode, int channels)
+{
+   return opus_custom_decoder_init_arch(st, mode, channels, opus_select_arch());
+}
+
+int celt_decoder_init(CELTDecoder *st, opus_int32 sampling_rate, int channels,
+                      int arch)
+{
+   int ret;
+   ret = opus_custom_decoder_init_arch(st,
+           opus_custom_mode_create(48000, 960, NULL), channels, arch);
+   if (ret != OPUS_OK)
+      return ret;
+   st->downsample = resampling_factor(sampling_rate);
+   if (st->downsample==0)
+      return OPUS_BAD_ARG;
+   else
+      return OPUS_OK;
+}
+
 #ifdef CUSTOM_MODES
 void opus_custom_decoder_destroy(CELTDecoder *st)
 {
@@ -496,6 +539,86 @@ static void tf_decode(int start, int end, int isTransient, int *tf_res, int LM,
    }
 }
 
+static opus_val16 *get_lpc(CELTDecoder * OPUS_RESTRICT st)
+{
+   return (opus_val16*)((char*)st->_decode_mem + DECODE_MEM_BYTES(st->overlap, st->channels));
+}
+
+static void get_decode_mem(CELTDecoder * OPUS_RESTRICT st, celt_sig *decode_mem[2], int CC)
+{
+   int c=0;
+   do {
+      decode_mem[c] = DECODE_MEM_BASE(st) + c*DECODE_MEM_STRIDE(st)
+            + st->decode_mem_offset;
+   } while (++c<CC);
+}
+
+/* Drops the oldest N samples of the history to make room for a new frame.
+   The N samples that were dropped remain readable just before the start of
+   the new window until the next call. */
+static void shift_decode_mem(CELTDecoder * OPUS_RESTRICT st, int N)
+{
+   int c;
+   int slack = DECODE_MEM_STRIDE(st)-DECODE_BUFFER_SIZE-st->overlap;
+   celt_assert(N <= slack);
+   if (st->decode_mem_offset+N > slack)
+   {
+      c=0; do {
+         celt_sig *buf = DECODE_MEM_BASE(st) + c*DECODE_MEM_STRIDE(st);
+         OPUS_MOVE(buf, buf+st->decode_mem_offset, DECODE_BUFFER_SIZE+st->overlap);
+      } while (++c<st->channels);
+      st->decode_mem_offset = 0;
+   }
+   st->decode_mem_offset += N;
+}
+
+#ifdef COMPACT_DECODER
+/* Samples at the start of the history that only the PLC reads. A decoded
+   frame needs at most MAX_PERIOD+2 samples of history for the post-filter. */
+#define DECODE_PLC_ONLY (DECODE_BUFFER_SIZE-MAX_PERIOD-2)
+
+/* Expands the stored history from sample first onwards into work, which must
+   hold channels*(DECODE_BUFFER_SIZE+N+overlap) samples. */
+static void expand_decode_mem(CELTDecoder * OPUS_RESTRICT st, celt_sig *work, int N, int first)
+{
+   int c, i;
+   const opus_int16 *hist;
+   st->decode_work = work;
+   st->decode_work_stride = DECODE_BUFFER_SIZE+N+st->overlap;
+   st->decode_mem_offset = 0;
+   hist = (const opus_int16*)(st->_decode_mem+st->channels*st->overlap);
+   c=0; do {
+      celt_sig *buf = work + c*st->decode_work_stride;
+      for (i=first;i<DECODE_BUFFER_SIZE;i++)
+         buf[i] = HIST2SIG(hist[c*DECODE_BUFFER_SIZE+i]);
+      OPUS_COPY(buf+DECODE_BUFFER_SIZE, st->_decode_mem+c*st->overlap, st->overlap);
+   } while (++c<st->channels);
+}
+
+/* Stores the history window back into the decoder state after it was shifted
+   by one frame. Samples before first were not expanded, so they are moved
+   within the stored history instead. */
+static void store_decode_mem(CELTDecoder * OPUS_RESTRICT st, int first)
+{
+   int c, i;
+   int N;
+   opus_int16 *hist;
+   celt_sig *decode_mem[2];
+   N = st->decode_mem_offset;
+   first = IMAX(0, first-N);
+   get_decode_mem(st, decode_mem, st->channels);
+   hist = (opus_int16*)(st->_decode_mem+st->channels*st->overlap);
+   c=0; do {
+      OPUS_MOVE(hist+c*DECODE_BUFFER_SIZE, hist+c*DECODE_BUFFER_SIZE+N, first);
+      for (i=first;i<DECODE_BUFFER_SIZE;i++)
+         hist[c*DECODE_BUFFER_SIZE+i] = SIG2HIST(decode_mem[c][i]);
+      OPUS_COPY(st->_decode_mem+c*st->overlap, decode_mem[c]+DECODE_BUFFER_SIZE, st->overlap);
+   } while (++c<st->channels);
+   st->decode_work = NULL;
+   st->decode_mem_offset = 0;
+}
+#endif
+
 static int celt_plc_pitch_search(celt_sig *decode_mem[2], int C, int arch)
 {
    int pitch_index;
@@ -525,9 +648,7 @@ static void prefilter_and_fold(CELTDecoder * OPUS_RESTRICT st, int N)
    overlap = st->overlap;
    CC = st->channels;
    ALLOC(etmp, overlap, opus_val32);
-   c=0; do {
-      decode_mem[c] = st->_decode_mem + c*(DECODE_BUFFER_SIZE+overlap);
-   } while (++c<CC);
+   get_decode_mem(st, decode_mem, CC);
 
    c=0; do {
       /* Apply the pre-filter to the MDCT overlap for the next frame because
@@ -628,11 +749,8 @@ static void celt_decode_lost(CELTDecoder * OPUS_RESTRICT st, int N, int LM
    overlap = mode->overlap;
    eBands = mode->eBands;
 
-   c=0; do {
-      decode_mem[c] = st->_decode_mem + c*(DECODE_BUFFER_SIZE+overlap);
-      out_syn[c] = decode_mem[c]+DECODE_BUFFER_SIZE-N;
-   } while (++c<C);
-   lpc = (opus_val16*)(st->_decode_mem+(DECODE_BUFFER_SIZE+overlap)*C);
+   get_decode_mem(st, decode_mem, C);
+   lpc = get_lpc(st);
    oldBandE = lpc+C*CELT_LPC_ORDER;
    oldLogE = oldBandE + 2*nbEBands;
    oldLogE2 = oldLogE + 2*nbEBands;
@@ -657,9 +775,10 @@ static void celt_decode_lost(CELTDecoder * OPUS_RESTRICT st, int N, int LM
       effEnd = IMAX(start, IMIN(end, mode->effEBands));
 
       ALLOC(X, C*N, celt_norm);   /**< Interleaved normalised MDCTs */
+      shift_decode_mem(st, N);
+      get_decode_mem(st, decode_mem, C);
       c=0; do {
-         OPUS_MOVE(decode_mem[c], decode_mem[c]+N,
-               DECODE_BUFFER_SIZE-N+overlap);
+         out_syn[c] = decode_mem[c]+DECODE_BUFFER_SIZE-N;
       } while (++c<C);
 
       if (st->prefilter_and_fold) {
@@ -726,6 +845,13 @@ static void celt_decode_lost(CELTDecoder * OPUS_RESTRICT st, int N, int LM
       ALLOC(fir_tmp, exc_length, opus_val16);
       exc = _exc+CELT_LPC_ORDER;
       window = mode->window;
+      /* Move the decoder history one frame to the left to give us room to
+         add the data for the new frame. We ignore the overlap that extends
+         past the end of the buffer, because we aren't going to use it. The
+         samples that were dropped are still needed for the excitation below
+         and remain available at negative offsets. */
+      shift_decode_mem(st, N);
+      get_decode_mem(st, decode_mem, C);
       c=0; do {
          opus_val16 decay;
          opus_val16 attenuation;
@@ -737,7 +863,7 @@ static void celt_decode_lost(CELTDecoder * OPUS_RESTRICT st, int N, int LM
 
          buf = decode_mem[c];
          for (i=0;i<MAX_PERIOD+CELT_LPC_ORDER;i++)
-            exc[i-CELT_LPC_ORDER] = SROUND16(buf[DECODE_BUFFER_SIZE-MAX_PERIOD-CELT_LPC_ORDER+i], SIG_SHIFT);
+            exc[i-CELT_LPC_ORDER] = SROUND16(buf[DECODE_BUFFER_SIZE-N-MAX_PERIOD-CELT_LPC_ORDER+i], SIG_SHIFT);
 
          if (loss_duration == 0)
          {
@@ -813,11 +939,6 @@ static void celt_decode_lost(CELTDecoder * OPUS_RESTRICT st, int N, int LM
             decay = celt_sqrt(frac_div32(SHR32(E1, 1), E2));
          }
 
-         /* Move the decoder memory one frame to the left to give us room to
-            add the data for the new frame. We ignore the overlap that extends
-            past the end of the buffer, because we aren't going to use it. */
-         OPUS_MOVE(buf, buf+N, DECODE_BUFFER_SIZE-N);
-
          /* Extrapolate from the end of the excitation with a period of
             "pitch_index", scaling down each period by an additional factor of
             "decay". */
@@ -986,6 +1107,9 @@ int celt_decode_with_ec_dred(CELTDecoder * OPUS_RESTRICT st, const unsigned char
    VARDECL(int, fine_priority);
    VARDECL(int, tf_res);
    VARDECL(unsigned char, collapse_masks);
+#ifdef COMPACT_DECODER
+   VARDECL(celt_sig, decode_work);
+#endif
    celt_sig *decode_mem[2];
    celt_sig *out_syn[2];
    opus_val16 *lpc;
@@ -1030,7 +1154,7 @@ int celt_decode_with_ec_dred(CELTDecoder * OPUS_RESTRICT st, const unsigned char
    end = st->end;
    frame_size *= st->downsample;
 
-   lpc = (opus_val16*)(st->_decode_mem+(DECODE_BUFFER_SIZE+overlap)*CC);
+   lpc = get_lpc(st);
    oldBandE = lpc+CC*CELT_LPC_ORDER;
    oldLogE = oldBandE + 2*nbEBands;
    oldLogE2 = oldLogE + 2*nbEBands;
@@ -1045,7 +1169,10 @@ int celt_decode_with_ec_dred(CELTDecoder * OPUS_RESTRICT st, const unsigned char
       {
          data0 = fromOpus(data0);
          if (data0<0)
+         {
+            RESTORE_STACK;
             return OPUS_INVALID_PACKET;
+         }
       }
       st->end = end = IMAX(1, mode->effEBands-2*(data0>>5));
       LM = (data0>>3)&0x3;
@@ -1053,10 +1180,15 @@ int celt_decode_with_ec_dred(CELTDecoder * OPUS_RESTRICT st, const unsigned char
       data++;
       len--;
       if (LM>mode->maxLM)
+      {
+         RESTORE_STACK;
          return OPUS_INVALID_PACKET;
+      }
       if (frame_size < mode->shortMdctSize<<LM)
+      {
+         RESTORE_STACK;
          return OPUS_BUFFER_TOO_SMALL;
-      else
+      } else
          frame_size = mode->shortMdctSize<<LM;
    } else {
 #else
@@ -1066,23 +1198,30 @@ int celt_decode_with_ec_dred(CELTDecoder * OPUS_RESTRICT st, const unsigned char
          if (mode->shortMdctSize<<LM==frame_size)
             break;
       if (LM>mode->maxLM)
+      {
+         RESTORE_STACK;
          return OPUS_BAD_ARG;
+      }
    }
    M=1<<LM;
 
    if (len<0 || len>1275 || pcm==NULL)
+   {
+      RESTORE_STACK;
       return OPUS_BAD_ARG;
+   }
 
    N = M*mode->shortMdctSize;
-   c=0; do {
-      decode_mem[c] = st->_decode_mem + c*(DECODE_BUFFER_SIZE+overlap);
-      out_syn[c] = decode_mem[c]+DECODE_BUFFER_SIZE-N;
-   } while (++c<CC);
 
    effEnd = end;
    if (effEnd > mode->effEBands)
       effEnd = mode->effEBands;
 
+#ifdef COMPACT_DECODER
+   ALLOC(decode_work, CC*(DECODE_BUFFER_SIZE+N+overlap), celt_sig);
+   expand_decode_mem(st, decode_work, N, data == NULL || len<=1 ? 0 : DECODE_PLC_ONLY);
+#endif
+
    if (data == NULL || len<=1)
    {
       celt_decode_lost(st, N, LM
@@ -1090,7 +1229,14 @@ int celt_decode_with_ec_dred(CELTDecoder * OPUS_RESTRICT st, const unsigned char
       , lpcnet
 #endif
                       );
+      get_decode_mem(st, decode_mem, CC);
+      c=0; do {
+         out_syn[c] = decode_mem[c]+DECODE_BUFFER_SIZE-N;
+      } while (++c<CC);
       deemphasis(out_syn, pcm, N, CC, st->downsample, mode->preemph, st->preemph_memD, accum);
+#ifdef COMPACT_DECODER
+      store_decode_mem(st, 0);
+#endif
       RESTORE_STACK;
       return frame_size/st->downsample;
    }
@@ -1262,8 +1408,10 @@ int celt_decode_with_ec_dred(CELTDecoder * OPUS_RESTRICT st, const unsigned char
 
    unquant_fine_energy(mode, start, end, oldBandE, fine_quant, dec, C);
 
+   shift_decode_mem(st, N);
+   get_decode_mem(st, decode_mem, CC);
    c=0; do {
-      OPUS_MOVE(decode_mem[c], decode_mem[c]+N, DECODE_BUFFER_SIZE-N+overlap);
+      out_syn[c] = decode_mem[c]+DECODE_BUFFER_SIZE-N;
    } while (++c<CC);
 
    /* Decode fixed codebook */
@@ -1358,6 +1506,9 @@ int celt_decode_with_ec_dred(CELTDecoder * OPUS_RESTRICT st, const unsigned char
    st->rng = dec->rng;
 
    deemphasis(out_syn, pcm, N, CC, st->downsample, mode->preemph, st->preemph_memD, accum);
+#ifdef COMPACT_DECODER
+   store_decode_mem(st, DECODE_PLC_ONLY);
+#endif
    st->loss_duration = 0;
    st->prefilter_and_fold = 0;
    RESTORE_STACK;
@@ -1394,7 +1545,10 @@ int opus_custom_decode_float(CELTDecoder * OPUS_RESTRICT st, const unsigned char
    ALLOC_STACK;
 
    if (pcm==NULL)
+   {
+      RESTORE_STACK;
       return OPUS_BAD_ARG;
+   }
 
    C = st->channels;
    N = frame_size;
@@ -1424,7 +1578,10 @@ int opus_custom_decode(CELTDecoder * OPUS_RESTRICT st, const unsigned char *data
    ALLOC_STACK;
 
    if (pcm==NULL)
+   {
+      RESTORE_STACK;
       return OPUS_BAD_ARG;
+   }
 
    C = st->channels;
    N = frame_size;
@@ -1515,13 +1672,26 @@ int opus_custom_decoder_ctl(CELTDecoder * OPUS_RESTRICT st, int request, ...)
       {
          int i;
          opus_val16 *lpc, *oldBandE, *oldLogE, *oldLogE2;
-         lpc = (opus_val16*)(st->_decode_mem+(DECODE_BUFFER_SIZE+st->overlap)*st->channels);
+         lpc = get_lpc(st);
          oldBandE = lpc+st->channels*CELT_LPC_ORDER;
          oldLogE = oldBandE + 2*st->mode->nbEBands;
          oldLogE2 = oldLogE + 2*st->mode->nbEBands;
+#ifdef COMPACT_DECODER
          OPUS_CLEAR((char*)&st->DECODER_RESET_START,
                opus_custom_decoder_get_size(st->mode, st->channels)-
                ((char*)&st->DECODER_RESET_START - (char*)st));
+#else
+         /* Only the history window is read before being written, so the
+            slack after it is left as is. */
+         OPUS_CLEAR((char*)&st->DECODER_RESET_START,
+               (char*)st->_decode_mem - (char*)&st->DECODER_RESET_START);
+         for (i=0;i<st->channels;i++)
+         {
+            OPUS_CLEAR(st->_decode_mem+i*DECODE_MEM_STRIDE(st), DECODE_BUFFER_SIZE+st->overlap);
+         }
+         OPUS_CLEAR((char*)lpc, (char*)st + opus_custom_decoder_get_size(st->mode, st->channels)
+               - (char*)lpc);
+#endif
          for (i=0;i<2*st->mode->nbEBands;i++)
             oldLogE[i]=oldLogE2[i]=-QCONST16(28.f,DB_SHIFT);
          st->skip_plc = 1;
@@ -51,6 +51,11 @@
 #include "celt_lpc.h"
 #include "vq.h"
 
+/* The prefilter history is a sliding window of COMBFILTER_MAXPERIOD samples
+   inside a buffer with PREFILTER_MEM_SLACK extra samples per channel, so that
+   each frame is appended in place and the window advanced instead of copying
+   the whole history. Must be at least the largest frame size. */
+#define PREFILTER_MEM_SLACK 1024
 
 /** Encoder state
  @brief Encoder state
@@ -91,6 +96,7 @@ struct OpusCustomEncoder {
    int prefilter_period;
    opus_val16 prefilter_gain;
    int prefilter_tapset;
+   int prefilter_mem_offset;
 #ifdef RESYNTH
    int prefilter_period_old;
    opus_val16 prefilter_gain_old;
@@ -120,7 +126,7 @@ struct OpusCustomEncoder {
 #endif
 
    celt_sig in_mem[1]; /* Size = channels*mode->overlap */
-   /* celt_sig prefilter_mem[],  Size = channels*COMBFILTER_MAXPERIOD */
+   /* celt_sig prefilter_mem[],  Size = channels*(COMBFILTER_MAXPERIOD+PREFILTER_MEM_SLACK) */
    /* opus_val16 oldBandE[],     Size = channels*mode->nbEBands */
    /* opus_val16 oldLogE[],      Size = channels*mode->nbEBands */
    /* opus_val16 oldLogE2[],     Size = channels*mode->nbEBands */
@@ -137,7 +143,8 @@ OPUS_CUSTOM_NOSTATIC int opus_custom_encoder_get_size(const CELTMode *mode, int
 {
    int size = sizeof(struct CELTEncoder)
          + (channels*mode->overlap-1)*sizeof(celt_sig)    /* celt_sig in_mem[channels*mode->overlap]; */
-         + channels*COMBFILTER_MAXPERIOD*sizeof(celt_sig) /* celt_sig prefilter_mem[channels*COMBFILTER_MAXPERIOD]; */
+         + channels*(COMBFILTER_MAXPERIOD+PREFILTER_MEM_SLACK)*sizeof(celt_sig)
+                                                          /* celt_sig prefilter_mem[channels*(COMBFILTER_MAXPERIOD+PREFILTER_MEM_SLACK)]; */
          + 4*channels*mode->nbEBands*sizeof(opus_val16);  /* opus_val16 oldBandE[channels*mode->nbEBands]; */
                                                           /* opus_val16 oldLogE[channels*mode->nbEBands]; */
                                                           /* opus_val16 oldLogE2[channels*mode->nbEBands]; */
@@ -145,6 +152,60 @@ OPUS_CUSTOM_NOSTATIC int opus_custom_encoder_get_size(const CELTMode *mode, int
    return size;
 }
 
+/* A snapshot leaves out the part of the prefilter buffer that is outside the
+   current history window, which is always written before being read. */
+int celt_encoder_get_snapshot_size(int channels)
+{
+   return celt_encoder_get_size(channels)
+         - channels*PREFILTER_MEM_SLACK*sizeof(celt_sig);
+}
+
+int celt_encoder_save(const CELTEncoder *st, unsigned char *snapshot)
+{
+   int c;
+   int size;
+   int tail;
+   const celt_sig *prefilter_mem;
+   prefilter_mem = st->in_mem+st->channels*st->mode->overlap;
+   size = (const unsigned char*)prefilter_mem - (const unsigned char*)st;
+   tail = opus_custom_encoder_get_size(st->mode, st->channels) - size
+         - st->channels*(COMBFILTER_MAXPERIOD+PREFILTER_MEM_SLACK)*sizeof(celt_sig);
+   OPUS_COPY(snapshot, (const unsigned char*)st, size);
+   for (c=0;c<st->channels;c++)
+   {
+      OPUS_COPY(snapshot+size,
+            (const unsigned char*)(prefilter_mem+c*(COMBFILTER_MAXPERIOD+PREFILTER_MEM_SLACK)+st->prefilter_mem_offset),
+            COMBFILTER_MAXPERIOD*sizeof(celt_sig));
+      size += COMBFILTER_MAXPERIOD*sizeof(celt_sig);
+   }
+   OPUS_COPY(snapshot+size,
+         (const unsigned char*)(prefilter_mem+st->channels*(COMBFILTER_MAXPERIOD+PREFILTER_MEM_SLACK)), tail);
+   return size+tail;
+}
+
+int celt_encoder_restore(CELTEncoder *st, const unsigned char *snapshot)
+{
+   int c;
+   int size;
+   int tail;
+   celt_sig *prefilter_mem;
+   prefilter_mem = st->in_mem+st->channels*st->mode->overlap;
+   size = (unsigned char*)prefilter_mem - (unsigned char*)st;
+   tail = opus_custom_encoder_get_size(st->mode, st->channels) - size
+         - st->channels*(COMBFILTER_MAXPERIOD+PREFILTER_MEM_SLACK)*sizeof(celt_sig);
+   /* This also restores the position of the history window. */
+   OPUS_COPY((unsigned char*)st, snapshot, size);
+   for (c=0;c<st->channels;c++)
+   {
+      OPUS_COPY((unsigned char*)(prefilter_mem+c*(COMBFILTER_MAXPERIOD+PREFILTER_MEM_SLACK)+st->prefilter_mem_offset),
+            snapshot+size, COMBFILTER_MAXPERIOD*sizeof(celt_sig));
+      size += COMBFILTER_MAXPERIOD*sizeof(celt_sig);
+   }
+   OPUS_COPY((unsigned char*)(prefilter_mem+st->channels*(COMBFILTER_MAXPERIOD+PREFILTER_MEM_SLACK)),
+         snapshot+size, tail);
+   return size+tail;
+}
+
 #ifdef CUSTOM_MODES
 CELTEncoder *opus_custom_encoder_create(const CELTMode *mode, int channels, int *error)
 {
@@ -1189,7 +1250,6 @@ static int run_prefilter(CELTEncoder *st, celt_sig *in, celt_sig *prefilter_mem,
       int prefilter_tapset, int *pitch, opus_val16 *gain, int *qgain, int enabled, int nbAvailableBytes, AnalysisInfo *analysis)
 {
    int c;
-   VARDECL(celt_sig, _pre);
    celt_sig *pre[2];
    const CELTMode *mode;
    int pitch_index;
@@ -1198,18 +1258,26 @@ static int run_prefilter(CELTEncoder *st, celt_sig *in, celt_sig *prefilter_mem,
    int pf_on;
    int qg;
    int overlap;
+   int mem_offset;
    SAVE_STACK;
 
    mode = st->mode;
    overlap = mode->overlap;
-   ALLOC(_pre, CC*(N+COMBFILTER_MAXPERIOD), celt_sig);
-
-   pre[0] = _pre;
-   pre[1] = _pre + (N+COMBFILTER_MAXPERIOD);
-
 
+   /* Append the new frame right after the history window, moving the window
+      back to the start of the buffer only when there isn't enough room. */
+   celt_assert(N <= PREFILTER_MEM_SLACK);
+   mem_offset = st->prefilter_mem_offset;
+   if (mem_offset+N > PREFILTER_MEM_SLACK)
+   {
+      c=0; do {
+         celt_sig *buf = prefilter_mem+c*(COMBFILTER_MAXPERIOD+PREFILTER_MEM_SLACK);
+         OPUS_MOVE(buf, buf+mem_offset, COMBFILTER_MAXPERIOD);
+      } while (++c<CC);
+      mem_offset = 0;
+   }
    c=0; do {
-      OPUS_COPY(pre[c], prefilter_mem+c*COMBFILTER_MAXPERIOD, COMBFILTER_MAXPERIOD);
+      pre[c] = prefilter_mem+c*(COMBFILTER_MAXPERIOD+PREFILTER_MEM_SLACK)+mem_offset;
       OPUS_COPY(pre[c]+COMBFILTER_MAXPERIOD, in+c*(N+overlap)+overlap, N);
    } while (++c<CC);
 
@@ -1300,15 +1368,8 @@ static int run_prefilter(CELTEncoder *st, celt_sig *in, celt_sig *prefilter_mem,
             st->prefilter_period, pitch_index, N-offset, -st->prefilter_gain, -gain1,
             st->prefilter_tapset, prefilter_tapset, mode->window, overlap, st->arch);
       OPUS_COPY(st->in_mem+c*(overlap), in+c*(N+overlap)+N, overlap);
-
-      if (N>COMBFILTER_MAXPERIOD)
-      {
-         OPUS_COPY(prefilter_mem+c*COMBFILTER_MAXPERIOD, pre[c]+N, COMBFILTER_MAXPERIOD);
-      } else {
-         OPUS_MOVE(prefilter_mem+c*COMBFILTER_MAXPERIOD, prefilter_mem+c*COMBFILTER_MAXPERIOD+N, COMBFILTER_MAXPERIOD-N);
-         OPUS_COPY(prefilter_mem+c*COMBFILTER_MAXPERIOD+COMBFILTER_MAXPERIOD-N, pre[c]+COMBFILTER_MAXPERIOD, N);
-      }
    } while (++c<CC);
+   st->prefilter_mem_offset = mem_offset+N;
 
    RESTORE_STACK;
    *gain = gain1;
@@ -1529,7 +1590,7 @@ int celt_encode_with_ec(CELTEncoder * OPUS_RESTRICT st, const opus_val16 * pcm,
    N = M*mode->shortMdctSize;
 
    prefilter_mem = st->in_mem+CC*(overlap);
-   oldBandE = (opus_val16*)(st->in_mem+CC*(overlap+COMBFILTER_MAXPERIOD));
+   oldBandE = (opus_val16*)(st->in_mem+CC*(overlap+COMBFILTER_MAXPERIOD+PREFILTER_MEM_SLACK));
    oldLogE = oldBandE + CC*nbEBands;
    oldLogE2 = oldLogE + CC*nbEBands;
    energyError = oldLogE2 + CC*nbEBands;
@@ -2384,7 +2445,10 @@ int opus_custom_encode_float(CELTEncoder * OPUS_RESTRICT st, const float * pcm,
    ALLOC_STACK;
 
    if (pcm==NULL)
+   {
+      RESTORE_STACK;
       return OPUS_BAD_ARG;
+   }
 
    C = st->channels;
    N = frame_size;
@@ -2411,7 +2475,10 @@ int opus_custom_encode(CELTEncoder * OPUS_RESTRICT st, const opus_int16 * pcm, i
    ALLOC_STACK;
 
    if (pcm==NULL)
+   {
+      RESTORE_STACK;
       return OPUS_BAD_ARG;
+   }
 
    C=st->channels;
    N=frame_size;
@@ -2553,7 +2620,7 @@ int opus_custom_encoder_ctl(CELTEncoder * OPUS_RESTRICT st, int request, ...)
       {
          int i;
          opus_val16 *oldBandE, *oldLogE, *oldLogE2;
-         oldBandE = (opus_val16*)(st->in_mem+st->channels*(st->mode->overlap+COMBFILTER_MAXPERIOD));
+         oldBandE = (opus_val16*)(st->in_mem+st->channels*(st->mode->overlap+COMBFILTER_MAXPERIOD+PREFILTER_MEM_SLACK));
          oldLogE = oldBandE + st->channels*st->mode->nbEBands;
          oldLogE2 = oldLogE + st->channels*st->mode->nbEBands;
          OPUS_CLEAR((char*)&st->ENCODER_RESET_START,
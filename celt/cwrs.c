@@ -460,6 +460,51 @@ void encode_pulses(const int *_y,int _n,int _k,ec_enc *_enc){
   ec_enc_uint(_enc,icwrs(_n,_y),CELT_PVQ_V(_n,_k));
 }
 
+#if defined(CWRS_BSEARCH)
+/*Intervals at most this long are still scanned linearly: the scan reads
+   consecutive entries with a well-predicted branch, and most dimensions only
+   take a handful of pulses.*/
+# if !defined(CWRS_BSEARCH_MIN)
+#  define CWRS_BSEARCH_MIN (16)
+# endif
+
+/*Returns the largest k in [_lo,_hi] with U(_n,k)<=_i, and stores U(_n,k) in
+   *_p.
+  U(_n,k) is strictly increasing in k for _n>0, and the caller guarantees
+   U(_n,_lo)<=_i.
+  Long intervals are halved with a conditional move rather than a branch, so
+   the number of iterations depends only on the interval length.
+  This helps mostly with peaky (tonal) codewords, where a single dimension
+   takes a large share of the pulses.
+  _col selects whether we search column _n of rows k (for k<_n) or row _n (for
+   k>=_n), so only entries the linear scan could also have read are accessed.*/
+static OPUS_INLINE int cwrs_search_k(int _n,int _lo,int _hi,
+ opus_uint32 _i,opus_uint32 *_p,int _col){
+  int len;
+  len=_hi-_lo+1;
+  if(len<=CWRS_BSEARCH_MIN){
+    opus_uint32 p;
+    for(;;){
+      p=_col?CELT_PVQ_U_ROW[_hi][_n]:CELT_PVQ_U_ROW[_n][_hi];
+      if(p<=_i)break;
+      _hi--;
+    }
+    *_p=p;
+    return _hi;
+  }
+  while(len>1){
+    opus_uint32 q;
+    int         half;
+    half=len>>1;
+    q=_col?CELT_PVQ_U_ROW[_lo+half][_n]:CELT_PVQ_U_ROW[_n][_lo+half];
+    _lo+=q<=_i?half:0;
+    len-=half;
+  }
+  *_p=_col?CELT_PVQ_U_ROW[_lo][_n]:CELT_PVQ_U_ROW[_n][_lo];
+  return _lo;
+}
+#endif
+
 static opus_val32 cwrsi(int _n,int _k,opus_uint32 _i,int *_y){
   opus_uint32 p;
   int         s;
@@ -481,6 +526,13 @@ static opus_val32 cwrsi(int _n,int _k,opus_uint32 _i,int *_y){
       /*Count how many pulses were placed in this dimension.*/
       k0=_k;
       q=row[_n];
+#if defined(CWRS_BSEARCH)
+      if(q>_i){
+        celt_sig_assert(p>q);
+        _k=cwrs_search_k(_n,0,_n-1,_i,&p,1);
+      }
+      else _k=cwrs_search_k(_n,_n,_k,_i,&p,0);
+#else
       if(q>_i){
         celt_sig_assert(p>q);
         _k=_n;
@@ -488,6 +540,7 @@ static opus_val32 cwrsi(int _n,int _k,opus_uint32 _i,int *_y){
         while(p>_i);
       }
       else for(p=row[_k];p>_i;p=row[_k])_k--;
+#endif
       _i-=p;
       val=(k0-_k+s)^s;
       *_y++=val;
@@ -508,8 +561,12 @@ static opus_val32 cwrsi(int _n,int _k,opus_uint32 _i,int *_y){
         _i-=q&s;
         /*Count how many pulses were placed in this dimension.*/
         k0=_k;
+#if defined(CWRS_BSEARCH)
+        _k=cwrs_search_k(_n,0,_k-1,_i,&p,1);
+#else
         do p=CELT_PVQ_U_ROW[--_k][_n];
         while(p>_i);
+#endif
         _i-=p;
         val=(k0-_k+s)^s;
         *_y++=val;
@@ -172,6 +172,36 @@ void ec_enc_icdf(ec_enc *_this,int _s,const unsigned char *_icdf,unsigned _ftb){
   ec_enc_normalize(_this);
 }
 
+void ec_enc_icdf_array(ec_enc *_this,const opus_int8 *_s,int _n,
+ const unsigned char *_icdf,int _nsyms,unsigned _ftb){
+  opus_uint32 rng;
+  opus_uint32 val;
+  int         i;
+  rng=_this->rng;
+  val=_this->val;
+  for(i=0;i<_n;i++){
+    opus_uint32 r;
+    int         s;
+    s=_s[i];
+    celt_assert(s>=0&&s<_nsyms);
+    r=rng>>_ftb;
+    if(s>0){
+      val+=rng-IMUL32(r,_icdf[s-1]);
+      rng=IMUL32(r,_icdf[s-1]-_icdf[s]);
+    }
+    else rng-=IMUL32(r,_icdf[s]);
+    /*Same as ec_enc_normalize(), on the local copies.*/
+    while(rng<=EC_CODE_BOT){
+      ec_enc_carry_out(_this,(int)(val>>EC_CODE_SHIFT));
+      val=(val<<EC_SYM_BITS)&(EC_CODE_TOP-1);
+      rng<<=EC_SYM_BITS;
+      _this->nbits_total+=EC_SYM_BITS;
+    }
+  }
+  _this->rng=rng;
+  _this->val=val;
+}
+
 void ec_enc_icdf16(ec_enc *_this,int _s,const opus_uint16 *_icdf,unsigned _ftb){
   opus_uint32 r;
   r=_this->rng>>_ftb;
@@ -73,6 +73,17 @@ void ec_enc_icdf(ec_enc *_this,int _s,const unsigned char *_icdf,unsigned _ftb);
   _ftb: The number of bits of precision in the cumulative distribution.*/
 void ec_enc_icdf16(ec_enc *_this,int _s,const opus_uint16 *_icdf,unsigned _ftb);
 
+/*Encodes an array of symbols, all using the same "inverse" CDF table.
+  This produces exactly the same output as calling ec_enc_icdf() on each
+   symbol in turn, but keeps the coder state in registers between symbols.
+  _s:    The indices of the symbols to encode.
+  _n:    The number of symbols.
+  _icdf: The "inverse" CDF, as for ec_enc_icdf().
+  _nsyms: The number of entries in _icdf. Every symbol must be less than this.
+  _ftb: The number of bits of precision in the cumulative distribution.*/
+void ec_enc_icdf_array(ec_enc *_this,const opus_int8 *_s,int _n,
+ const unsigned char *_icdf,int _nsyms,unsigned _ftb);
+
 /*Encodes a raw unsigned integer in the stream.
   _fl: The integer to encode.
   _ft: The number of integers that can be encoded (one more than the max).
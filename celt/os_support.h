@@ -41,21 +41,28 @@
 #include <string.h>
 #include <stdlib.h>
 
-/** Opus wrapper for malloc(). To do your own dynamic allocation replace this function, opus_realloc, and opus_free */
+/** Alignment requested from allocators installed with opus_set_allocator() */
+#define OPUS_ALLOC_ALIGNMENT 16
+
+/** Allocator installed with opus_set_allocator(), malloc()/free() when NULL */
+typedef struct {
+   opus_alloc_callback alloc_func;
+   opus_free_callback free_func;
+   void *user_data;
+} OpusAllocator;
+
+extern OpusAllocator opus_allocator;
+
+/** Opus wrapper for malloc(). To do your own dynamic allocation replace this function and opus_free */
 #ifndef OVERRIDE_OPUS_ALLOC
 static OPUS_INLINE void *opus_alloc (size_t size)
 {
+   if (opus_allocator.alloc_func)
+      return opus_allocator.alloc_func(opus_allocator.user_data, size, OPUS_ALLOC_ALIGNMENT);
    return malloc(size);
 }
 #endif
 
-#ifndef OVERRIDE_OPUS_REALLOC
-static OPUS_INLINE void *opus_realloc (void *ptr, size_t size)
-{
-   return realloc(ptr, size);
-}
-#endif
-
 /** Used only for non-threadsafe pseudostack.
     If desired, this can always return the same area of memory rather than allocating a new one every time. */
 #ifndef OVERRIDE_OPUS_ALLOC_SCRATCH
@@ -66,10 +73,16 @@ static OPUS_INLINE void *opus_alloc_scratch (size_t size)
 }
 #endif
 
-/** Opus wrapper for free(). To do your own dynamic allocation replace this function, opus_realloc, and opus_free */
+/** Opus wrapper for free(). To do your own dynamic allocation replace this function and opus_alloc */
 #ifndef OVERRIDE_OPUS_FREE
 static OPUS_INLINE void opus_free (void *ptr)
 {
+   if (opus_allocator.free_func)
+   {
+      if (ptr)
+         opus_allocator.free_func(opus_allocator.user_data, ptr);
+      return;
+   }
    free(ptr);
 }
 #endif
@@ -35,8 +35,8 @@
 #include "opus_types.h"
 #include "opus_defines.h"
 
-#if (!defined (VAR_ARRAYS) && !defined (USE_ALLOCA) && !defined (NONTHREADSAFE_PSEUDOSTACK))
-#error "Opus requires one of VAR_ARRAYS, USE_ALLOCA, or NONTHREADSAFE_PSEUDOSTACK be defined to select the temporary allocation mode."
+#if (!defined (VAR_ARRAYS) && !defined (USE_ALLOCA) && !defined (NONTHREADSAFE_PSEUDOSTACK) && !defined (SCRATCH_ARENA))
+#error "Opus requires one of VAR_ARRAYS, USE_ALLOCA, NONTHREADSAFE_PSEUDOSTACK, or SCRATCH_ARENA be defined to select the temporary allocation mode."
 #endif
 
 #ifdef USE_ALLOCA
@@ -51,6 +51,18 @@
 # endif
 #endif
 
+#if defined(SCRATCH_ARENA) || defined(NONTHREADSAFE_PSEUDOSTACK)
+/* Both modes allocate from one block of memory, so they can report how much
+   of it an encoder/decoder call used (OPUS_GET_SCRATCH_USAGE). */
+#define OPUS_SCRATCH_STATS
+
+/* Scratch usage of an encoder/decoder, in bytes. */
+typedef struct {
+   opus_int32 last;  /* Peak during the most recent call */
+   opus_int32 peak;  /* Peak over the lifetime of the instance */
+} opus_scratch_stats;
+#endif
+
 /**
  * @def ALIGN(stack, size)
  *
@@ -70,6 +82,20 @@
  * @param type  Type of element
  */
 
+/**
+ * @def ALLOC_STACK_ARENA(arena, size, stats)
+ *
+ * Same as ALLOC_STACK, but in SCRATCH_ARENA mode makes the 'size' byte
+ * 'arena' owned by the calling encoder/decoder current, unless an outer
+ * call already did so. Its usage is then recorded in 'stats' (may be NULL).
+ * NONTHREADSAFE_PSEUDOSTACK mode only records the usage of the global stack
+ * in 'stats'. Other modes ignore the arguments.
+ *
+ * @param arena Scratch arena of the calling instance
+ * @param size  Size of the arena in bytes
+ * @param stats opus_scratch_stats of the calling instance
+ */
+
 /**
  * @def VARDECL(var)
  *
@@ -95,6 +121,7 @@
 #define SAVE_STACK
 #define RESTORE_STACK
 #define ALLOC_STACK
+#define ALLOC_STACK_ARENA(arena, size, stats)
 /* C99 does not allow VLAs of size zero */
 #define ALLOC_NONE 1
 
@@ -111,6 +138,102 @@
 #define SAVE_STACK
 #define RESTORE_STACK
 #define ALLOC_STACK
+#define ALLOC_STACK_ARENA(arena, size, stats)
+#define ALLOC_NONE 0
+
+#elif defined(SCRATCH_ARENA)
+
+#include "arch.h"
+#include "os_support.h"
+
+#if defined(_MSC_VER)
+# define OPUS_THREAD_LOCAL __declspec(thread)
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_THREADS__)
+# define OPUS_THREAD_LOCAL _Thread_local
+#else
+# define OPUS_THREAD_LOCAL __thread
+#endif
+
+/* Each encoder/decoder owns a scratch arena at the end of its state. The
+   outermost API call makes its arena current for the calling thread and all
+   nested allocations bump within it. Calls that have no instance (e.g.
+   opus_packet_pad()) allocate a block of GLOBAL_STACK_SIZE bytes with plain
+   malloc() and free it when they return, so nothing outlives the call or
+   depends on the allocator hooks. */
+
+#ifdef CELT_C
+OPUS_THREAD_LOCAL char *global_stack=0;
+OPUS_THREAD_LOCAL char *global_stack_end=0;
+OPUS_THREAD_LOCAL char *global_stack_base=0;
+OPUS_THREAD_LOCAL char *global_stack_peak=0;
+OPUS_THREAD_LOCAL opus_scratch_stats *global_stack_stats=0;
+#include <stdio.h>
+void opus_scratch_overflow(void)
+{
+   fprintf(stderr, "Fatal (internal) error: scratch arena overflow\n");
+   abort();
+}
+#else
+extern OPUS_THREAD_LOCAL char *global_stack;
+extern OPUS_THREAD_LOCAL char *global_stack_end;
+extern OPUS_THREAD_LOCAL char *global_stack_base;
+extern OPUS_THREAD_LOCAL char *global_stack_peak;
+extern OPUS_THREAD_LOCAL opus_scratch_stats *global_stack_stats;
+#endif /* CELT_C */
+#ifdef __GNUC__
+__attribute__((noreturn))
+#endif
+void opus_scratch_overflow(void);
+
+static OPUS_INLINE void *opus_scratch_push(size_t size, size_t align)
+{
+   char *ptr;
+   ptr = global_stack + ((align - (size_t)global_stack) & (align - 1));
+   global_stack = ptr + size;
+   /* Only a new high-water mark can overflow or change the stats. */
+   if (global_stack > global_stack_peak)
+   {
+      global_stack_peak = global_stack;
+      /* Checked in every build: an undersized arena would write past the end
+         of the encoder or decoder state, and a failed fallback allocation
+         leaves no arena at all (global_stack_end is then 0). */
+      if (global_stack > global_stack_end)
+         opus_scratch_overflow();
+      if (global_stack_stats)
+      {
+         global_stack_stats->last = (opus_int32)(global_stack - global_stack_base);
+         if (global_stack_stats->last > global_stack_stats->peak)
+            global_stack_stats->peak = global_stack_stats->last;
+      }
+   }
+   return ptr;
+}
+
+/* Every allocation starts on a 16-byte boundary, like malloc() and the
+   stack arrays of the other modes. Some kernels assume that even 16-bit
+   buffers are 4-byte aligned, and SIMD code prefers 16. */
+#define OPUS_SCRATCH_ALIGN 16
+
+#define VARDECL(type, var) type *var
+#define ALLOC(var, size, type) var = ((type*)opus_scratch_push((size)*sizeof(type), OPUS_SCRATCH_ALIGN))
+#define OPUS_SCRATCH_ENTER(arena, size, stats) \
+   if (global_stack==0) { \
+      global_stack = global_stack_base = global_stack_peak = (char*)(arena); \
+      global_stack_end = global_stack ? global_stack+(size) : 0; \
+      global_stack_stats = (stats); \
+      if (global_stack_stats) global_stack_stats->last = 0; \
+   }
+#define ALLOC_STACK_ARENA(arena, size, stats) char *_saved_stack = global_stack; \
+   char *_scratch_block = 0; \
+   OPUS_SCRATCH_ENTER(arena, size, stats)
+/* The arena pointer is cleared when the outermost call returns, so any
+   function may be the first one to allocate. If none is current, the
+   function owns a malloc()ed block until it returns. */
+#define SAVE_STACK char *_saved_stack = global_stack; \
+   char *_scratch_block = global_stack ? 0 : (char*)malloc(GLOBAL_STACK_SIZE); \
+   OPUS_SCRATCH_ENTER(_scratch_block, GLOBAL_STACK_SIZE, 0)
+#define RESTORE_STACK (global_stack = _saved_stack, _scratch_block ? free(_scratch_block) : (void)0)
+#define ALLOC_STACK SAVE_STACK
 #define ALLOC_NONE 0
 
 #else
@@ -118,11 +241,26 @@
 #ifdef CELT_C
 char *scratch_ptr=0;
 char *global_stack=0;
+char *global_stack_base=0;
+opus_scratch_stats *global_stack_stats=0;
 #else
 extern char *global_stack;
 extern char *scratch_ptr;
+extern char *global_stack_base;
+extern opus_scratch_stats *global_stack_stats;
 #endif /* CELT_C */
 
+/* Records a new high-water mark of the call that owns global_stack_stats. */
+static OPUS_INLINE void opus_pseudostack_update(void)
+{
+   if (global_stack_stats && global_stack - global_stack_base > global_stack_stats->last)
+   {
+      global_stack_stats->last = (opus_int32)(global_stack - global_stack_base);
+      if (global_stack_stats->last > global_stack_stats->peak)
+         global_stack_stats->peak = global_stack_stats->last;
+   }
+}
+
 #ifdef ENABLE_VALGRIND
 
 #include <valgrind/memcheck.h>
@@ -134,27 +272,33 @@ extern char *global_stack_top;
 #endif /* CELT_C */
 
 #define ALIGN(stack, size) ((stack) += ((size) - (long)(stack)) & ((size) - 1))
-#define PUSH(stack, size, type) (VALGRIND_MAKE_MEM_NOACCESS(stack, global_stack_top-stack),ALIGN((stack),sizeof(type)/sizeof(char)),VALGRIND_MAKE_MEM_UNDEFINED(stack, ((size)*sizeof(type)/sizeof(char))),(stack)+=(2*(size)*sizeof(type)/sizeof(char)),(type*)((stack)-(2*(size)*sizeof(type)/sizeof(char))))
-#define RESTORE_STACK ((global_stack = _saved_stack),VALGRIND_MAKE_MEM_NOACCESS(global_stack, global_stack_top-global_stack))
-#define ALLOC_STACK char *_saved_stack; ((global_stack = (global_stack==0) ? ((global_stack_top=opus_alloc_scratch(GLOBAL_STACK_SIZE*2)+(GLOBAL_STACK_SIZE*2))-(GLOBAL_STACK_SIZE*2)) : global_stack),VALGRIND_MAKE_MEM_NOACCESS(global_stack, global_stack_top-global_stack)); _saved_stack = global_stack;
+/* The reported usage includes the guard zones. */
+#define PUSH(stack, size, type) (VALGRIND_MAKE_MEM_NOACCESS(stack, global_stack_top-stack),ALIGN((stack),sizeof(type)/sizeof(char)),VALGRIND_MAKE_MEM_UNDEFINED(stack, ((size)*sizeof(type)/sizeof(char))),(stack)+=(2*(size)*sizeof(type)/sizeof(char)),opus_pseudostack_update(),(type*)((stack)-(2*(size)*sizeof(type)/sizeof(char))))
+#define RESTORE_STACK ((global_stack = _saved_stack),(global_stack_stats = _saved_stats),VALGRIND_MAKE_MEM_NOACCESS(global_stack, global_stack_top-global_stack))
+#define ALLOC_STACK char *_saved_stack; opus_scratch_stats *_saved_stats; ((global_stack = (global_stack==0) ? ((global_stack_top=opus_alloc_scratch(GLOBAL_STACK_SIZE*2)+(GLOBAL_STACK_SIZE*2))-(GLOBAL_STACK_SIZE*2)) : global_stack),VALGRIND_MAKE_MEM_NOACCESS(global_stack, global_stack_top-global_stack)); _saved_stack = global_stack; _saved_stats = global_stack_stats;
 
 #else
 
 #define ALIGN(stack, size) ((stack) += ((size) - (long)(stack)) & ((size) - 1))
-#define PUSH(stack, size, type) (ALIGN((stack),sizeof(type)/(sizeof(char))),(stack)+=(size)*(sizeof(type)/(sizeof(char))),(type*)((stack)-(size)*(sizeof(type)/(sizeof(char)))))
-#if 0 /* Set this to 1 to instrument pseudostack usage */
-#define RESTORE_STACK (printf("%ld %s:%d\n", global_stack-scratch_ptr, __FILE__, __LINE__),global_stack = _saved_stack)
-#else
-#define RESTORE_STACK (global_stack = _saved_stack)
-#endif
-#define ALLOC_STACK char *_saved_stack; (global_stack = (global_stack==0) ? (scratch_ptr=opus_alloc_scratch(GLOBAL_STACK_SIZE)) : global_stack); _saved_stack = global_stack;
+#define PUSH(stack, size, type) (ALIGN((stack),sizeof(type)/(sizeof(char))),(stack)+=(size)*(sizeof(type)/(sizeof(char))),opus_pseudostack_update(),(type*)((stack)-(size)*(sizeof(type)/(sizeof(char)))))
+#define RESTORE_STACK ((global_stack = _saved_stack),(global_stack_stats = _saved_stats))
+#define ALLOC_STACK char *_saved_stack; opus_scratch_stats *_saved_stats; (global_stack = (global_stack==0) ? (scratch_ptr=opus_alloc_scratch(GLOBAL_STACK_SIZE)) : global_stack); _saved_stack = global_stack; _saved_stats = global_stack_stats;
 
 #endif /* ENABLE_VALGRIND */
 
 #include "os_support.h"
 #define VARDECL(type, var) type *var
 #define ALLOC(var, size, type) var = PUSH(global_stack, size, type)
-#define SAVE_STACK char *_saved_stack = global_stack;
+/* Allocating the stack on demand lets any function be the first to use it. */
+#define SAVE_STACK ALLOC_STACK
+/* The global stack is back at its base between calls, so usage is counted
+   from where the outermost instance call found it. */
+#define ALLOC_STACK_ARENA(arena, size, stats) ALLOC_STACK \
+   if (global_stack_stats==0 && (stats)!=0) { \
+      global_stack_stats = (stats); \
+      global_stack_base = global_stack; \
+      global_stack_stats->last = 0; \
+   }
 #define ALLOC_NONE 0
 
 #endif /* VAR_ARRAYS */
@@ -85,6 +85,65 @@ static const int pkmax[NDIMS]={
 
 #endif
 
+#if !defined(SMALL_FOOTPRINT)
+/*Reference decoder using the plain linear scans over the pulse count, so that
+   any alternative search in cwrsi() (e.g., CWRS_BSEARCH) can be checked to
+   produce identical codewords.*/
+static opus_val32 ref_cwrsi(int _n,int _k,opus_uint32 _i,int *_y){
+  opus_uint32 p;
+  int         s;
+  int         k0;
+  int         val;
+  opus_val32  yy=0;
+  while(_n>2){
+    if(_k>=_n){
+      p=CELT_PVQ_U(_n,_k+1);
+      s=-(_i>=p);
+      _i-=p&s;
+      k0=_k;
+      for(p=CELT_PVQ_U(_n,_k);p>_i;p=CELT_PVQ_U(_n,_k))_k--;
+    }
+    else{
+      p=CELT_PVQ_U(_n,_k);
+      if(p<=_i&&_i<CELT_PVQ_U(_n,_k+1)){
+        _i-=p;
+        *_y++=0;
+        _n--;
+        continue;
+      }
+      p=CELT_PVQ_U(_n,_k+1);
+      s=-(_i>=p);
+      _i-=p&s;
+      k0=_k;
+      do{
+        _k--;
+        p=CELT_PVQ_U(_n,_k);
+      }
+      while(p>_i);
+    }
+    _i-=p;
+    val=(k0-_k+s)^s;
+    *_y++=val;
+    yy=MAC16_16(yy,val,val);
+    _n--;
+  }
+  p=2*_k+1;
+  s=-(_i>=p);
+  _i-=p&s;
+  k0=_k;
+  _k=(_i+1)>>1;
+  if(_k)_i-=2*_k-1;
+  val=(k0-_k+s)^s;
+  *_y++=val;
+  yy=MAC16_16(yy,val,val);
+  s=-(int)_i;
+  val=(_k+s)^s;
+  *_y=val;
+  yy=MAC16_16(yy,val,val);
+  return yy;
+}
+#endif
+
 int main(void){
   int t;
   int n;
@@ -124,7 +183,18 @@ int main(void){
         memcpy(u,uu,(k+2U)*sizeof(*u));
         cwrsi(n,k,i,y,u);
 #else
-        cwrsi(n,k,i,y);
+        {
+          int        ry[NMAX];
+          opus_val32 yy;
+          opus_val32 ryy;
+          yy=cwrsi(n,k,i,y);
+          ryy=ref_cwrsi(n,k,i,ry);
+          if(yy!=ryy||memcmp(y,ry,n*sizeof(*y))!=0){
+            fprintf(stderr,"N=%d K=%d Codeword mismatch with reference "
+             "decoder at index %lu.\n",n,k,(long)i);
+            return 3;
+          }
+        }
 #endif
         sy=0;
         for(j=0;j<n;j++)sy+=abs(y[j]);
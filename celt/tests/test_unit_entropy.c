@@ -323,6 +323,34 @@ int main(int _argc,char **_argv){
     free(data);
     free(logp1);
   }
+  /*Check that ec_enc_icdf_array() matches ec_enc_icdf() exactly.*/
+  for(i=0;i<10000;i++){
+    static const unsigned char icdf[4]={200,120,40,0};
+    opus_int8      syms[256];
+    unsigned char *ptr2;
+    int            n;
+    int            j;
+    int            bit;
+    unsigned       logp;
+    bit=rand()&1;
+    logp=1+rand()%15;
+    n=rand()%256;
+    for(j=0;j<n;j++)syms[j]=(opus_int8)(rand()%4);
+    ptr2=ptr+DATA_SIZE2;
+    ec_enc_init(&enc,ptr,DATA_SIZE2);
+    ec_enc_bit_logp(&enc,bit,logp);
+    for(j=0;j<n;j++)ec_enc_icdf(&enc,syms[j],icdf,8);
+    ec_enc_done(&enc);
+    sz=ec_range_bytes(&enc);
+    ec_enc_init(&enc,ptr2,DATA_SIZE2);
+    ec_enc_bit_logp(&enc,bit,logp);
+    ec_enc_icdf_array(&enc,syms,n,icdf,4,8);
+    ec_enc_done(&enc);
+    if((int)ec_range_bytes(&enc)!=sz||memcmp(ptr,ptr2,sz)!=0){
+      fprintf(stderr,"ec_enc_icdf_array() output differs from ec_enc_icdf() (Random seed: %u).\n",seed);
+      ret=-1;
+    }
+  }
   ec_enc_init(&enc,ptr,DATA_SIZE2);
   ec_enc_bit_logp(&enc,0,1);
   ec_enc_bit_logp(&enc,0,1);
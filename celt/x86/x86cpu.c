@@ -39,7 +39,8 @@
   ((defined(OPUS_X86_MAY_HAVE_SSE) && !defined(OPUS_X86_PRESUME_SSE)) || \
   (defined(OPUS_X86_MAY_HAVE_SSE2) && !defined(OPUS_X86_PRESUME_SSE2)) || \
   (defined(OPUS_X86_MAY_HAVE_SSE4_1) && !defined(OPUS_X86_PRESUME_SSE4_1)) || \
-  (defined(OPUS_X86_MAY_HAVE_AVX2) && !defined(OPUS_X86_PRESUME_AVX2)))
+  (defined(OPUS_X86_MAY_HAVE_AVX2) && !defined(OPUS_X86_PRESUME_AVX2)) || \
+  defined(OPUS_X86_MAY_HAVE_AVX512))
 
 #if defined(_MSC_VER)
 
@@ -99,6 +100,21 @@ static void cpuid(unsigned int CPUInfo[4], unsigned int InfoType)
 
 #endif
 
+#if defined(OPUS_X86_MAY_HAVE_AVX512)
+/* Reads XCR0 to check that the OS saves the opmask and ZMM registers. */
+static unsigned int xgetbv0(void)
+{
+#if defined(_MSC_VER)
+    return (unsigned int)_xgetbv(0);
+#else
+    unsigned int eax, edx;
+    __asm__ __volatile__ (".byte 0x0f, 0x01, 0xd0" : "=a" (eax), "=d" (edx) : "c" (0));
+    (void)edx;
+    return eax;
+#endif
+}
+#endif
+
 typedef struct CPU_Feature{
     /*  SIMD: 128-bit */
     int HW_SSE;
@@ -106,13 +122,19 @@ typedef struct CPU_Feature{
     int HW_SSE41;
     /*  SIMD: 256-bit */
     int HW_AVX2;
+    /*  SIMD: 512-bit (F, BW and VL subsets) */
+    int HW_AVX512;
 } CPU_Feature;
 
 static void opus_cpu_feature_check(CPU_Feature *cpu_feature)
 {
     unsigned int info[4];
     unsigned int nIds = 0;
+#if defined(OPUS_X86_MAY_HAVE_AVX512)
+    int osxsave = 0;
+#endif
 
+    cpu_feature->HW_AVX512 = 0;
     cpuid(info, 0);
     nIds = info[0];
 
@@ -122,9 +144,17 @@ static void opus_cpu_feature_check(CPU_Feature *cpu_feature)
         cpu_feature->HW_SSE2 = (info[3] & (1 << 26)) != 0;
         cpu_feature->HW_SSE41 = (info[2] & (1 << 19)) != 0;
         cpu_feature->HW_AVX2 = (info[2] & (1 << 28)) != 0 && (info[2] & (1 << 12)) != 0;
+#if defined(OPUS_X86_MAY_HAVE_AVX512)
+        osxsave = (info[2] & (1 << 27)) != 0;
+#endif
         if (cpu_feature->HW_AVX2 && nIds >= 7) {
             cpuid(info, 7);
             cpu_feature->HW_AVX2 = cpu_feature->HW_AVX2 && (info[1] & (1 << 5)) != 0;
+#if defined(OPUS_X86_MAY_HAVE_AVX512)
+            cpu_feature->HW_AVX512 = cpu_feature->HW_AVX2 && (info[1] & (1 << 16)) != 0
+             && (info[1] & (1 << 30)) != 0 && (info[1] & (1U << 31)) != 0
+             && osxsave && (xgetbv0() & 0xE6) == 0xE6;
+#endif
         } else {
             cpu_feature->HW_AVX2 = 0;
         }
@@ -169,6 +199,14 @@ static int opus_select_arch_impl(void)
     }
     arch++;
 
+#if defined(OPUS_X86_MAY_HAVE_AVX512)
+    if (!cpu_feature.HW_AVX512)
+    {
+        return arch;
+    }
+    arch++;
+#endif
+
     return arch;
 }
 
@@ -52,11 +52,18 @@
 #  define MAY_HAVE_AVX2(name) name ## _c
 # endif
 
+# if defined(OPUS_X86_MAY_HAVE_AVX512)
+#  define MAY_HAVE_AVX512(name) name ## _avx512
+# else
+#  define MAY_HAVE_AVX512(name) MAY_HAVE_AVX2(name)
+# endif
+
 # if defined(OPUS_HAVE_RTCD) && \
   ((defined(OPUS_X86_MAY_HAVE_SSE) && !defined(OPUS_X86_PRESUME_SSE)) || \
   (defined(OPUS_X86_MAY_HAVE_SSE2) && !defined(OPUS_X86_PRESUME_SSE2)) || \
   (defined(OPUS_X86_MAY_HAVE_SSE4_1) && !defined(OPUS_X86_PRESUME_SSE4_1)) || \
-  (defined(OPUS_X86_MAY_HAVE_AVX2) && !defined(OPUS_X86_PRESUME_AVX2)))
+  (defined(OPUS_X86_MAY_HAVE_AVX2) && !defined(OPUS_X86_PRESUME_AVX2)) || \
+  defined(OPUS_X86_MAY_HAVE_AVX512))
 int opus_select_arch(void);
 # endif
 
@@ -120,10 +120,18 @@ function(opus_detect_sse COMPILER_SUPPORT_SIMD)
     else()
       check_flag(AVX2 -mavx2 -mfma -mavx)
     endif()
+    if(MSVC)
+      check_flag(AVX512 /arch:AVX512)
+    else()
+      check_flag(AVX512 -mavx512f -mavx512bw -mavx512vl -mavx2 -mfma -mavx)
+    endif()
   else()
     set(AVX2_SUPPORTED
         0
         PARENT_SCOPE)
+    set(AVX512_SUPPORTED
+        0
+        PARENT_SCOPE)
   endif()
 
   if(SSE1_SUPPORTED OR SSE2_SUPPORTED OR SSE4_1_SUPPORTED OR AVX2_SUPPORTED)
@@ -14,6 +14,7 @@ get_opus_sources(SILK_SOURCES_SSE4_1 silk_sources.mk silk_sources_sse4_1)
 get_opus_sources(SILK_SOURCES_FIXED_SSE4_1 silk_sources.mk
                  silk_sources_fixed_sse4_1)
 get_opus_sources(SILK_SOURCES_AVX2 silk_sources.mk silk_sources_avx2)
+get_opus_sources(SILK_SOURCES_AVX512 silk_sources.mk silk_sources_avx512)
 get_opus_sources(SILK_SOURCES_FLOAT_AVX2 silk_sources.mk silk_sources_float_avx2)
 get_opus_sources(SILK_SOURCES_ARM_RTCD silk_sources.mk silk_sources_arm_rtcd)
 get_opus_sources(SILK_SOURCES_ARM_NEON_INTR silk_sources.mk
@@ -56,14 +57,20 @@ get_opus_sources(DNN_SOURCES_DOTPROD lpcnet_sources.mk dnn_sources_arm_dotprod)
 get_opus_sources(opus_demo_SOURCES Makefile.am opus_demo_sources)
 get_opus_sources(opus_custom_demo_SOURCES Makefile.am opus_custom_demo_sources)
 get_opus_sources(opus_compare_SOURCES Makefile.am opus_compare_sources)
+get_opus_sources(opus_reset_bench_SOURCES Makefile.am
+                 opus_reset_bench_sources)
 get_opus_sources(tests_test_opus_api_SOURCES Makefile.am test_opus_api_sources)
 get_opus_sources(tests_test_opus_encode_SOURCES Makefile.am
                  test_opus_encode_sources)
 get_opus_sources(tests_test_opus_extensions_SOURCES Makefile.am
                  test_opus_extensions_sources)
+get_opus_sources(tests_test_opus_cpu_budget_SOURCES Makefile.am
+                 test_opus_cpu_budget_sources)
 get_opus_sources(tests_test_opus_decode_SOURCES Makefile.am
                  test_opus_decode_sources)
 get_opus_sources(tests_test_opus_padding_SOURCES Makefile.am
                  test_opus_padding_sources)
 get_opus_sources(tests_test_opus_dred_SOURCES Makefile.am
                  test_opus_dred_sources)
+get_opus_sources(tests_test_opus_scratch_SOURCES Makefile.am
+                 test_opus_scratch_sources)
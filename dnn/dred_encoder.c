@@ -81,6 +81,7 @@ void dred_encoder_init(DREDEnc* enc, opus_int32 Fs, int channels)
     enc->Fs = Fs;
     enc->channels = channels;
     enc->loaded = 0;
+    enc->activity_gating = 0;
 #ifndef USE_WEIGHTS_FILE
     if (init_rdovaeenc(&enc->model, rdovaeenc_arrays) == 0) enc->loaded = 1;
 #endif
@@ -110,6 +111,19 @@ static void dred_process_frame(DREDEnc *enc, int arch)
     enc->latents_buffer_fill = IMIN(enc->latents_buffer_fill+1, DRED_NUM_REDUNDANCY_FRAMES);
 }
 
+/* Used instead of dred_process_frame() for gated (inactive) frames. The latents
+   and initial state are held from the last computed frame, which is a good
+   approximation of the slowly-varying latents of silence or background noise,
+   and keeps the buffer aligned with the activity memory. The feature extraction
+   and RDOVAE encoder states are left untouched; since they last saw inactive
+   input, the next computed frame resynchronises without any extra work. */
+static void dred_hold_frame(DREDEnc *enc)
+{
+    OPUS_MOVE(enc->latents_buffer + DRED_LATENT_DIM, enc->latents_buffer, (DRED_MAX_FRAMES - 1) * DRED_LATENT_DIM);
+    OPUS_MOVE(enc->state_buffer + DRED_STATE_DIM, enc->state_buffer, (DRED_MAX_FRAMES - 1) * DRED_STATE_DIM);
+    enc->latents_buffer_fill = IMIN(enc->latents_buffer_fill+1, DRED_NUM_REDUNDANCY_FRAMES);
+}
+
 void filter_df2t(const float *in, float *out, int len, float b0, const float *b, const float *a, int order, float *mem)
 {
     int i;
@@ -189,12 +203,66 @@ static void dred_convert_to_16k(DREDEnc *enc, const float *in, int in_len, float
     }
 }
 
-void dred_compute_latents(DREDEnc *enc, const float *pcm, int frame_size, int extra_delay, int arch)
+/* Resamples with dred_convert_to_16k() and delays the result by DRED_SILK_RESAMPLER_DELAY,
+   so that it lines up with the SILK encoder's 16 kHz signal. */
+static void dred_convert_to_16k_delayed(DREDEnc *enc, const float *in, int in_len, float *out, int out_len)
 {
+    float tmp[DRED_SILK_RESAMPLER_DELAY];
+    celt_assert(out_len >= DRED_SILK_RESAMPLER_DELAY);
+    dred_convert_to_16k(enc, in, in_len, out, out_len);
+    OPUS_COPY(tmp, &out[out_len-DRED_SILK_RESAMPLER_DELAY], DRED_SILK_RESAMPLER_DELAY);
+    OPUS_MOVE(&out[DRED_SILK_RESAMPLER_DELAY], out, out_len-DRED_SILK_RESAMPLER_DELAY);
+    OPUS_COPY(out, enc->resample_delay, DRED_SILK_RESAMPLER_DELAY);
+    OPUS_COPY(enc->resample_delay, tmp, DRED_SILK_RESAMPLER_DELAY);
+}
+
+/* Restarts our resampler when it takes over from the SILK signal. Its memory and delay
+   line are stale by then, so they are rebuilt from the len input samples that precede
+   the frame (the encoder's delay buffer). */
+static void dred_restart_resampler(DREDEnc *enc, const float *history, int len)
+{
+    float out[2*DRED_FRAME_SIZE];
+    int out_len;
+    OPUS_CLEAR(enc->resample_mem, RESAMPLING_ORDER + 1);
+    OPUS_CLEAR(enc->resample_delay, DRED_SILK_RESAMPLER_DELAY);
+    /* Whole 16 kHz samples only, and no more than one of the chunks below */
+    len = IMIN(len, 2*DRED_FRAME_SIZE*enc->Fs/16000);
+    len -= len%3;
+    out_len = len * 16000 / enc->Fs;
+    if (out_len > 0) {
+        dred_convert_to_16k(enc, history, len, out, out_len);
+        if (out_len >= DRED_SILK_RESAMPLER_DELAY) {
+            OPUS_COPY(enc->resample_delay, &out[out_len-DRED_SILK_RESAMPLER_DELAY], DRED_SILK_RESAMPLER_DELAY);
+        } else {
+            OPUS_COPY(&enc->resample_delay[DRED_SILK_RESAMPLER_DELAY-out_len], out, out_len);
+        }
+    }
+}
+
+/* If silk_16k is non-NULL, it must contain the frame_size*16000/Fs samples of the SILK encoder's
+   internal 16 kHz (mid) signal for this frame and is used instead of resampling pcm.
+   pcm must be preceded by the extra_delay input samples that came before it. */
+void dred_compute_latents(DREDEnc *enc, const float *pcm, const opus_int16 *silk_16k, int frame_size, int extra_delay, int activity, int arch)
+{
+    int i;
     int curr_offset16k;
+    int delayed;
     int frame_size16k = frame_size * 16000 / enc->Fs;
     celt_assert(enc->loaded);
+    /* Only an explicit inactive decision counts towards gating. */
+    if (activity == 0) enc->inactive_count = IMIN(enc->inactive_count + frame_size16k, 32767);
+    else enc->inactive_count = 0;
     curr_offset16k = 40 + extra_delay*16000/enc->Fs - enc->input_buffer_fill;
+    /* SILK only feeds us above 16 kHz. There, both signals carry the SILK resampler delay
+       so that switching between them keeps the timeline and the DRED offset unchanged. */
+    delayed = enc->Fs > 16000;
+    if (delayed) {
+        curr_offset16k += DRED_SILK_RESAMPLER_DELAY;
+        if (silk_16k == NULL && enc->silk_input)
+            dred_restart_resampler(enc, pcm - extra_delay*enc->channels, extra_delay);
+    }
+    celt_assert(silk_16k == NULL || delayed);
+    enc->silk_input = silk_16k != NULL;
     enc->dred_offset = (int)floor((curr_offset16k+20.f)/40.f);
     enc->latent_offset = 0;
     while (frame_size16k > 0) {
@@ -202,12 +270,26 @@ void dred_compute_latents(DREDEnc *enc, const float *pcm, int frame_size, int ex
         int process_size;
         process_size16k = IMIN(2*DRED_FRAME_SIZE, frame_size16k);
         process_size = process_size16k * enc->Fs / 16000;
-        dred_convert_to_16k(enc, pcm, process_size, &enc->input_buffer[enc->input_buffer_fill], process_size16k);
+        if (silk_16k != NULL) {
+            for (i=0;i<process_size16k;i++) enc->input_buffer[enc->input_buffer_fill+i] = silk_16k[i];
+            silk_16k += process_size16k;
+        } else if (delayed) {
+            dred_convert_to_16k_delayed(enc, pcm, process_size, &enc->input_buffer[enc->input_buffer_fill], process_size16k);
+        } else {
+            dred_convert_to_16k(enc, pcm, process_size, &enc->input_buffer[enc->input_buffer_fill], process_size16k);
+        }
         enc->input_buffer_fill += process_size16k;
         if (enc->input_buffer_fill >= 2*DRED_FRAME_SIZE)
         {
             curr_offset16k += 320;
-            dred_process_frame(enc, arch);
+            if (enc->activity_gating && enc->inactive_count > DRED_GATING_HANGOVER*2*DRED_FRAME_SIZE
+                  && enc->latents_buffer_fill > 0 && enc->gated_frames < DRED_GATING_DECIMATION-1) {
+                dred_hold_frame(enc);
+                enc->gated_frames++;
+            } else {
+                dred_process_frame(enc, arch);
+                enc->gated_frames = 0;
+            }
             enc->input_buffer_fill -= 2*DRED_FRAME_SIZE;
             OPUS_MOVE(&enc->input_buffer[0], &enc->input_buffer[2*DRED_FRAME_SIZE], enc->input_buffer_fill);
             /* 15 ms (6*2.5 ms) is the ideal offset for DRED because it corresponds to our vocoder look-ahead. */
@@ -38,6 +38,19 @@
 
 #define RESAMPLING_ORDER 8
 
+/* Number of inactive 20-ms DRED frames that are still fully analysed after
+   the last active input frame when activity gating is enabled. This must cover
+   the DRED input delay and the 40-ms activity window used by dred_voice_active(). */
+#define DRED_GATING_HANGOVER 4
+/* During gated stretches, only one DRED frame out of DRED_GATING_DECIMATION is
+   run through the RDOVAE encoder; the others repeat the last computed latents. */
+#define DRED_GATING_DECIMATION 4
+
+/* Extra delay (in 16 kHz samples) of the SILK encoder's 16 kHz input signal compared to
+   dred_convert_to_16k(), for 24 and 48 kHz input. Our own resampler output is delayed by
+   the same amount at those rates so that either signal can be used for any frame. */
+#define DRED_SILK_RESAMPLER_DELAY 8
+
 typedef struct {
     RDOVAEEnc model;
     LPCNetEncState lpcnet_enc_state;
@@ -45,6 +58,7 @@ typedef struct {
     int loaded;
     opus_int32 Fs;
     int channels;
+    int activity_gating;
 
 #define DREDENC_RESET_START input_buffer
     float input_buffer[2*DRED_DFRAME_SIZE];
@@ -56,6 +70,10 @@ typedef struct {
     int latents_buffer_fill;
     float state_buffer[DRED_MAX_FRAMES * DRED_STATE_DIM];
     float resample_mem[RESAMPLING_ORDER + 1];
+    float resample_delay[DRED_SILK_RESAMPLER_DELAY];
+    int inactive_count;
+    int gated_frames;
+    int silk_input;
 } DREDEnc;
 
 int dred_encoder_load_model(DREDEnc* enc, const void *data, int len);
@@ -64,7 +82,7 @@ void dred_encoder_reset(DREDEnc* enc);
 
 void dred_deinit_encoder(DREDEnc *enc);
 
-void dred_compute_latents(DREDEnc *enc, const float *pcm, int frame_size, int extra_delay, int arch);
+void dred_compute_latents(DREDEnc *enc, const float *pcm, const opus_int16 *silk_16k, int frame_size, int extra_delay, int activity, int arch);
 
 int dred_encode_silk_frame(DREDEnc *enc, unsigned char *buf, int max_chunks, int max_bytes, int q0, int dQ, int qmax, unsigned char *activity_mem, int arch);
 
@@ -28,6 +28,7 @@
 #include "config.h"
 #endif
 
+#include <string.h>
 #include "fargan.h"
 #include "os_support.h"
 #include "freq.h"
@@ -58,6 +59,43 @@ static void compute_fargan_cond(FARGANState *st, float *cond, const float *featu
   compute_generic_dense(&model->cond_net_fdense2, cond, fdense2_in, ACTIVATION_TANH, st->arch);
 }
 
+static int fargan_period(const float *features)
+{
+  return (int)floor(.5+256./pow(2.f,((1./60.)*((features[NB_BANDS]+1.5)*60))));
+}
+
+/* Drops the conditioning vectors that were computed ahead but not used, rewinding the
+   conditioning network state to match the frames that were actually synthesized. */
+static void fargan_discard_cond_batch(FARGANState *st)
+{
+  int i;
+  if (st->cond_batch_pos < st->cond_batch_size) {
+    float cond[COND_NET_FDENSE2_OUT_SIZE];
+    OPUS_COPY(st->cond_conv1_state, st->cond_conv1_bak, COND_NET_FCONV1_STATE_SIZE);
+    for (i=0;i<st->cond_batch_pos;i++) {
+      compute_fargan_cond(st, cond, &st->cond_batch_features[i*NB_FEATURES], st->cond_batch_period[i]);
+    }
+  }
+  st->cond_batch_pos = st->cond_batch_size = 0;
+}
+
+/* Computes the frame-rate conditioning for the next nb_frames frames in one go, so that
+   the conditioning network weights only need to be brought into cache once. The result is
+   only used by fargan_synthesize() if it is called with the same features, in order. */
+void fargan_prepare_cond(FARGANState *st, const float *features, int nb_frames)
+{
+  int i;
+  fargan_discard_cond_batch(st);
+  nb_frames = IMIN(nb_frames, FARGAN_MAX_COND_BATCH);
+  OPUS_COPY(st->cond_conv1_bak, st->cond_conv1_state, COND_NET_FCONV1_STATE_SIZE);
+  for (i=0;i<nb_frames;i++) {
+    OPUS_COPY(&st->cond_batch_features[i*NB_FEATURES], &features[i*NB_FEATURES], NB_FEATURES);
+    st->cond_batch_period[i] = fargan_period(&features[i*NB_FEATURES]);
+    compute_fargan_cond(st, &st->cond_batch[i*COND_NET_FDENSE2_OUT_SIZE], &features[i*NB_FEATURES], st->cond_batch_period[i]);
+  }
+  st->cond_batch_size = nb_frames;
+}
+
 static void fargan_deemphasis(float *pcm, float *deemph_mem) {
   int i;
   for (i=0;i<FARGAN_SUBFRAME_SIZE;i++) {
@@ -147,11 +185,12 @@ void fargan_cont(FARGANState *st, const float *pcm0, const float *features0)
   float dummy[FARGAN_SUBFRAME_SIZE];
   int period=0;
 
+  fargan_discard_cond_batch(st);
   /* Pre-load features. */
   for (i=0;i<5;i++) {
     const float *features = &features0[i*NB_FEATURES];
     st->last_period = period;
-    period = (int)floor(.5+256./pow(2.f,((1./60.)*((features[NB_BANDS]+1.5)*60))));
+    period = fargan_period(features);
     compute_fargan_cond(st, cond, features, period);
   }
 
@@ -197,14 +236,23 @@ int fargan_load_model(FARGANState *st, const void *data, int len) {
 static void fargan_synthesize_impl(FARGANState *st, float *pcm, const float *features)
 {
   int subframe;
-  float cond[COND_NET_FDENSE2_OUT_SIZE];
+  float cond_buf[COND_NET_FDENSE2_OUT_SIZE];
+  const float *cond;
   int period;
   celt_assert(st->cont_initialized);
 
-  period = (int)floor(.5+256./pow(2.f,((1./60.)*((features[NB_BANDS]+1.5)*60))));
-  compute_fargan_cond(st, cond, features, period);
+  period = fargan_period(features);
+  if (st->cond_batch_pos < st->cond_batch_size
+      && memcmp(features, &st->cond_batch_features[st->cond_batch_pos*NB_FEATURES], NB_FEATURES*sizeof(*features)) == 0) {
+    cond = &st->cond_batch[st->cond_batch_pos*COND_NET_FDENSE2_OUT_SIZE];
+    st->cond_batch_pos++;
+  } else {
+    fargan_discard_cond_batch(st);
+    compute_fargan_cond(st, cond_buf, features, period);
+    cond = cond_buf;
+  }
   for (subframe=0;subframe<FARGAN_NB_SUBFRAMES;subframe++) {
-    float *sub_cond;
+    const float *sub_cond;
     sub_cond = &cond[subframe*FARGAN_COND_SIZE];
     run_fargan_subframe(st, &pcm[subframe*FARGAN_SUBFRAME_SIZE], sub_cond, st->last_period);
   }
@@ -42,6 +42,10 @@
 #define SIG_NET_FWC0_STATE_SIZE (2*SIG_NET_INPUT_SIZE)
 
 #define FARGAN_MAX_RNN_NEURONS SIG_NET_GRU1_OUT_SIZE
+
+/* Maximum number of frames whose conditioning can be computed ahead of synthesis. */
+#define FARGAN_MAX_COND_BATCH 8
+
 typedef struct {
   FARGAN model;
   int arch;
@@ -54,6 +58,12 @@ typedef struct {
   float gru2_state[SIG_NET_GRU2_STATE_SIZE];
   float gru3_state[SIG_NET_GRU3_STATE_SIZE];
   int last_period;
+  int cond_batch_pos;
+  int cond_batch_size;
+  int cond_batch_period[FARGAN_MAX_COND_BATCH];
+  float cond_batch_features[FARGAN_MAX_COND_BATCH*NB_FEATURES];
+  float cond_batch[FARGAN_MAX_COND_BATCH*COND_NET_FDENSE2_OUT_SIZE];
+  float cond_conv1_bak[COND_NET_FCONV1_STATE_SIZE];
 } FARGANState;
 
 void fargan_init(FARGANState *st);
@@ -61,6 +71,8 @@ int fargan_load_model(FARGANState *st, const void *data, int len);
 
 void fargan_cont(FARGANState *st, const float *pcm0, const float *features0);
 
+void fargan_prepare_cond(FARGANState *st, const float *features, int nb_frames);
+
 void fargan_synthesize(FARGANState *st, float *pcm, const float *features);
 void fargan_synthesize_int(FARGANState *st, opus_int16 *pcm, const float *features);
 
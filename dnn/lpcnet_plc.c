@@ -58,6 +58,8 @@ void lpcnet_plc_reset(LPCNetPLCState *st) {
 int lpcnet_plc_init(LPCNetPLCState *st) {
   int ret;
   st->arch = opus_select_arch();
+  st->dnn_clock = NULL;
+  st->dnn_time = 0;
   fargan_init(&st->fargan);
   lpcnet_encoder_init(&st->enc);
   st->loaded = 0;
@@ -158,8 +160,10 @@ int lpcnet_plc_update(LPCNetPLCState *st, opus_int16 *pcm) {
 }
 
 static const float att_table[10] = {0, 0,  -.2, -.2,  -.4, -.4,  -.8, -.8, -1.6, -1.6};
-int lpcnet_plc_conceal(LPCNetPLCState *st, opus_int16 *pcm) {
+static int lpcnet_plc_conceal_impl(LPCNetPLCState *st, opus_int16 *pcm) {
   int i;
+  int fec;
+  int queued;
   celt_assert(st->loaded);
   if (st->blend == 0) {
     int count = 0;
@@ -195,10 +199,24 @@ int lpcnet_plc_conceal(LPCNetPLCState *st, opus_int16 *pcm) {
   }
   st->plc_bak[0] = st->plc_bak[1];
   st->plc_bak[1] = st->plc_net;
-  if (get_fec_or_pred(st, st->features)) st->loss_count = 0;
+  fec = get_fec_or_pred(st, st->features);
+  if (fec) st->loss_count = 0;
   else st->loss_count++;
   if (st->loss_count >= 10) st->features[0] = MAX16(-10, st->features[0]+att_table[9] - 2*(st->loss_count-9));
   else st->features[0] = MAX16(-10, st->features[0]+att_table[st->loss_count]);
+  queued = st->fec_fill_pos - st->fec_read_pos;
+  if (fec && queued > 0 && st->fargan.cond_batch_pos >= st->fargan.cond_batch_size) {
+    /* When recovering several frames from DRED, the upcoming features are already known,
+       so compute their FARGAN conditioning together. */
+    float batch[FARGAN_MAX_COND_BATCH*NB_FEATURES];
+    int nb_frames = IMIN(queued+1, FARGAN_MAX_COND_BATCH);
+    OPUS_COPY(batch, st->features, NB_FEATURES);
+    for (i=1;i<nb_frames;i++) {
+      OPUS_COPY(&batch[i*NB_FEATURES], &st->fec[st->fec_read_pos+i-1][0], NB_FEATURES);
+      batch[i*NB_FEATURES] = MAX16(-10, batch[i*NB_FEATURES]+att_table[0]);
+    }
+    fargan_prepare_cond(&st->fargan, batch, nb_frames);
+  }
   fargan_synthesize_int(&st->fargan, pcm, &st->features[0]);
   queue_features(st, st->features);
   if (st->analysis_pos - FRAME_SIZE >= 0) st->analysis_pos -= FRAME_SIZE;
@@ -209,3 +227,13 @@ int lpcnet_plc_conceal(LPCNetPLCState *st, opus_int16 *pcm) {
   st->blend = 1;
   return 0;
 }
+
+int lpcnet_plc_conceal(LPCNetPLCState *st, opus_int16 *pcm) {
+  int ret;
+  double start;
+  if (st->dnn_clock == NULL) return lpcnet_plc_conceal_impl(st, pcm);
+  start = st->dnn_clock();
+  ret = lpcnet_plc_conceal_impl(st, pcm);
+  st->dnn_time += st->dnn_clock() - start;
+  return ret;
+}
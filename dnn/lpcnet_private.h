@@ -53,6 +53,10 @@ struct LPCNetPLCState {
   LPCNetEncState enc;
   int loaded;
   int arch;
+  /* While the Opus decoder has a DNN CPU budget, the clock it times the neural
+     processing with (NULL otherwise) and the time spent since it last looked. */
+  double (*dnn_clock)(void);
+  double dnn_time;
 
 #define LPCNET_PLC_RESET_START fec
   float fec[PLC_MAX_FEC][NB_FEATURES];
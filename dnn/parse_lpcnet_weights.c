@@ -63,9 +63,15 @@ int parse_weights(WeightArray **list, const void *data, int len)
     ret = parse_record(&data, &len, &array);
     if (ret > 0) {
       if (nb_arrays+1 >= capacity) {
+        WeightArray *tmp;
         /* Make sure there's room for the ending NULL element too. */
         capacity = capacity*3/2;
-        *list = opus_realloc(*list, capacity*sizeof(WeightArray));
+        /* No realloc() since allocators installed with opus_set_allocator()
+           do not provide one. */
+        tmp = opus_alloc(capacity*sizeof(WeightArray));
+        OPUS_COPY(tmp, *list, nb_arrays);
+        opus_free(*list);
+        *list = tmp;
       }
       (*list)[nb_arrays++] = array;
     } else {
@@ -326,6 +326,82 @@ OPUS_EXPORT void opus_encoder_destroy(OpusEncoder *st);
   * @see opus_encoderctls
   */
 OPUS_EXPORT int opus_encoder_ctl(OpusEncoder *st, int request, ...) OPUS_ARG_NONNULL(1);
+
+/** Gets the size of an encoder state snapshot.
+  * A snapshot holds the parts of an <code>OpusEncoder</code> that change while
+  * encoding, including the settings made with opus_encoder_ctl(). Model weights,
+  * unused channel state, history that is always overwritten before use and the
+  * scratch arena are left out, so it is smaller than opus_encoder_get_size().
+  * @param[in] channels <tt>int</tt>: Number of channels.
+  *                                   This must be 1 or 2.
+  * @returns The size in bytes, or 0 if channels is invalid.
+  */
+OPUS_EXPORT OPUS_WARN_UNUSED_RESULT int opus_encoder_get_snapshot_size(int channels);
+
+/** Saves the state of an encoder.
+  * This is intended for speculative encoding: take a snapshot, encode a frame
+  * with trial settings, then return to the snapshot with opus_encoder_restore()
+  * and encode again. Encoding after a restore produces exactly the same packets
+  * as if the trial encode never happened.
+  * @param [in] st <tt>OpusEncoder*</tt>: Encoder state
+  * @param [out] snapshot <tt>void*</tt>: Buffer of at least
+  *                                      opus_encoder_get_snapshot_size() bytes.
+  *                                      It has no alignment requirement.
+  * @retval #OPUS_OK Success
+  */
+OPUS_EXPORT int opus_encoder_snapshot(const OpusEncoder *st, void *snapshot) OPUS_ARG_NONNULL(1) OPUS_ARG_NONNULL(2);
+
+/** Restores an encoder to a state saved with opus_encoder_snapshot().
+  * The snapshot must come from this encoder or from another one with the same
+  * channel count, which then continues exactly as the original would have.
+  * @param [in] st <tt>OpusEncoder*</tt>: Encoder state
+  * @param [in] snapshot <tt>const void*</tt>: Snapshot to restore
+  * @retval #OPUS_OK Success
+  * @retval #OPUS_BAD_ARG The snapshot was taken with a different channel count
+  */
+OPUS_EXPORT int opus_encoder_restore(OpusEncoder *st, const void *snapshot) OPUS_ARG_NONNULL(1) OPUS_ARG_NONNULL(2);
+
+/** CPU budget shared between encoders, or between decoders.
+  * Encoders attached to the same budget with @ref OPUS_SET_CPU_BUDGET add up
+  * the wall-clock time they spend encoding, and lower their complexity while
+  * the total exceeds the budget's target. Decoders attached with
+  * @ref OPUS_SET_DNN_CPU_BUDGET do the same with the time of their neural
+  * processing. The budget may be shared between encoders or decoders running
+  * in different threads.
+  * @see opus_cpu_budget_create,opus_cpu_budget_init
+  */
+typedef struct OpusCPUBudget OpusCPUBudget;
+
+/** Gets the size of an <code>OpusCPUBudget</code> structure.
+  * @returns The size in bytes.
+  */
+OPUS_EXPORT int opus_cpu_budget_get_size(void);
+
+/** Initializes an <code>OpusCPUBudget</code>.
+  * This must not be called while encoders or decoders are attached to the
+  * budget.
+  * @param [in] budget <tt>OpusCPUBudget*</tt>: Budget to be initialized.
+  * @param [in] target_us <tt>opus_int32</tt>: Wall-clock time, in microseconds,
+  *                                          that all the encoders or decoders
+  *                                          sharing the budget may spend
+  *                                          together in every 20 ms of real
+  *                                          time. This must be positive.
+  * @retval #OPUS_OK Success
+  * @retval #OPUS_BAD_ARG The target is not positive
+  */
+OPUS_EXPORT int opus_cpu_budget_init(OpusCPUBudget *budget, opus_int32 target_us) OPUS_ARG_NONNULL(1);
+
+/** Allocates and initializes an <code>OpusCPUBudget</code>.
+  * @param [in] target_us <tt>opus_int32</tt>: See opus_cpu_budget_init().
+  * @param [out] error <tt>int*</tt>: #OPUS_OK Success or @ref opus_errorcodes
+  */
+OPUS_EXPORT OPUS_WARN_UNUSED_RESULT OpusCPUBudget *opus_cpu_budget_create(opus_int32 target_us, int *error);
+
+/** Frees an <code>OpusCPUBudget</code> allocated by opus_cpu_budget_create().
+  * All encoders and decoders must have been detached or destroyed first.
+  * @param[in] budget <tt>OpusCPUBudget*</tt>: Budget to be freed.
+  */
+OPUS_EXPORT void opus_cpu_budget_destroy(OpusCPUBudget *budget);
 /**@}*/
 
 /** @defgroup opus_decoder Opus Decoder
@@ -597,6 +673,12 @@ OPUS_EXPORT int opus_dred_parse(OpusDREDDecoder *dred_dec, OpusDRED *dred, const
 OPUS_EXPORT int opus_dred_process(OpusDREDDecoder *dred_dec, const OpusDRED *src, OpusDRED *dst);
 
 /** Decode audio from an Opus DRED packet with floating point output.
+  * A burst of consecutive lost frames can be recovered with a single call, with
+  * \a dred_offset pointing at the start of the burst and \a frame_size covering all
+  * of it. The output is the same as with one call per frame (each with \a dred_offset
+  * reduced by the samples already recovered), but the deep PLC can then compute the
+  * conditioning for the whole burst at once. Only the first second of a call is
+  * recovered from the redundancy; anything beyond that is concealed.
   * @param [in] st <tt>OpusDecoder*</tt>: Decoder state
   * @param [in] dred <tt>OpusDRED*</tt>: DRED state
   * @param [in] dred_offset <tt>opus_int32</tt>: position of the redundancy to decode (in samples before the beginning of the real audio data in the packet).
@@ -617,6 +699,7 @@ OPUS_EXPORT int opus_decoder_dred_decode(OpusDecoder *st, const OpusDRED *dred,
   * @param [in] frame_size Number of samples per channel to decode in \a pcm.
   *  frame_size <b>must</b> be a multiple of 2.5 ms.
   * @returns Number of decoded samples or @ref opus_errorcodes
+  * @see opus_decoder_dred_decode
   */
 OPUS_EXPORT int opus_decoder_dred_decode_float(OpusDecoder *st, const OpusDRED *dred, opus_int32 dred_offset, float *pcm, opus_int32 frame_size);
 
@@ -34,6 +34,7 @@
 #define OPUS_DEFINES_H
 
 #include "opus_types.h"
+#include <stddef.h> /* size_t */
 
 #ifdef __cplusplus
 extern "C" {
@@ -173,6 +174,14 @@ extern "C" {
 #define OPUS_GET_DRED_DURATION_REQUEST 4051
 #define OPUS_SET_DNN_BLOB_REQUEST 4052
 /*#define OPUS_GET_DNN_BLOB_REQUEST 4053 */
+#define OPUS_SET_DRED_ACTIVITY_GATING_REQUEST 4054
+#define OPUS_GET_DRED_ACTIVITY_GATING_REQUEST 4055
+#define OPUS_SET_DNN_CPU_BUDGET_REQUEST 4056
+#define OPUS_GET_DNN_CPU_BUDGET_REQUEST 4057
+#define OPUS_SET_CPU_BUDGET_REQUEST 4058
+#define OPUS_GET_CPU_BUDGET_REQUEST 4059
+#define OPUS_GET_SCRATCH_USAGE_REQUEST 4060
+#define OPUS_GET_PEAK_SCRATCH_USAGE_REQUEST 4061
 
 /** Defines for the presence of extended APIs. */
 #define OPUS_HAVE_OPUS_PROJECTION_H
@@ -644,6 +653,53 @@ extern "C" {
   * @hideinitializer */
 #define OPUS_GET_DRED_DURATION(x) OPUS_GET_DRED_DURATION_REQUEST, __opus_check_int_ptr(x)
 
+/** If set to 1, the Deep Redundancy (DRED) encoder only runs its full analysis
+  * sparsely during inactive (silent or background noise) stretches, reusing the
+  * last computed latents in between. This reduces the DRED encoder complexity
+  * for mostly-inactive streams at a small cost in redundancy quality around
+  * speech onsets.
+  * @see OPUS_GET_DRED_ACTIVITY_GATING
+  * @param[in] x <tt>opus_int32</tt>: Allowed values:
+  * <dl>
+  * <dt>0</dt><dd>Analyse every DRED frame (default).</dd>
+  * <dt>1</dt><dd>Gate the DRED analysis on voice activity.</dd>
+  * </dl>
+  * @hideinitializer */
+#define OPUS_SET_DRED_ACTIVITY_GATING(x) OPUS_SET_DRED_ACTIVITY_GATING_REQUEST, __opus_check_int(x)
+/** Gets the encoder's configured DRED activity gating.
+  * @see OPUS_SET_DRED_ACTIVITY_GATING
+  * @param[out] x <tt>opus_int32 *</tt>: Returns one of the following values:
+  * <dl>
+  * <dt>0</dt><dd>Activity gating disabled (default).</dd>
+  * <dt>1</dt><dd>Activity gating enabled.</dd>
+  * </dl>
+  * @hideinitializer */
+#define OPUS_GET_DRED_ACTIVITY_GATING(x) OPUS_GET_DRED_ACTIVITY_GATING_REQUEST, __opus_check_int_ptr(x)
+
+/** Attaches the encoder to a CPU budget shared with other encoders.
+  * While attached, the encoder measures the wall-clock time each call takes
+  * and adds it to the budget. Whenever all the encoders sharing the budget
+  * take longer than its target, the encoder lowers the complexity it actually
+  * uses. DRED is turned off before the complexity goes below the lowest value
+  * that runs the signal analysis (7, or 10 in fixed-point builds), since
+  * without that analysis DRED cannot tell where the speech is. It restores
+  * them one step at a time (up to the value set with
+  * @ref OPUS_SET_COMPLEXITY) once the load is comfortably below the target. @ref OPUS_GET_COMPLEXITY and
+  * @ref OPUS_GET_DRED_DURATION keep returning the configured values.
+  * This setting survives encoder reset, but not opus_encoder_init().
+  * @see OPUS_GET_CPU_BUDGET
+  * @see opus_cpu_budget_create
+  * @param[in] x <tt>OpusCPUBudget *</tt>: Budget to share, which must outlive
+  *                                       the encoder, or NULL to detach
+  *                                       (default).
+  * @hideinitializer */
+#define OPUS_SET_CPU_BUDGET(x) OPUS_SET_CPU_BUDGET_REQUEST, __opus_check_void_ptr(x)
+/** Gets the CPU budget the encoder is attached to.
+  * @see OPUS_SET_CPU_BUDGET
+  * @param[out] x <tt>OpusCPUBudget **</tt>: The budget, or NULL when detached.
+  * @hideinitializer */
+#define OPUS_GET_CPU_BUDGET(x) OPUS_GET_CPU_BUDGET_REQUEST, __opus_check_void_ptr(x)
+
 /** Provide external DNN weights from binary object (only when explicitly built without the weights)
   * @hideinitializer */
 #define OPUS_SET_DNN_BLOB(data, len) OPUS_SET_DNN_BLOB_REQUEST, __opus_check_void_ptr(data), __opus_check_int(len)
@@ -757,6 +813,26 @@ extern "C" {
   * </dl>
   * @hideinitializer */
 #define OPUS_GET_IN_DTX(x) OPUS_GET_IN_DTX_REQUEST, __opus_check_int_ptr(x)
+/** Gets the amount of temporary memory used by the most recent encode or
+  * decode call on this instance.
+  * This is only available when the library is built with a scratch arena
+  * (<code>OPUS_SCRATCH_ARENA</code>) or a pseudostack
+  * (<code>OPUS_NONTHREADSAFE_PSEUDOSTACK</code>); other builds return
+  * #OPUS_UNIMPLEMENTED.
+  * About the same amount of stack would be used for temporary arrays by a
+  * build using variable length arrays or alloca().
+  * For multistream and projection objects, this covers all the streams.
+  * @see OPUS_GET_PEAK_SCRATCH_USAGE
+  * @param[out] x <tt>opus_int32 *</tt>: Peak scratch usage in bytes.
+  * @hideinitializer */
+#define OPUS_GET_SCRATCH_USAGE(x) OPUS_GET_SCRATCH_USAGE_REQUEST, __opus_check_int_ptr(x)
+/** Gets the largest amount of temporary memory used by any encode or decode
+  * call since this instance was initialized. Resetting the state does not
+  * clear it.
+  * @see OPUS_GET_SCRATCH_USAGE
+  * @param[out] x <tt>opus_int32 *</tt>: Peak scratch usage in bytes.
+  * @hideinitializer */
+#define OPUS_GET_PEAK_SCRATCH_USAGE(x) OPUS_GET_PEAK_SCRATCH_USAGE_REQUEST, __opus_check_int_ptr(x)
 
 /**@}*/
 
@@ -799,6 +875,30 @@ extern "C" {
   * @hideinitializer */
 #define OPUS_GET_PITCH(x) OPUS_GET_PITCH_REQUEST, __opus_check_int_ptr(x)
 
+/** Attaches the decoder's neural processing to a CPU budget shared with other
+  * decoders.
+  * While attached, the decoder measures the wall-clock time its deep PLC and
+  * OSCE take and adds it to the budget. Whenever all the decoders sharing the
+  * budget take longer than its target, the decoder steps its enhancement down
+  * from NoLACE to LACE, then disables OSCE, then falls back from deep PLC to
+  * classic PLC. It steps back up once the load is well under the target
+  * again. The configured complexity remains the upper limit. The budget
+  * should not be shared with encoders, which count all their time. This has
+  * no effect unless the library was built with deep PLC or OSCE. This setting
+  * survives decoder reset.
+  * @see OPUS_GET_DNN_CPU_BUDGET
+  * @see opus_cpu_budget_create
+  * @param[in] x <tt>OpusCPUBudget *</tt>: Budget to share, which must outlive
+  *                                       the decoder, or NULL to detach
+  *                                       (default).
+  * @hideinitializer */
+#define OPUS_SET_DNN_CPU_BUDGET(x) OPUS_SET_DNN_CPU_BUDGET_REQUEST, __opus_check_void_ptr(x)
+/** Gets the CPU budget the decoder's neural processing is attached to.
+  * @see OPUS_SET_DNN_CPU_BUDGET
+  * @param[out] x <tt>OpusCPUBudget **</tt>: The budget, or NULL when detached.
+  * @hideinitializer */
+#define OPUS_GET_DNN_CPU_BUDGET(x) OPUS_GET_DNN_CPU_BUDGET_REQUEST, __opus_check_void_ptr(x)
+
 /**@}*/
 
 /** @defgroup opus_libinfo Opus library information functions
@@ -821,6 +921,43 @@ OPUS_EXPORT const char *opus_strerror(int error);
   * @returns Version string
   */
 OPUS_EXPORT const char *opus_get_version_string(void);
+
+/** Allocation function used by the library once installed with
+  * opus_set_allocator().
+  *
+  * @param[in] user_data <tt>void*</tt>: Pointer given to opus_set_allocator()
+  * @param[in] size <tt>size_t</tt>: Number of bytes to allocate
+  * @param[in] alignment <tt>size_t</tt>: Required alignment of the returned
+  *                                       pointer in bytes (a power of two)
+  * @returns Pointer to the allocated memory, or NULL on failure
+  */
+typedef void *(*opus_alloc_callback)(void *user_data, size_t size, size_t alignment);
+
+/** Function releasing memory obtained from an #opus_alloc_callback.
+  *
+  * @param[in] user_data <tt>void*</tt>: Pointer given to opus_set_allocator()
+  * @param[in] ptr <tt>void*</tt>: Memory to release (never NULL)
+  */
+typedef void (*opus_free_callback)(void *user_data, void *ptr);
+
+/** Installs the functions used for all the memory the library allocates:
+  * encoder and decoder states from the *_create() functions, DRED objects,
+  * neural network weights and custom modes. Passing NULL for both functions
+  * restores malloc() and free().
+  *
+  * The allocator is global to the library. It must be installed before any
+  * of these objects is created, and not changed while any of them is still
+  * alive or while another thread may be calling into the library.
+  *
+  * @param[in] alloc_func <tt>opus_alloc_callback</tt>: Allocation function
+  * @param[in] free_func <tt>opus_free_callback</tt>: Release function
+  * @param[in] user_data <tt>void*</tt>: Passed to both functions
+  * @returns #OPUS_OK on success, #OPUS_BAD_ARG if only one of the functions
+  *          is NULL, or #OPUS_UNIMPLEMENTED if the library was built with its
+  *          own allocation functions
+  */
+OPUS_EXPORT int opus_set_allocator(opus_alloc_callback alloc_func,
+      opus_free_callback free_func, void *user_data);
 /**@}*/
 
 #ifdef __cplusplus
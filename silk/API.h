@@ -63,6 +63,30 @@ opus_int silk_Get_Encoder_Size(                         /* O    Returns error co
     opus_int                        *encSizeBytes       /* O    Number of bytes in SILK encoder state           */
 );
 
+/*****************************************************/
+/* Get size in bytes of a Silk encoder state snapshot */
+/*****************************************************/
+opus_int silk_Get_Encoder_Snapshot_Size(                /* O    Returns error code                              */
+    opus_int                        nChannelsAPI,       /* I    Number of API channels (1 or 2)                 */
+    opus_int                        *snapshotSizeBytes  /* O    Number of bytes in a snapshot                   */
+);
+
+/***************************************************/
+/* Save/restore the encoder state, returns bytes   */
+/* copied. The second channel is left out for mono */
+/***************************************************/
+opus_int silk_SaveEncoder(
+    const void                      *encState,          /* I    State                                           */
+    opus_int                        nChannelsAPI,       /* I    Number of API channels (1 or 2)                 */
+    unsigned char                   *snapshot           /* O    Snapshot                                        */
+);
+
+opus_int silk_RestoreEncoder(
+    void                            *encState,          /* O    State                                           */
+    opus_int                        nChannelsAPI,       /* I    Number of API channels (1 or 2)                 */
+    const unsigned char             *snapshot           /* I    Snapshot                                        */
+);
+
 /*************************/
 /* Init or reset encoder */
 /*************************/
@@ -85,7 +109,8 @@ opus_int silk_Encode(                                   /* O    Returns error co
     ec_enc                          *psRangeEnc,        /* I/O  Compressor data structure                       */
     opus_int32                      *nBytesOut,         /* I/O  Number of bytes in payload (input: Max bytes)   */
     const opus_int                  prefillFlag,        /* I    Flag to indicate prefilling buffers no coding   */
-    int                             activity            /* I    Decision of Opus voice activity detector        */
+    int                             activity,           /* I    Decision of Opus voice activity detector        */
+    opus_int16                      *internalOut        /* O    Resampled (mono) input at internal rate, or NULL */
 );
 
 /****************************************/
@@ -117,7 +142,8 @@ opus_int silk_ResetDecoder(                              /* O    Returns error c
 );
 
 opus_int silk_InitDecoder(                              /* O    Returns error code                              */
-    void                            *decState           /* I/O  State                                           */
+    void                            *decState,          /* I/O  State                                           */
+    int                              arch               /* I    Run-time architecture                           */
 );
 
 /******************/
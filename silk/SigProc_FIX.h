@@ -274,6 +274,17 @@ opus_int silk_pitch_analysis_core(                  /* O    Voicing estimate: 0
     int                         arch                /* I    Run-time architecture                                       */
 );
 
+/* Stage 2 pitch search kernel: correlations with, and energies of, target[ -lags[ j ] ] */
+void silk_P_Ana_calc_corr_nrg_st2_c(
+    opus_int32                  xcorr[],            /* O    Cross-correlations, one per lag                             */
+    opus_int32                  energy[],           /* O    Energies of the lagged vectors, one per lag                 */
+    const opus_int16            target[],           /* I    Target vector, preceded by at least max(lags) samples       */
+    const opus_int16            lags[],             /* I    Lags to evaluate                                            */
+    const opus_int              nb_lags,            /* I    Number of lags                                              */
+    const opus_int              len,                /* I    Vector length                                               */
+    int                         arch                /* I    Run-time architecture                                       */
+);
+
 /* Compute Normalized Line Spectral Frequencies (NLSFs) from whitening filter coefficients      */
 /* If not all roots are found, the a_Q16 coefficients are bandwidth expanded until convergence. */
 void silk_A2NLSF(
@@ -614,6 +625,11 @@ static OPUS_INLINE opus_int64 silk_max_64(opus_int64 a, opus_int64 b)
     ((void)(arch), silk_burg_modified_c(res_nrg, res_nrg_Q, A_Q16, x, minInvGain_Q30, subfr_length, nb_subfr, D, arch))
 #endif
 
+#if !defined(OVERRIDE_silk_P_Ana_calc_corr_nrg_st2)
+#define silk_P_Ana_calc_corr_nrg_st2(xcorr, energy, target, lags, nb_lags, len, arch) \
+    ((void)(arch), silk_P_Ana_calc_corr_nrg_st2_c(xcorr, energy, target, lags, nb_lags, len, arch))
+#endif
+
 #if !defined(OVERRIDE_silk_inner_prod16)
 #define silk_inner_prod16(inVec1, inVec2, len, arch) \
     ((void)(arch),silk_inner_prod16_c(inVec1, inVec2, len))
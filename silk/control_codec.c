@@ -235,6 +235,8 @@ static opus_int silk_setup_fs(
         }
         psEnc->sCmn.PacketSize_ms  = PacketSize_ms;
         psEnc->sCmn.TargetRate_bps = 0;         /* trigger new SNR computation */
+        psEnc->sCmn.gainMultPred_Q7 = 0;
+        psEnc->sCmn.bitsPerGainOct  = 0;
     }
 
     /* Set internal sampling frequency */
@@ -249,6 +251,8 @@ static opus_int silk_setup_fs(
         psEnc->sCmn.inputBufIx                  = 0;
         psEnc->sCmn.nFramesEncoded              = 0;
         psEnc->sCmn.TargetRate_bps              = 0;     /* trigger new SNR computation */
+        psEnc->sCmn.gainMultPred_Q7             = 0;
+        psEnc->sCmn.bitsPerGainOct              = 0;
 
         /* Initialize non-zero parameters */
         psEnc->sCmn.prevLag                     = 100;
@@ -105,7 +105,8 @@ opus_int silk_ResetDecoder(                              /* O    Returns error c
 
 
 opus_int silk_InitDecoder(                              /* O    Returns error code                              */
-    void                            *decState           /* I/O  State                                           */
+    void                            *decState,          /* I/O  State                                           */
+    int                              arch               /* I    Run-time architecture                           */
 )
 {
     opus_int n, ret = SILK_NO_ERROR;
@@ -119,7 +120,7 @@ opus_int silk_InitDecoder(                              /* O    Returns error co
 #endif
 
     for( n = 0; n < DECODER_NUM_CHANNELS; n++ ) {
-        ret  = silk_init_decoder( &channel_state[ n ] );
+        ret  = silk_init_decoder( &channel_state[ n ], arch );
     }
     silk_memset(&((silk_decoder *)decState)->sStereo, 0, sizeof(((silk_decoder *)decState)->sStereo));
     /* Not strictly needed, but it's cleaner that way */
@@ -171,7 +172,7 @@ opus_int silk_Decode(                                   /* O    Returns error co
 
     /* If Mono -> Stereo transition in bitstream: init state of second channel */
     if( decControl->nChannelsInternal > psDec->nChannelsInternal ) {
-        ret += silk_init_decoder( &channel_state[ 1 ] );
+        ret += silk_init_decoder( &channel_state[ 1 ], arch );
     }
 
     stereo_to_mono = decControl->nChannelsInternal == 1 && psDec->nChannelsInternal == 2 &&
@@ -356,6 +357,9 @@ opus_int silk_Decode(                                   /* O    Returns error co
             if ( channel_state[n].osce.method != decControl->osce_method ) {
                 osce_reset( &channel_state[n].osce, decControl->osce_method );
             }
+            /* Only the mid channel gets the deep PLC state, but both count their enhancement time */
+            channel_state[n].osce.dnn_clock = lpcnet->dnn_clock;
+            channel_state[n].osce.dnn_time = 0;
 #endif
             ret += silk_decode_frame( &channel_state[ n ], psRangeDec, &samplesOut1_tmp[ n ][ 2 ], &nSamplesOutDec, lostFlag, condCoding,
 #ifdef ENABLE_DEEP_PLC
@@ -365,6 +369,9 @@ opus_int silk_Decode(                                   /* O    Returns error co
                 &psDec->osce_model,
 #endif
                 arch);
+#ifdef ENABLE_OSCE
+            lpcnet->dnn_time += channel_state[n].osce.dnn_time;
+#endif
         } else {
             silk_memset( &samplesOut1_tmp[ n ][ 2 ], 0, nSamplesOutDec * sizeof( opus_int16 ) );
         }
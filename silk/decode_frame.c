@@ -110,7 +110,13 @@ opus_int silk_decode_frame(
         /********************************************************/
         /* Run SILK enhancer                                    */
         /********************************************************/
-        osce_enhance_frame( osce_model, psDec, psDecCtrl, pOut, ec_tell(psRangeDec) - ec_start, arch );
+        if( psDec->osce.dnn_clock != NULL ) {
+            double start = psDec->osce.dnn_clock();
+            osce_enhance_frame( osce_model, psDec, psDecCtrl, pOut, ec_tell(psRangeDec) - ec_start, arch );
+            psDec->osce.dnn_time += psDec->osce.dnn_clock() - start;
+        } else {
+            osce_enhance_frame( osce_model, psDec, psDecCtrl, pOut, ec_tell(psRangeDec) - ec_start, arch );
+        }
 #endif
 
         /********************************************************/
@@ -68,6 +68,57 @@ opus_int silk_Get_Encoder_Size(                         /* O    Returns error co
     return ret;
 }
 
+/*****************************************************/
+/* Get size in bytes of a Silk encoder state snapshot */
+/*****************************************************/
+opus_int silk_Get_Encoder_Snapshot_Size(                /* O    Returns error code                              */
+    opus_int                        nChannelsAPI,       /* I    Number of API channels (1 or 2)                 */
+    opus_int                        *snapshotSizeBytes  /* O    Number of bytes in a snapshot                   */
+)
+{
+    silk_encoder *psEnc = NULL;
+
+    if( nChannelsAPI < 1 || nChannelsAPI > ENCODER_NUM_CHANNELS ) {
+        return SILK_ENC_INVALID_NUMBER_OF_CHANNELS_ERROR;
+    }
+    /* A mono encoder never uses the second channel state */
+    *snapshotSizeBytes = sizeof( silk_encoder ) - ( ENCODER_NUM_CHANNELS - nChannelsAPI ) * sizeof( psEnc->state_Fxx[ 0 ] );
+
+    return SILK_NO_ERROR;
+}
+
+/***************************************************/
+/* Save/restore the encoder state, returns bytes   */
+/* copied. The second channel is left out for mono */
+/***************************************************/
+opus_int silk_SaveEncoder(
+    const void                      *encState,          /* I    State                                           */
+    opus_int                        nChannelsAPI,       /* I    Number of API channels (1 or 2)                 */
+    unsigned char                   *snapshot           /* O    Snapshot                                        */
+)
+{
+    const silk_encoder *psEnc = (const silk_encoder *)encState;
+    opus_int nBytes = nChannelsAPI * sizeof( psEnc->state_Fxx[ 0 ] );
+
+    silk_memcpy( snapshot, psEnc->state_Fxx, nBytes );
+    silk_memcpy( snapshot + nBytes, &psEnc->sStereo, sizeof( silk_encoder ) - ( (const char*)&psEnc->sStereo - (const char*)psEnc ) );
+    return nBytes + sizeof( silk_encoder ) - ( (const char*)&psEnc->sStereo - (const char*)psEnc );
+}
+
+opus_int silk_RestoreEncoder(
+    void                            *encState,          /* O    State                                           */
+    opus_int                        nChannelsAPI,       /* I    Number of API channels (1 or 2)                 */
+    const unsigned char             *snapshot           /* I    Snapshot                                        */
+)
+{
+    silk_encoder *psEnc = (silk_encoder *)encState;
+    opus_int nBytes = nChannelsAPI * sizeof( psEnc->state_Fxx[ 0 ] );
+
+    silk_memcpy( psEnc->state_Fxx, snapshot, nBytes );
+    silk_memcpy( &psEnc->sStereo, snapshot + nBytes, sizeof( silk_encoder ) - ( (char*)&psEnc->sStereo - (char*)psEnc ) );
+    return nBytes + sizeof( silk_encoder ) - ( (char*)&psEnc->sStereo - (char*)psEnc );
+}
+
 /*************************/
 /* Init or Reset encoder */
 /*************************/
@@ -149,7 +200,8 @@ opus_int silk_Encode(                                   /* O    Returns error co
     ec_enc                          *psRangeEnc,        /* I/O  Compressor data structure                       */
     opus_int32                      *nBytesOut,         /* I/O  Number of bytes in payload (input: Max bytes)   */
     const opus_int                  prefillFlag,        /* I    Flag to indicate prefilling buffers no coding   */
-    opus_int                        activity            /* I    Decision of Opus voice activity detector        */
+    opus_int                        activity,           /* I    Decision of Opus voice activity detector        */
+    opus_int16                      *internalOut        /* O    Resampled (mono) input at internal rate, or NULL */
 )
 {
     opus_int   n, i, nBits, flags, tmp_payloadSize_ms = 0, tmp_complexity = 0, ret = 0;
@@ -159,7 +211,7 @@ opus_int silk_Encode(                                   /* O    Returns error co
     opus_int32 TargetRate_bps, MStargetRates_bps[ 2 ], channelRate_bps, LBRR_symbol, sum;
     silk_encoder *psEnc = ( silk_encoder * )encState;
     VARDECL( opus_int16, buf );
-    opus_int transition, curr_block, tot_blocks;
+    opus_int transition, curr_block, tot_blocks, bufIx;
     SAVE_STACK;
 
     if (encControl->reducedDependency)
@@ -278,6 +330,7 @@ opus_int silk_Encode(                                   /* O    Returns error co
         nSamplesToBuffer  = psEnc->state_Fxx[ 0 ].sCmn.frame_length - psEnc->state_Fxx[ 0 ].sCmn.inputBufIx;
         nSamplesToBuffer  = silk_min( nSamplesToBuffer, nSamplesToBufferMax );
         nSamplesFromInput = silk_DIV32_16( nSamplesToBuffer * psEnc->state_Fxx[ 0 ].sCmn.API_fs_Hz, psEnc->state_Fxx[ 0 ].sCmn.fs_kHz * 1000 );
+        bufIx = psEnc->state_Fxx[ 0 ].sCmn.inputBufIx;
         /* Resample and write to buffer */
         if( encControl->nChannelsAPI == 2 && encControl->nChannelsInternal == 2 ) {
             opus_int id = psEnc->state_Fxx[ 0 ].sCmn.nFramesEncoded;
@@ -329,6 +382,21 @@ opus_int silk_Encode(                                   /* O    Returns error co
             psEnc->state_Fxx[ 0 ].sCmn.inputBufIx += nSamplesToBuffer;
         }
 
+        /* Return the resampled signal (mid for stereo) to the caller, e.g. for DRED */
+        if( internalOut != NULL && !prefillFlag ) {
+            const opus_int16 *in0 = &psEnc->state_Fxx[ 0 ].sCmn.inputBuf[ bufIx + 2 ];
+            nSamplesToBuffer = psEnc->state_Fxx[ 0 ].sCmn.inputBufIx - bufIx;
+            if( encControl->nChannelsInternal == 2 ) {
+                const opus_int16 *in1 = &psEnc->state_Fxx[ 1 ].sCmn.inputBuf[ bufIx + 2 ];
+                for( n = 0; n < nSamplesToBuffer; n++ ) {
+                    internalOut[ n ] = (opus_int16)silk_RSHIFT_ROUND( (opus_int32)in0[ n ] + in1[ n ], 1 );
+                }
+            } else {
+                silk_memcpy( internalOut, in0, nSamplesToBuffer * sizeof( opus_int16 ) );
+            }
+            internalOut += nSamplesToBuffer;
+        }
+
         samplesIn  += nSamplesFromInput * encControl->nChannelsAPI;
         nSamplesIn -= nSamplesFromInput;
 
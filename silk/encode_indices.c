@@ -40,7 +40,7 @@ void silk_encode_indices(
     opus_int                    condCoding                      /* I    The type of conditional coding to use       */
 )
 {
-    opus_int   i, k, typeOffset;
+    opus_int   i, typeOffset;
     opus_int   encode_absolute_lagIndex, delta_lagIndex;
     opus_int16 ec_ix[ MAX_LPC_ORDER ];
     opus_uint8 pred_Q8[ MAX_LPC_ORDER ];
@@ -80,10 +80,8 @@ void silk_encode_indices(
     }
 
     /* remaining subframes */
-    for( i = 1; i < psEncC->nb_subfr; i++ ) {
-        silk_assert( psIndices->GainsIndices[ i ] >= 0 && psIndices->GainsIndices[ i ] < MAX_DELTA_GAIN_QUANT - MIN_DELTA_GAIN_QUANT + 1 );
-        ec_enc_icdf( psRangeEnc, psIndices->GainsIndices[ i ], silk_delta_gain_iCDF, 8 );
-    }
+    ec_enc_icdf_array( psRangeEnc, &psIndices->GainsIndices[ 1 ], psEncC->nb_subfr - 1, silk_delta_gain_iCDF,
+        MAX_DELTA_GAIN_QUANT - MIN_DELTA_GAIN_QUANT + 1, 8 );
 
     /****************/
     /* Encode NLSFs */
@@ -156,10 +154,8 @@ void silk_encode_indices(
         ec_enc_icdf( psRangeEnc, psIndices->PERIndex, silk_LTP_per_index_iCDF, 8 );
 
         /* Codebook Indices */
-        for( k = 0; k < psEncC->nb_subfr; k++ ) {
-            silk_assert( psIndices->LTPIndex[ k ] >= 0 && psIndices->LTPIndex[ k ] < ( 8 << psIndices->PERIndex ) );
-            ec_enc_icdf( psRangeEnc, psIndices->LTPIndex[ k ], silk_LTP_gain_iCDF_ptrs[ psIndices->PERIndex ], 8 );
-        }
+        ec_enc_icdf_array( psRangeEnc, psIndices->LTPIndex, psEncC->nb_subfr, silk_LTP_gain_iCDF_ptrs[ psIndices->PERIndex ],
+            8 << psIndices->PERIndex, 8 );
 
         /**********************/
         /* Encode LTP scaling */
@@ -184,17 +184,22 @@ void silk_encode_pulses(
     /****************/
     for( i = 0; i < iter; i++ ) {
         if( nRshifts[ i ] > 0 ) {
+            /* abs_q fits in 7 bits, so there are at most 7 LSBs per pulse */
+            opus_int8 lsb_bits[ SHELL_CODEC_FRAME_LENGTH * 7 ];
+            opus_int  nbits = 0;
             pulses_ptr = &pulses[ i * SHELL_CODEC_FRAME_LENGTH ];
             nLS = nRshifts[ i ] - 1;
+            silk_assert( nLS < 7 );
             for( k = 0; k < SHELL_CODEC_FRAME_LENGTH; k++ ) {
                 abs_q = (opus_int8)silk_abs( pulses_ptr[ k ] );
                 for( j = nLS; j > 0; j-- ) {
                     bit = silk_RSHIFT( abs_q, j ) & 1;
-                    ec_enc_icdf( psRangeEnc, bit, silk_lsb_iCDF, 8 );
+                    lsb_bits[ nbits++ ] = (opus_int8)bit;
                 }
                 bit = abs_q & 1;
-                ec_enc_icdf( psRangeEnc, bit, silk_lsb_iCDF, 8 );
+                lsb_bits[ nbits++ ] = (opus_int8)bit;
             }
+            ec_enc_icdf_array( psRangeEnc, lsb_bits, nbits, silk_lsb_iCDF, 2, 8 );
         }
     }
 
@@ -34,6 +34,37 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "stack_alloc.h"
 #include "tuning_parameters.h"
 
+/* Apply a gain multiplier to the unquantized gains and quantize them                                  */
+static OPUS_INLINE opus_int32 silk_gains_apply_mult_FIX(                    /* O    returns gains ID                                                            */
+    silk_encoder_state_FIX          *psEnc,                                 /* I/O  Pointer to Silk FIX encoder state                                           */
+    silk_encoder_control_FIX        *psEncCtrl,                             /* I/O  Pointer to Silk FIX encoder control struct                                  */
+    opus_int16                      gainMult_Q8,                            /* I    Gain multiplier (Q8)                                                        */
+    const opus_int                  gain_lock[],                            /* I    Subframes with locked gain multiplier                                       */
+    const opus_int16                best_gain_mult[],                       /* I    Locked gain multipliers (Q8)                                                */
+    opus_int                        condCoding                              /* I    The type of conditional coding used so far for this frame                   */
+)
+{
+    opus_int i;
+
+    for( i = 0; i < psEnc->sCmn.nb_subfr; i++ ) {
+        opus_int16 tmp;
+        if ( gain_lock[i] ) {
+            tmp = best_gain_mult[i];
+        } else {
+            tmp = gainMult_Q8;
+        }
+        psEncCtrl->Gains_Q16[ i ] = silk_LSHIFT_SAT32( silk_SMULWB( psEncCtrl->GainsUnq_Q16[ i ], tmp ), 8 );
+    }
+
+    /* Quantize gains */
+    psEnc->sShape.LastGainIndex = psEncCtrl->lastGainIndexPrev;
+    silk_gains_quant( psEnc->sCmn.indices.GainsIndices, psEncCtrl->Gains_Q16,
+          &psEnc->sShape.LastGainIndex, condCoding == CODE_CONDITIONALLY, psEnc->sCmn.nb_subfr );
+
+    /* Unique identifier of gains vector */
+    return silk_gains_ID( psEnc->sCmn.indices.GainsIndices, psEnc->sCmn.nb_subfr );
+}
+
 /* Low Bitrate Redundancy (LBRR) encoding. Reuse all parameters but encode with lower bitrate           */
 static OPUS_INLINE void silk_LBRR_encode_FIX(
     silk_encoder_state_FIX          *psEnc,                                 /* I/O  Pointer to Silk FIX encoder state                                           */
@@ -98,6 +129,8 @@ opus_int silk_encode_frame_FIX(
     silk_nsq_state sNSQ_copy, sNSQ_copy2;
     opus_int32   seed_copy, nBits, nBits_lower, nBits_upper, gainMult_lower, gainMult_upper;
     opus_int32   gainsID, gainsID_lower, gainsID_upper;
+    opus_int32   nBits_first, gainMult_first;
+    opus_int     zero_fallback;
     opus_int16   gainMult_Q8;
     opus_int16   ec_prevLagIndex_copy;
     opus_int     ec_prevSignalType_copy;
@@ -112,6 +145,8 @@ opus_int silk_encode_frame_FIX(
     bits_margin = useCBR ? 5 : maxBits/4;
     /* This is totally unnecessary but many compilers (including gcc) are too dumb to realise it */
     LastGainIndex_copy2 = nBits_lower = nBits_upper = gainMult_lower = gainMult_upper = 0;
+    nBits_first = gainMult_first = 0;
+    zero_fallback = 0;
 
     psEnc->sCmn.indices.Seed = psEnc->sCmn.frameCounter++ & 3;
 
@@ -175,6 +210,13 @@ opus_int silk_encode_frame_FIX(
         gainsID = silk_gains_ID( psEnc->sCmn.indices.GainsIndices, psEnc->sCmn.nb_subfr );
         gainsID_lower = -1;
         gainsID_upper = -1;
+        if( useCBR ) {
+            /* Start from the gain multiplier the previous frames converged to */
+            gainMult_Q8 = silk_gains_mult_predict( &psEnc->sCmn );
+            if( gainMult_Q8 != SILK_FIX_CONST( 1, 8 ) ) {
+                gainsID = silk_gains_apply_mult_FIX( psEnc, &sEncCtrl, gainMult_Q8, gain_lock, best_gain_mult, condCoding );
+            }
+        }
         /* Copy part of the input state */
         silk_memcpy( &sRangeEnc_copy, psRangeEnc, sizeof( ec_enc ) );
         silk_memcpy( &sNSQ_copy, &psEnc->sCmn.sNSQ, sizeof( silk_nsq_state ) );
@@ -228,6 +270,10 @@ opus_int silk_encode_frame_FIX(
                     psEnc->sCmn.pulses, psEnc->sCmn.frame_length );
 
                 nBits = ec_tell( psRangeEnc );
+                if( iter == 0 ) {
+                    nBits_first = nBits;
+                    gainMult_first = gainMult_Q8;
+                }
 
                 /* If we still bust after the last iteration, do some damage control. */
                 if ( iter == maxIter && !found_lower && nBits > maxBits ) {
@@ -243,6 +289,8 @@ opus_int silk_encode_frame_FIX(
                     }
                     psEnc->sCmn.ec_prevLagIndex = ec_prevLagIndex_copy;
                     psEnc->sCmn.ec_prevSignalType = ec_prevSignalType_copy;
+                    /* Don't let the gain model learn from this frame */
+                    zero_fallback = 1;
                     /* Clear all pulses. */
                     for ( i = 0; i < psEnc->sCmn.frame_length; i++ ) {
                         psEnc->sCmn.pulses[ i ] = 0;
@@ -269,6 +317,8 @@ opus_int silk_encode_frame_FIX(
                     silk_memcpy( psRangeEnc->buf, ec_buf_copy, sRangeEnc_copy2.offs );
                     silk_memcpy( &psEnc->sCmn.sNSQ, &sNSQ_copy2, sizeof( silk_nsq_state ) );
                     psEnc->sShape.LastGainIndex = LastGainIndex_copy2;
+                    gainMult_Q8 = gainMult_lower;
+                    nBits = nBits_lower;
                 }
                 break;
             }
@@ -319,8 +369,11 @@ opus_int silk_encode_frame_FIX(
                 }
             }
             if( ( found_lower & found_upper ) == 0 ) {
-                /* Adjust gain according to high-rate rate/distortion curve */
-                if( nBits > maxBits ) {
+                if( useCBR && psEnc->sCmn.bitsPerGainOct > 0 ) {
+                    /* Adjust gain according to the bits-vs-gain slope measured on previous frames */
+                    gainMult_Q8 = silk_gains_mult_step( &psEnc->sCmn, gainMult_Q8, nBits, maxBits - silk_RSHIFT( bits_margin, 1 ) );
+                } else if( nBits > maxBits ) {
+                    /* Adjust gain according to high-rate rate/distortion curve */
                     gainMult_Q8 = silk_min_32( 1024, gainMult_Q8*3/2 );
                 } else {
                     gainMult_Q8 = silk_max_32( 64, gainMult_Q8*4/5 );
@@ -337,23 +390,11 @@ opus_int silk_encode_frame_FIX(
                 }
             }
 
-            for( i = 0; i < psEnc->sCmn.nb_subfr; i++ ) {
-                opus_int16 tmp;
-                if ( gain_lock[i] ) {
-                    tmp = best_gain_mult[i];
-                } else {
-                    tmp = gainMult_Q8;
-                }
-                sEncCtrl.Gains_Q16[ i ] = silk_LSHIFT_SAT32( silk_SMULWB( sEncCtrl.GainsUnq_Q16[ i ], tmp ), 8 );
-            }
-
-            /* Quantize gains */
-            psEnc->sShape.LastGainIndex = sEncCtrl.lastGainIndexPrev;
-            silk_gains_quant( psEnc->sCmn.indices.GainsIndices, sEncCtrl.Gains_Q16,
-                  &psEnc->sShape.LastGainIndex, condCoding == CODE_CONDITIONALLY, psEnc->sCmn.nb_subfr );
+            gainsID = silk_gains_apply_mult_FIX( psEnc, &sEncCtrl, gainMult_Q8, gain_lock, best_gain_mult, condCoding );
+        }
 
-            /* Unique identifier of gains vector */
-            gainsID = silk_gains_ID( psEnc->sCmn.indices.GainsIndices, psEnc->sCmn.nb_subfr );
+        if( useCBR && !zero_fallback ) {
+            silk_gains_mult_update( &psEnc->sCmn, gainMult_first, nBits_first, gainMult_Q8, nBits );
         }
     }
 
@@ -392,6 +433,7 @@ static OPUS_INLINE void silk_LBRR_encode_FIX(
     opus_int                        condCoding                              /* I    The type of conditional coding used so far for this frame                   */
 )
 {
+    opus_int     nStatesDelayedDecision;
     opus_int32   TempGains_Q16[ MAX_NB_SUBFR ];
     SideInfoIndices *psIndices_LBRR = &psEnc->sCmn.indices_LBRR[ psEnc->sCmn.nFramesEncoded ];
     silk_nsq_state sNSQ_LBRR;
@@ -423,6 +465,10 @@ static OPUS_INLINE void silk_LBRR_encode_FIX(
         silk_gains_dequant( psEncCtrl->Gains_Q16, psIndices_LBRR->GainsIndices,
             &psEnc->sCmn.LBRRprevLastGainIndex, condCoding == CODE_CONDITIONALLY, psEnc->sCmn.nb_subfr );
 
+        /* Quantize the redundant copy with fewer delayed-decision states */
+        nStatesDelayedDecision = psEnc->sCmn.nStatesDelayedDecision;
+        psEnc->sCmn.nStatesDelayedDecision = silk_min_int( nStatesDelayedDecision, LBRR_MAX_DEL_DEC_STATES );
+
         /*****************************************/
         /* Noise shaping quantization            */
         /*****************************************/
@@ -438,6 +484,8 @@ static OPUS_INLINE void silk_LBRR_encode_FIX(
                 psEncCtrl->Gains_Q16, psEncCtrl->pitchL, psEncCtrl->Lambda_Q10, psEncCtrl->LTP_scale_Q14, psEnc->sCmn.arch );
         }
 
+        psEnc->sCmn.nStatesDelayedDecision = nStatesDelayedDecision;
+
         /* Restore original gains */
         silk_memcpy( psEncCtrl->Gains_Q16, TempGains_Q16, psEnc->sCmn.nb_subfr * sizeof( opus_int32 ) );
     }
@@ -102,6 +102,8 @@ opus_int silk_pitch_analysis_core(                  /* O    Voicing estimate: 0
     opus_int   i, k, d, j;
     VARDECL( opus_int16, C );
     VARDECL( opus_int32, xcorr32 );
+    VARDECL( opus_int32, xcorr_st2 );
+    VARDECL( opus_int32, energy_st2 );
     const opus_int16 *target_ptr, *basis_ptr;
     opus_int32 cross_corr, normalizer, energy, energy_basis, energy_target;
     opus_int   d_srch[ PE_D_SRCH_LENGTH ], Cmax, length_d_srch, length_d_comp, shift;
@@ -320,6 +322,8 @@ opus_int silk_pitch_analysis_core(                  /* O    Voicing estimate: 0
     * Find energy of each subframe projected onto its history, for a range of delays
     *********************************************************************************/
     silk_memset( C, 0, nb_subfr * CSTRIDE_8KHZ * sizeof( opus_int16 ) );
+    ALLOC( xcorr_st2, D_COMP_STRIDE, opus_int32 );
+    ALLOC( energy_st2, D_COMP_STRIDE, opus_int32 );
 
     target_ptr = &frame_8kHz[ PE_LTP_MEM_LENGTH_MS * 8 ];
     for( k = 0; k < nb_subfr; k++ ) {
@@ -329,6 +333,7 @@ opus_int silk_pitch_analysis_core(                  /* O    Voicing estimate: 0
         celt_assert( target_ptr + SF_LENGTH_8KHZ <= frame_8kHz + frame_length_8kHz );
 
         energy_target = silk_ADD32( silk_inner_prod_aligned( target_ptr, target_ptr, SF_LENGTH_8KHZ, arch ), 1 );
+        silk_P_Ana_calc_corr_nrg_st2( xcorr_st2, energy_st2, target_ptr, d_comp, length_d_comp, SF_LENGTH_8KHZ, arch );
         for( j = 0; j < length_d_comp; j++ ) {
             d = d_comp[ j ];
             basis_ptr = target_ptr - d;
@@ -337,9 +342,9 @@ opus_int silk_pitch_analysis_core(                  /* O    Voicing estimate: 0
             silk_assert( basis_ptr >= frame_8kHz );
             silk_assert( basis_ptr + SF_LENGTH_8KHZ <= frame_8kHz + frame_length_8kHz );
 
-            cross_corr = silk_inner_prod_aligned( target_ptr, basis_ptr, SF_LENGTH_8KHZ, arch );
+            cross_corr = xcorr_st2[ j ];
             if( cross_corr > 0 ) {
-                energy_basis = silk_inner_prod_aligned( basis_ptr, basis_ptr, SF_LENGTH_8KHZ, arch );
+                energy_basis = energy_st2[ j ];
                 matrix_ptr( C, k, d - ( MIN_LAG_8KHZ - 2 ), CSTRIDE_8KHZ ) =
                     (opus_int16)silk_DIV32_varQ( cross_corr,
                                                  silk_ADD32( energy_target,
@@ -719,3 +724,31 @@ static void silk_P_Ana_calc_energy_st3(
     }
     RESTORE_STACK;
 }
+
+/*************************************************************/
+/* Calculates the stage 2 cross-correlations between a       */
+/* subframe and each candidate lag of its history, and the   */
+/* energies of the lagged vectors. The energy is only needed */
+/* (and only computed here) where the correlation is > 0.    */
+/*************************************************************/
+void silk_P_Ana_calc_corr_nrg_st2_c(
+    opus_int32                  xcorr[],            /* O    Cross-correlations, one per lag                             */
+    opus_int32                  energy[],           /* O    Energies of the lagged vectors, one per lag                 */
+    const opus_int16            target[],           /* I    Target vector, preceded by at least max(lags) samples       */
+    const opus_int16            lags[],             /* I    Lags to evaluate                                            */
+    const opus_int              nb_lags,            /* I    Number of lags                                              */
+    const opus_int              len,                /* I    Vector length                                               */
+    int                         arch                /* I    Run-time architecture                                       */
+)
+{
+    opus_int j;
+    const opus_int16 *basis_ptr;
+
+    for( j = 0; j < nb_lags; j++ ) {
+        basis_ptr = target - lags[ j ];
+        xcorr[ j ] = silk_inner_prod_aligned( target, basis_ptr, len, arch );
+        if( xcorr[ j ] > 0 ) {
+            energy[ j ] = silk_inner_prod_aligned( basis_ptr, basis_ptr, len, arch );
+        }
+    }
+}
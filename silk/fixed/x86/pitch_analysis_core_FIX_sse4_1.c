@@ -0,0 +1,130 @@
+/***********************************************************************
+Copyright (c) 2025 Xiph.Org Foundation
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+- Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+- Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+- Neither the name of Internet Society, IETF or IETF Trust, nor the
+names of specific contributors, may be used to endorse or promote
+products derived from this software without specific prior written
+permission.
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+***********************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <xmmintrin.h>
+#include <emmintrin.h>
+#include <smmintrin.h>
+
+#include "SigProc_FIX.h"
+#include "stack_alloc.h"
+#include "celt/x86/x86cpu.h"
+
+static OPUS_INLINE opus_int32 silk_mm_hsum_epi32( __m128i x )
+{
+    x = _mm_add_epi32( x, _mm_shuffle_epi32( x, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+    x = _mm_add_epi32( x, _mm_shuffle_epi32( x, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+    return _mm_cvtsi128_si32( x );
+}
+
+/* Same results as silk_P_Ana_calc_corr_nrg_st2_c(): the 32-bit sums wrap the */
+/* same way in any order, and the energy is computed for every lag            */
+void silk_P_Ana_calc_corr_nrg_st2_sse4_1(
+    opus_int32                  xcorr[],            /* O    Cross-correlations, one per lag                             */
+    opus_int32                  energy[],           /* O    Energies of the lagged vectors, one per lag                 */
+    const opus_int16            target[],           /* I    Target vector, preceded by at least max(lags) samples       */
+    const opus_int16            lags[],             /* I    Lags to evaluate                                            */
+    const opus_int              nb_lags,            /* I    Number of lags                                              */
+    const opus_int              len,                /* I    Vector length                                               */
+    int                         arch                /* I    Run-time architecture                                       */
+)
+{
+    opus_int   i, j, len8;
+    opus_int32 xc0, xc1, nrg0, nrg1;
+    const opus_int16 *basis0, *basis1;
+    __m128i t, b0, b1, acc_xc0, acc_xc1, acc_nrg0, acc_nrg1;
+
+    (void)arch;
+    len8 = len & ~7;
+
+    /* Two lags at a time, sharing the target loads */
+    for( j = 0; j < nb_lags - 1; j += 2 ) {
+        basis0 = target - lags[ j ];
+        basis1 = target - lags[ j + 1 ];
+        acc_xc0 = acc_xc1 = acc_nrg0 = acc_nrg1 = _mm_setzero_si128();
+        for( i = 0; i < len8; i += 8 ) {
+            t  = _mm_loadu_si128( (const __m128i *)(const void *)&target[ i ] );
+            b0 = _mm_loadu_si128( (const __m128i *)(const void *)&basis0[ i ] );
+            b1 = _mm_loadu_si128( (const __m128i *)(const void *)&basis1[ i ] );
+            acc_xc0  = _mm_add_epi32( acc_xc0,  _mm_madd_epi16( t,  b0 ) );
+            acc_nrg0 = _mm_add_epi32( acc_nrg0, _mm_madd_epi16( b0, b0 ) );
+            acc_xc1  = _mm_add_epi32( acc_xc1,  _mm_madd_epi16( t,  b1 ) );
+            acc_nrg1 = _mm_add_epi32( acc_nrg1, _mm_madd_epi16( b1, b1 ) );
+        }
+        xc0  = silk_mm_hsum_epi32( acc_xc0 );
+        nrg0 = silk_mm_hsum_epi32( acc_nrg0 );
+        xc1  = silk_mm_hsum_epi32( acc_xc1 );
+        nrg1 = silk_mm_hsum_epi32( acc_nrg1 );
+        for( ; i < len; i++ ) {
+            xc0  = silk_MLA_ovflw( xc0,  target[ i ], basis0[ i ] );
+            nrg0 = silk_MLA_ovflw( nrg0, basis0[ i ], basis0[ i ] );
+            xc1  = silk_MLA_ovflw( xc1,  target[ i ], basis1[ i ] );
+            nrg1 = silk_MLA_ovflw( nrg1, basis1[ i ], basis1[ i ] );
+        }
+        xcorr[ j ]      = xc0;
+        energy[ j ]     = nrg0;
+        xcorr[ j + 1 ]  = xc1;
+        energy[ j + 1 ] = nrg1;
+    }
+    if( j < nb_lags ) {
+        basis0 = target - lags[ j ];
+        acc_xc0 = acc_nrg0 = _mm_setzero_si128();
+        for( i = 0; i < len8; i += 8 ) {
+            t  = _mm_loadu_si128( (const __m128i *)(const void *)&target[ i ] );
+            b0 = _mm_loadu_si128( (const __m128i *)(const void *)&basis0[ i ] );
+            acc_xc0  = _mm_add_epi32( acc_xc0,  _mm_madd_epi16( t,  b0 ) );
+            acc_nrg0 = _mm_add_epi32( acc_nrg0, _mm_madd_epi16( b0, b0 ) );
+        }
+        xc0  = silk_mm_hsum_epi32( acc_xc0 );
+        nrg0 = silk_mm_hsum_epi32( acc_nrg0 );
+        for( ; i < len; i++ ) {
+            xc0  = silk_MLA_ovflw( xc0,  target[ i ], basis0[ i ] );
+            nrg0 = silk_MLA_ovflw( nrg0, basis0[ i ], basis0[ i ] );
+        }
+        xcorr[ j ]  = xc0;
+        energy[ j ] = nrg0;
+    }
+
+#ifdef OPUS_CHECK_ASM
+    {
+        VARDECL( opus_int32, xcorr_c );
+        VARDECL( opus_int32, energy_c );
+        SAVE_STACK;
+        ALLOC( xcorr_c, nb_lags, opus_int32 );
+        ALLOC( energy_c, nb_lags, opus_int32 );
+        silk_P_Ana_calc_corr_nrg_st2_c( xcorr_c, energy_c, target, lags, nb_lags, len, 0 );
+        for( j = 0; j < nb_lags; j++ ) {
+            silk_assert( xcorr_c[ j ] == xcorr[ j ] );
+            silk_assert( xcorr_c[ j ] <= 0 || energy_c[ j ] == energy[ j ] );
+        }
+        RESTORE_STACK;
+    }
+#endif
+}
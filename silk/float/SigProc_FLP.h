@@ -93,6 +93,22 @@ opus_int silk_pitch_analysis_core_FLP(      /* O    Voicing estimate: 0 voiced,
     int                 arch                /* I    Run-time architecture                                       */
 );
 
+/* Stage 2 pitch search kernel: correlations with, and energies of, target[ -lags[ j ] ] */
+void silk_P_Ana_calc_corr_nrg_st2_FLP_c(
+    double              xcorr[],            /* O    Cross-correlations, one per lag                             */
+    double              energy[],           /* O    Energies of the lagged vectors, one per lag                 */
+    const silk_float    target[],           /* I    Target vector, preceded by at least max(lags) samples       */
+    const opus_int16    lags[],             /* I    Lags to evaluate                                            */
+    const opus_int      nb_lags,            /* I    Number of lags                                              */
+    const opus_int      len,                /* I    Vector length                                               */
+    int                 arch                /* I    Run-time architecture                                       */
+);
+
+#ifndef OVERRIDE_silk_P_Ana_calc_corr_nrg_st2_FLP
+#define silk_P_Ana_calc_corr_nrg_st2_FLP(xcorr, energy, target, lags, nb_lags, len, arch) \
+    silk_P_Ana_calc_corr_nrg_st2_FLP_c(xcorr, energy, target, lags, nb_lags, len, arch)
+#endif
+
 void silk_insertion_sort_decreasing_FLP(
     silk_float          *a,                 /* I/O  Unsorted / Sorted vector                                    */
     opus_int            *idx,               /* O    Index vector for the sorted elements                        */
@@ -101,7 +117,7 @@ void silk_insertion_sort_decreasing_FLP(
 );
 
 /* Compute reflection coefficients from input signal */
-silk_float silk_burg_modified_FLP(          /* O    returns residual energy                                     */
+silk_float silk_burg_modified_FLP_c(        /* O    returns residual energy                                     */
     silk_float          A[],                /* O    prediction coefficients (length order)                      */
     const silk_float    x[],                /* I    input signal, length: nb_subfr*(D+L_sub)                    */
     const silk_float    minInvGain,         /* I    minimum inverse prediction gain                             */
@@ -111,6 +127,11 @@ silk_float silk_burg_modified_FLP(          /* O    returns residual energy
     int                 arch
 );
 
+#if !defined(OVERRIDE_silk_burg_modified_FLP)
+#define silk_burg_modified_FLP(A, x, minInvGain, subfr_length, nb_subfr, D, arch) \
+    ((void)(arch), silk_burg_modified_FLP_c(A, x, minInvGain, subfr_length, nb_subfr, D, arch))
+#endif
+
 /* multiply a vector by a constant */
 void silk_scale_vector_FLP(
     silk_float          *data1,
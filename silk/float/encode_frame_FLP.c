@@ -33,6 +33,43 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "main_FLP.h"
 #include "tuning_parameters.h"
 
+/* Apply a gain multiplier to the unquantized gains and quantize them */
+static OPUS_INLINE opus_int32 silk_gains_apply_mult_FLP(                /* O    returns gains ID                            */
+    silk_encoder_state_FLP          *psEnc,                             /* I/O  Encoder state FLP                           */
+    silk_encoder_control_FLP        *psEncCtrl,                         /* I/O  Encoder control FLP                         */
+    opus_int16                      gainMult_Q8,                        /* I    Gain multiplier (Q8)                        */
+    const opus_int                  gain_lock[],                        /* I    Subframes with locked gain multiplier       */
+    const opus_int16                best_gain_mult[],                   /* I    Locked gain multipliers (Q8)                */
+    opus_int                        condCoding                          /* I    The type of conditional coding used so far  */
+)
+{
+    opus_int   i;
+    opus_int32 pGains_Q16[ MAX_NB_SUBFR ];
+
+    for( i = 0; i < psEnc->sCmn.nb_subfr; i++ ) {
+        opus_int16 tmp;
+        if ( gain_lock[i] ) {
+            tmp = best_gain_mult[i];
+        } else {
+            tmp = gainMult_Q8;
+        }
+        pGains_Q16[ i ] = silk_LSHIFT_SAT32( silk_SMULWB( psEncCtrl->GainsUnq_Q16[ i ], tmp ), 8 );
+    }
+
+    /* Quantize gains */
+    psEnc->sShape.LastGainIndex = psEncCtrl->lastGainIndexPrev;
+    silk_gains_quant( psEnc->sCmn.indices.GainsIndices, pGains_Q16,
+          &psEnc->sShape.LastGainIndex, condCoding == CODE_CONDITIONALLY, psEnc->sCmn.nb_subfr );
+
+    /* Overwrite unquantized gains with quantized gains and convert back to Q0 from Q16 */
+    for( i = 0; i < psEnc->sCmn.nb_subfr; i++ ) {
+        psEncCtrl->Gains[ i ] = pGains_Q16[ i ] / 65536.0f;
+    }
+
+    /* Unique identifier of gains vector */
+    return silk_gains_ID( psEnc->sCmn.indices.GainsIndices, psEnc->sCmn.nb_subfr );
+}
+
 /* Low Bitrate Redundancy (LBRR) encoding. Reuse all parameters but encode with lower bitrate */
 static OPUS_INLINE void silk_LBRR_encode_FLP(
     silk_encoder_state_FLP          *psEnc,                             /* I/O  Encoder state FLP                           */
@@ -98,11 +135,12 @@ opus_int silk_encode_frame_FLP(
     silk_nsq_state sNSQ_copy, sNSQ_copy2;
     opus_int32   seed_copy, nBits, nBits_lower, nBits_upper, gainMult_lower, gainMult_upper;
     opus_int32   gainsID, gainsID_lower, gainsID_upper;
+    opus_int32   nBits_first, gainMult_first;
+    opus_int     zero_fallback;
     opus_int16   gainMult_Q8;
     opus_int16   ec_prevLagIndex_copy;
     opus_int     ec_prevSignalType_copy;
     opus_int8    LastGainIndex_copy2;
-    opus_int32   pGains_Q16[ MAX_NB_SUBFR ];
     opus_uint8   ec_buf_copy[ 1275 ];
     opus_int     gain_lock[ MAX_NB_SUBFR ] = {0};
     opus_int16   best_gain_mult[ MAX_NB_SUBFR ];
@@ -113,6 +151,8 @@ opus_int silk_encode_frame_FLP(
     bits_margin = useCBR ? 5 : maxBits/4;
     /* This is totally unnecessary but many compilers (including gcc) are too dumb to realise it */
     LastGainIndex_copy2 = nBits_lower = nBits_upper = gainMult_lower = gainMult_upper = 0;
+    nBits_first = gainMult_first = 0;
+    zero_fallback = 0;
 
     psEnc->sCmn.indices.Seed = psEnc->sCmn.frameCounter++ & 3;
 
@@ -172,6 +212,13 @@ opus_int silk_encode_frame_FLP(
         gainsID = silk_gains_ID( psEnc->sCmn.indices.GainsIndices, psEnc->sCmn.nb_subfr );
         gainsID_lower = -1;
         gainsID_upper = -1;
+        if( useCBR ) {
+            /* Start from the gain multiplier the previous frames converged to */
+            gainMult_Q8 = silk_gains_mult_predict( &psEnc->sCmn );
+            if( gainMult_Q8 != SILK_FIX_CONST( 1, 8 ) ) {
+                gainsID = silk_gains_apply_mult_FLP( psEnc, &sEncCtrl, gainMult_Q8, gain_lock, best_gain_mult, condCoding );
+            }
+        }
         /* Copy part of the input state */
         silk_memcpy( &sRangeEnc_copy, psRangeEnc, sizeof( ec_enc ) );
         silk_memcpy( &sNSQ_copy, &psEnc->sCmn.sNSQ, sizeof( silk_nsq_state ) );
@@ -214,6 +261,10 @@ opus_int silk_encode_frame_FLP(
                       psEnc->sCmn.pulses, psEnc->sCmn.frame_length );
 
                 nBits = ec_tell( psRangeEnc );
+                if( iter == 0 ) {
+                    nBits_first = nBits;
+                    gainMult_first = gainMult_Q8;
+                }
 
                 /* If we still bust after the last iteration, do some damage control. */
                 if ( iter == maxIter && !found_lower && nBits > maxBits ) {
@@ -229,6 +280,8 @@ opus_int silk_encode_frame_FLP(
                     }
                     psEnc->sCmn.ec_prevLagIndex = ec_prevLagIndex_copy;
                     psEnc->sCmn.ec_prevSignalType = ec_prevSignalType_copy;
+                    /* Don't let the gain model learn from this frame */
+                    zero_fallback = 1;
                     /* Clear all pulses. */
                     for ( i = 0; i < psEnc->sCmn.frame_length; i++ ) {
                         psEnc->sCmn.pulses[ i ] = 0;
@@ -255,6 +308,8 @@ opus_int silk_encode_frame_FLP(
                     silk_memcpy( psRangeEnc->buf, ec_buf_copy, sRangeEnc_copy2.offs );
                     silk_memcpy( &psEnc->sCmn.sNSQ, &sNSQ_copy2, sizeof( silk_nsq_state ) );
                     psEnc->sShape.LastGainIndex = LastGainIndex_copy2;
+                    gainMult_Q8 = gainMult_lower;
+                    nBits = nBits_lower;
                 }
                 break;
             }
@@ -307,8 +362,11 @@ opus_int silk_encode_frame_FLP(
                 }
             }
             if( ( found_lower & found_upper ) == 0 ) {
-                /* Adjust gain according to high-rate rate/distortion curve */
-                if( nBits > maxBits ) {
+                if( useCBR && psEnc->sCmn.bitsPerGainOct > 0 ) {
+                    /* Adjust gain according to the bits-vs-gain slope measured on previous frames */
+                    gainMult_Q8 = silk_gains_mult_step( &psEnc->sCmn, gainMult_Q8, nBits, maxBits - silk_RSHIFT( bits_margin, 1 ) );
+                } else if( nBits > maxBits ) {
+                    /* Adjust gain according to high-rate rate/distortion curve */
                     gainMult_Q8 = silk_min_32( 1024, gainMult_Q8*3/2 );
                 } else {
                     gainMult_Q8 = silk_max_32( 64, gainMult_Q8*4/5 );
@@ -325,28 +383,11 @@ opus_int silk_encode_frame_FLP(
                 }
             }
 
-            for( i = 0; i < psEnc->sCmn.nb_subfr; i++ ) {
-                opus_int16 tmp;
-                if ( gain_lock[i] ) {
-                    tmp = best_gain_mult[i];
-                } else {
-                    tmp = gainMult_Q8;
-                }
-                pGains_Q16[ i ] = silk_LSHIFT_SAT32( silk_SMULWB( sEncCtrl.GainsUnq_Q16[ i ], tmp ), 8 );
-            }
-
-            /* Quantize gains */
-            psEnc->sShape.LastGainIndex = sEncCtrl.lastGainIndexPrev;
-            silk_gains_quant( psEnc->sCmn.indices.GainsIndices, pGains_Q16,
-                  &psEnc->sShape.LastGainIndex, condCoding == CODE_CONDITIONALLY, psEnc->sCmn.nb_subfr );
-
-            /* Unique identifier of gains vector */
-            gainsID = silk_gains_ID( psEnc->sCmn.indices.GainsIndices, psEnc->sCmn.nb_subfr );
+            gainsID = silk_gains_apply_mult_FLP( psEnc, &sEncCtrl, gainMult_Q8, gain_lock, best_gain_mult, condCoding );
+        }
 
-            /* Overwrite unquantized gains with quantized gains and convert back to Q0 from Q16 */
-            for( i = 0; i < psEnc->sCmn.nb_subfr; i++ ) {
-                sEncCtrl.Gains[ i ] = pGains_Q16[ i ] / 65536.0f;
-            }
+        if( useCBR && !zero_fallback ) {
+            silk_gains_mult_update( &psEnc->sCmn, gainMult_first, nBits_first, gainMult_Q8, nBits );
         }
     }
 
@@ -383,7 +424,7 @@ static OPUS_INLINE void silk_LBRR_encode_FLP(
     opus_int                        condCoding                          /* I    The type of conditional coding used so far for this frame */
 )
 {
-    opus_int     k;
+    opus_int     k, nStatesDelayedDecision;
     opus_int32   Gains_Q16[ MAX_NB_SUBFR ];
     silk_float   TempGains[ MAX_NB_SUBFR ];
     SideInfoIndices *psIndices_LBRR = &psEnc->sCmn.indices_LBRR[ psEnc->sCmn.nFramesEncoded ];
@@ -420,12 +461,18 @@ static OPUS_INLINE void silk_LBRR_encode_FLP(
             psEncCtrl->Gains[ k ] = Gains_Q16[ k ] * ( 1.0f / 65536.0f );
         }
 
+        /* Quantize the redundant copy with fewer delayed-decision states */
+        nStatesDelayedDecision = psEnc->sCmn.nStatesDelayedDecision;
+        psEnc->sCmn.nStatesDelayedDecision = silk_min_int( nStatesDelayedDecision, LBRR_MAX_DEL_DEC_STATES );
+
         /*****************************************/
         /* Noise shaping quantization            */
         /*****************************************/
         silk_NSQ_wrapper_FLP( psEnc, psEncCtrl, psIndices_LBRR, &sNSQ_LBRR,
             psEnc->sCmn.pulses_LBRR[ psEnc->sCmn.nFramesEncoded ], xfw );
 
+        psEnc->sCmn.nStatesDelayedDecision = nStatesDelayedDecision;
+
         /* Restore original gains */
         silk_memcpy( psEncCtrl->Gains, TempGains, psEnc->sCmn.nb_subfr * sizeof( silk_float ) );
     }
@@ -97,7 +97,7 @@ void silk_noise_shape_analysis_FLP(
 );
 
 /* Autocorrelations for a warped frequency axis */
-void silk_warped_autocorrelation_FLP(
+void silk_warped_autocorrelation_FLP_c(
     silk_float                      *corr,                              /* O    Result [order + 1]                          */
     const silk_float                *input,                             /* I    Input data to correlate                     */
     const silk_float                warping,                            /* I    Warping coefficient                         */
@@ -105,6 +105,11 @@ void silk_warped_autocorrelation_FLP(
     const opus_int                  order                               /* I    Correlation order (even)                    */
 );
 
+#if !defined(OVERRIDE_silk_warped_autocorrelation_FLP)
+#define silk_warped_autocorrelation_FLP(corr, input, warping, length, order, arch) \
+    ((void)(arch), silk_warped_autocorrelation_FLP_c(corr, input, warping, length, order))
+#endif
+
 /* Calculation of LTP state scaling */
 void silk_LTP_scale_ctrl_FLP(
     silk_encoder_state_FLP          *psEnc,                             /* I/O  Encoder state FLP                           */
@@ -153,7 +158,7 @@ void silk_find_LTP_FLP(
     int                             arch
 );
 
-void silk_LTP_analysis_filter_FLP(
+void silk_LTP_analysis_filter_FLP_c(
     silk_float                      *LTP_res,                           /* O    LTP res MAX_NB_SUBFR*(pre_lgth+subfr_lngth) */
     const silk_float                *x,                                 /* I    Input signal, with preceding samples        */
     const silk_float                B[ LTP_ORDER * MAX_NB_SUBFR ],      /* I    LTP coefficients for each subframe          */
@@ -164,6 +169,11 @@ void silk_LTP_analysis_filter_FLP(
     const opus_int                  pre_length                          /* I    Preceding samples for each subframe         */
 );
 
+#if !defined(OVERRIDE_silk_LTP_analysis_filter_FLP)
+#define silk_LTP_analysis_filter_FLP(LTP_res, x, B, pitchL, invGains, subfr_length, nb_subfr, pre_length, arch) \
+    ((void)(arch), silk_LTP_analysis_filter_FLP_c(LTP_res, x, B, pitchL, invGains, subfr_length, nb_subfr, pre_length))
+#endif
+
 /* Calculates residual energies of input subframes where all subframes have LPC_order   */
 /* of preceding samples                                                                 */
 void silk_residual_energy_FLP(
@@ -91,6 +91,7 @@ opus_int silk_pitch_analysis_core_FLP(      /* O    Voicing estimate: 0 voiced,
     silk_float CC[ PE_NB_CBKS_STAGE2_EXT ];
     const silk_float *target_ptr, *basis_ptr;
     double    cross_corr, normalizer, energy, energy_tmp;
+    double    xcorr_st2[ (PE_MAX_LAG >> 1) + 5 ], energy_st2[ (PE_MAX_LAG >> 1) + 5 ];
     opus_int   d_srch[ PE_D_SRCH_LENGTH ];
     opus_int16 d_comp[ (PE_MAX_LAG >> 1) + 5 ];
     opus_int   length_d_srch, length_d_comp;
@@ -288,12 +289,12 @@ opus_int silk_pitch_analysis_core_FLP(      /* O    Voicing estimate: 0 voiced,
     }
     for( k = 0; k < nb_subfr; k++ ) {
         energy_tmp = silk_energy_FLP( target_ptr, sf_length_8kHz ) + 1.0;
+        silk_P_Ana_calc_corr_nrg_st2_FLP( xcorr_st2, energy_st2, target_ptr, d_comp, length_d_comp, sf_length_8kHz, arch );
         for( j = 0; j < length_d_comp; j++ ) {
             d = d_comp[ j ];
-            basis_ptr = target_ptr - d;
-            cross_corr = silk_inner_product_FLP( basis_ptr, target_ptr, sf_length_8kHz, arch );
+            cross_corr = xcorr_st2[ j ];
             if( cross_corr > 0.0f ) {
-                energy = silk_energy_FLP( basis_ptr, sf_length_8kHz );
+                energy = energy_st2[ j ];
                 C[ k ][ d ] = (silk_float)( 2 * cross_corr / ( energy + energy_tmp ) );
             } else {
                 C[ k ][ d ] = 0.0f;
@@ -628,3 +629,31 @@ static void silk_P_Ana_calc_energy_st3(
         target_ptr += sf_length;
     }
 }
+
+/*************************************************************/
+/* Calculates the stage 2 cross-correlations between a       */
+/* subframe and each candidate lag of its history, and the   */
+/* energies of the lagged vectors. The energy is only needed */
+/* (and only computed here) where the correlation is > 0.    */
+/*************************************************************/
+void silk_P_Ana_calc_corr_nrg_st2_FLP_c(
+    double              xcorr[],            /* O    Cross-correlations, one per lag                             */
+    double              energy[],           /* O    Energies of the lagged vectors, one per lag                 */
+    const silk_float    target[],           /* I    Target vector, preceded by at least max(lags) samples       */
+    const opus_int16    lags[],             /* I    Lags to evaluate                                            */
+    const opus_int      nb_lags,            /* I    Number of lags                                              */
+    const opus_int      len,                /* I    Vector length                                               */
+    int                 arch                /* I    Run-time architecture                                       */
+)
+{
+    opus_int j;
+    const silk_float *basis_ptr;
+
+    for( j = 0; j < nb_lags; j++ ) {
+        basis_ptr = target - lags[ j ];
+        xcorr[ j ] = silk_inner_product_FLP( basis_ptr, target, len, arch );
+        if( xcorr[ j ] > 0.0f ) {
+            energy[ j ] = silk_energy_FLP( basis_ptr, len );
+        }
+    }
+}
@@ -0,0 +1,90 @@
+/***********************************************************************
+Copyright (c) 2025 Xiph.Org Foundation
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+- Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+- Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+- Neither the name of Internet Society, IETF or IETF Trust, nor the
+names of specific contributors, may be used to endorse or promote
+products derived from this software without specific prior written
+permission.
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+***********************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "SigProc_FLP.h"
+#include <immintrin.h>
+
+static OPUS_INLINE double silk_mm256_hsum_pd( __m256d x )
+{
+    x = _mm256_add_pd( x, _mm256_permute2f128_pd( x, x, 1 ) );
+    x = _mm256_hadd_pd( x, x );
+    return _mm256_cvtsd_f64( x );
+}
+
+/* Stage 2 pitch correlations and lagged energies, accumulated in double */
+/* like silk_inner_product_FLP_avx2(); the energy is computed for every lag */
+void silk_P_Ana_calc_corr_nrg_st2_FLP_avx2(
+    double              xcorr[],            /* O    Cross-correlations, one per lag                             */
+    double              energy[],           /* O    Energies of the lagged vectors, one per lag                 */
+    const silk_float    target[],           /* I    Target vector, preceded by at least max(lags) samples       */
+    const opus_int16    lags[],             /* I    Lags to evaluate                                            */
+    const opus_int      nb_lags,            /* I    Number of lags                                              */
+    const opus_int      len,                /* I    Vector length                                               */
+    int                 arch                /* I    Run-time architecture                                       */
+)
+{
+    opus_int i, j;
+    double   xc, nrg;
+    const silk_float *basis_ptr;
+    __m256d  t, b, acc_xc1, acc_xc2, acc_nrg1, acc_nrg2;
+
+    (void)arch;
+    for( j = 0; j < nb_lags; j++ ) {
+        basis_ptr = target - lags[ j ];
+        acc_xc1 = acc_xc2 = acc_nrg1 = acc_nrg2 = _mm256_setzero_pd();
+        for( i = 0; i < len - 7; i += 8 ) {
+            t = _mm256_cvtps_pd( _mm_loadu_ps( &target[ i ] ) );
+            b = _mm256_cvtps_pd( _mm_loadu_ps( &basis_ptr[ i ] ) );
+            acc_xc1  = _mm256_fmadd_pd( b, t, acc_xc1 );
+            acc_nrg1 = _mm256_fmadd_pd( b, b, acc_nrg1 );
+            t = _mm256_cvtps_pd( _mm_loadu_ps( &target[ i + 4 ] ) );
+            b = _mm256_cvtps_pd( _mm_loadu_ps( &basis_ptr[ i + 4 ] ) );
+            acc_xc2  = _mm256_fmadd_pd( b, t, acc_xc2 );
+            acc_nrg2 = _mm256_fmadd_pd( b, b, acc_nrg2 );
+        }
+        for( ; i < len - 3; i += 4 ) {
+            t = _mm256_cvtps_pd( _mm_loadu_ps( &target[ i ] ) );
+            b = _mm256_cvtps_pd( _mm_loadu_ps( &basis_ptr[ i ] ) );
+            acc_xc1  = _mm256_fmadd_pd( b, t, acc_xc1 );
+            acc_nrg1 = _mm256_fmadd_pd( b, b, acc_nrg1 );
+        }
+        xc  = silk_mm256_hsum_pd( _mm256_add_pd( acc_xc1, acc_xc2 ) );
+        nrg = silk_mm256_hsum_pd( _mm256_add_pd( acc_nrg1, acc_nrg2 ) );
+
+        /* add any remaining products */
+        for( ; i < len; i++ ) {
+            xc  += basis_ptr[ i ] * (double)target[ i ];
+            nrg += basis_ptr[ i ] * (double)basis_ptr[ i ];
+        }
+        xcorr[ j ]  = xc;
+        energy[ j ] = nrg;
+    }
+}
@@ -0,0 +1,120 @@
+/***********************************************************************
+Copyright (c) 2025 Xiph.Org Foundation
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+- Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+- Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+- Neither the name of Internet Society, IETF or IETF Trust, nor the
+names of specific contributors, may be used to endorse or promote
+products derived from this software without specific prior written
+permission.
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+***********************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "main_FLP.h"
+#include "stack_alloc.h"
+#include <immintrin.h>
+
+/* One step of four allpass sections; prev_rot holds the previous outputs of the four sections below */
+static OPUS_INLINE void silk_warped_sections4_avx2(
+    __m256d                         *in,                                /* I/O  Section inputs                              */
+    __m256d                         *out,                               /* I/O  Section outputs                             */
+    __m256d                         *C,                                 /* I/O  Correlations                                */
+    __m256d                         *prev_rot,                          /* I/O  Rotated outputs of the vector below         */
+    const double                    *x,                                 /* I    Input samples for the four sections         */
+    __m256d                         w                                   /* I    Warping coefficient                         */
+)
+{
+    __m256d rot, in_new;
+    /* Inputs of this step are the previous outputs, moved up one section */
+    rot       = _mm256_permute4x64_pd( *out, _MM_SHUFFLE( 2, 1, 0, 3 ) );
+    in_new    = _mm256_blend_pd( rot, *prev_rot, 1 );
+    *prev_rot = rot;
+    /* Output of allpass section */
+    *out = _mm256_fmadd_pd( w, _mm256_sub_pd( *out, in_new ), *in );
+    *in  = in_new;
+    *C   = _mm256_fmadd_pd( _mm256_loadu_pd( x ), *out, *C );
+}
+
+/* Autocorrelations for a warped frequency axis.                                          */
+/* The allpass sections are run as a wavefront: at step t, section k processes sample     */
+/* t - k, so all sections of a step are independent and go four to a vector. Each section */
+/* takes its input from the output its lower neighbour produced at the previous step.     */
+void silk_warped_autocorrelation_FLP_avx2(
+    silk_float                      *corr,                              /* O    Result [order + 1]                          */
+    const silk_float                *input,                             /* I    Input data to correlate                     */
+    const silk_float                warping,                            /* I    Warping coefficient                         */
+    const opus_int                  length,                             /* I    Length of input                             */
+    const opus_int                  order                               /* I    Correlation order (even)                    */
+)
+{
+    opus_int    n, t;
+    double      C0;
+    const double *x_ptr;
+    __m256d     w, prev_rot;
+    __m256d     in0, in1, in2, in3, in4, in5;
+    __m256d     out0, out1, out2, out3, out4, out5;
+    __m256d     C_v[ MAX_SHAPE_LPC_ORDER / 4 ];
+    double      C[ MAX_SHAPE_LPC_ORDER ];
+    VARDECL( double, x_rev );
+    SAVE_STACK;
+
+    /* Order must be even; the six vectors cover all sections up to MAX_SHAPE_LPC_ORDER */
+    celt_assert( ( order & 1 ) == 0 );
+    celt_assert( MAX_SHAPE_LPC_ORDER == 24 && order <= MAX_SHAPE_LPC_ORDER );
+
+    /* Time-reversed input in double, zero padded on both sides: sample n is at length + 23 - n */
+    ALLOC( x_rev, length + 2 * MAX_SHAPE_LPC_ORDER, double );
+    silk_memset( x_rev, 0, ( length + 2 * MAX_SHAPE_LPC_ORDER ) * sizeof( double ) );
+    C0 = 0;
+    for( n = 0; n < length; n++ ) {
+        x_rev[ length + MAX_SHAPE_LPC_ORDER - 1 - n ] = input[ n ];
+        C0 += input[ n ] * (double)input[ n ];
+    }
+
+    w = _mm256_set1_pd( warping );
+    in0 = in1 = in2 = in3 = in4 = in5 = _mm256_setzero_pd();
+    out0 = out1 = out2 = out3 = out4 = out5 = _mm256_setzero_pd();
+    for( n = 0; n < MAX_SHAPE_LPC_ORDER / 4; n++ ) {
+        C_v[ n ] = _mm256_setzero_pd();
+    }
+    for( t = 0; t < length + order - 1; t++ ) {
+        /* Section k takes input[ t - k ], and the first one reads it from lane 0 of prev_rot */
+        x_ptr = &x_rev[ length + MAX_SHAPE_LPC_ORDER - 1 - t ];
+        prev_rot = _mm256_loadu_pd( x_ptr );
+        silk_warped_sections4_avx2( &in0, &out0, &C_v[ 0 ], &prev_rot, x_ptr,      w );
+        silk_warped_sections4_avx2( &in1, &out1, &C_v[ 1 ], &prev_rot, x_ptr + 4,  w );
+        silk_warped_sections4_avx2( &in2, &out2, &C_v[ 2 ], &prev_rot, x_ptr + 8,  w );
+        silk_warped_sections4_avx2( &in3, &out3, &C_v[ 3 ], &prev_rot, x_ptr + 12, w );
+        silk_warped_sections4_avx2( &in4, &out4, &C_v[ 4 ], &prev_rot, x_ptr + 16, w );
+        silk_warped_sections4_avx2( &in5, &out5, &C_v[ 5 ], &prev_rot, x_ptr + 20, w );
+    }
+
+    /* Copy correlations in silk_float output format */
+    corr[ 0 ] = ( silk_float )C0;
+    for( n = 0; n < MAX_SHAPE_LPC_ORDER / 4; n++ ) {
+        _mm256_storeu_pd( &C[ 4 * n ], C_v[ n ] );
+    }
+    for( n = 0; n < order; n++ ) {
+        corr[ n + 1 ] = ( silk_float )C[ n ];
+    }
+    RESTORE_STACK;
+}
@@ -140,3 +140,60 @@ opus_int32 silk_gains_ID(                                       /* O    returns
 
     return gainsID;
 }
+
+/* Predict the starting gain multiplier of the CBR rate-control loop */
+opus_int silk_gains_mult_predict(                               /* O    returns gain multiplier (Q8)                */
+    const silk_encoder_state    *psEncC                         /* I    encoder state                               */
+)
+{
+    return silk_LIMIT_32( silk_log2lin( psEncC->gainMultPred_Q7 + ( 8 << 7 ) ), 64, 1024 );
+}
+
+/* Next gain multiplier of the rate-control loop, from the measured bits-vs-gain slope */
+opus_int silk_gains_mult_step(                                  /* O    returns new gain multiplier (Q8)            */
+    const silk_encoder_state    *psEncC,                        /* I    encoder state                               */
+    const opus_int              gainMult_Q8,                    /* I    gain multiplier of the last pass (Q8)       */
+    const opus_int              nBits,                          /* I    bits used by the last pass                  */
+    const opus_int              targetBits                      /* I    number of bits to aim for                   */
+)
+{
+    opus_int32 delta_Q7;
+
+    celt_assert( psEncC->bitsPerGainOct > 0 );
+    /* The bit count is roughly linear in the log of the gain */
+    delta_Q7 = silk_DIV32( silk_LSHIFT( nBits - targetBits, 7 ), psEncC->bitsPerGainOct );
+    /* Move by at least 1/20 and at most one octave */
+    if( delta_Q7 >= 0 ) {
+        delta_Q7 = silk_LIMIT_32( delta_Q7, 6, 128 );
+    } else {
+        delta_Q7 = silk_LIMIT_32( delta_Q7, -128, -6 );
+    }
+    return silk_LIMIT_32( silk_log2lin( silk_lin2log( gainMult_Q8 ) + delta_Q7 ), 64, 1024 );
+}
+
+/* Update the rate-control gain model after a CBR frame */
+void silk_gains_mult_update(
+    silk_encoder_state          *psEncC,                        /* I/O  encoder state                               */
+    const opus_int              gainMult0_Q8,                   /* I    gain multiplier of the first pass (Q8)      */
+    const opus_int              nBits0,                         /* I    bits used by the first pass                 */
+    const opus_int              gainMult1_Q8,                   /* I    gain multiplier of the final pass (Q8)      */
+    const opus_int              nBits1                          /* I    bits used by the final pass                 */
+)
+{
+    opus_int32 dlog_Q7, slope;
+
+    dlog_Q7 = silk_lin2log( gainMult1_Q8 ) - silk_lin2log( gainMult0_Q8 );
+    if( silk_abs( dlog_Q7 ) >= 8 ) {
+        slope = silk_DIV32( silk_LSHIFT( nBits0 - nBits1, 7 ), dlog_Q7 );
+        if( slope > 0 ) {
+            slope = silk_LIMIT_32( slope, silk_RSHIFT( psEncC->frame_length, 4 ), silk_LSHIFT( psEncC->frame_length, 1 ) );
+            if( psEncC->bitsPerGainOct == 0 ) {
+                psEncC->bitsPerGainOct = slope;
+            } else {
+                psEncC->bitsPerGainOct += silk_RSHIFT( slope - psEncC->bitsPerGainOct, 2 );
+            }
+        }
+    }
+    /* Start the next frame halfway between where this one started and where it ended */
+    psEncC->gainMultPred_Q7 = silk_LIMIT_32( silk_RSHIFT( psEncC->gainMultPred_Q7 + silk_lin2log( gainMult1_Q8 ) - ( 8 << 7 ), 1 ), -256, 256 );
+}
@@ -44,13 +44,16 @@ opus_int silk_reset_decoder(
     silk_decoder_state          *psDec                          /* I/O  Decoder state pointer                       */
 )
 {
+    /* The run-time architecture is kept across resets */
+    int arch = psDec->arch;
+
     /* Clear the entire encoder state, except anything copied */
     silk_memset( &psDec->SILK_DECODER_STATE_RESET_START, 0, sizeof( silk_decoder_state ) - ((char*) &psDec->SILK_DECODER_STATE_RESET_START - (char*)psDec) );
 
     /* Used to deactivate LSF interpolation */
     psDec->first_frame_after_reset = 1;
     psDec->prev_gain_Q16 = 65536;
-    psDec->arch = opus_select_arch();
+    psDec->arch = arch;
 
     /* Reset CNG state */
     silk_CNG_Reset( psDec );
@@ -71,11 +74,13 @@ opus_int silk_reset_decoder(
 /* Init Decoder State   */
 /************************/
 opus_int silk_init_decoder(
-    silk_decoder_state          *psDec                          /* I/O  Decoder state pointer                       */
+    silk_decoder_state          *psDec,                         /* I/O  Decoder state pointer                       */
+    int                         arch                            /* I    Run-time architecture                       */
 )
 {
     /* Clear the entire encoder state, except anything copied */
     silk_memset( psDec, 0, sizeof( silk_decoder_state ) );
+    psDec->arch = arch;
 
     silk_reset_decoder( psDec );
 
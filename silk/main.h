@@ -198,6 +198,28 @@ opus_int32 silk_gains_ID(                                       /* O    returns
     const opus_int              nb_subfr                        /* I    number of subframes                         */
 );
 
+/* Predict the starting gain multiplier of the CBR rate-control loop */
+opus_int silk_gains_mult_predict(                               /* O    returns gain multiplier (Q8)                */
+    const silk_encoder_state    *psEncC                         /* I    encoder state                               */
+);
+
+/* Next gain multiplier of the rate-control loop, from the measured bits-vs-gain slope */
+opus_int silk_gains_mult_step(                                  /* O    returns new gain multiplier (Q8)            */
+    const silk_encoder_state    *psEncC,                        /* I    encoder state                               */
+    const opus_int              gainMult_Q8,                    /* I    gain multiplier of the last pass (Q8)       */
+    const opus_int              nBits,                          /* I    bits used by the last pass                  */
+    const opus_int              targetBits                      /* I    number of bits to aim for                   */
+);
+
+/* Update the rate-control gain model after a CBR frame */
+void silk_gains_mult_update(
+    silk_encoder_state          *psEncC,                        /* I/O  encoder state                               */
+    const opus_int              gainMult0_Q8,                   /* I    gain multiplier of the first pass (Q8)      */
+    const opus_int              nBits0,                         /* I    bits used by the first pass                 */
+    const opus_int              gainMult1_Q8,                   /* I    gain multiplier of the final pass (Q8)      */
+    const opus_int              nBits1                          /* I    bits used by the final pass                 */
+);
+
 /* Interpolate two vectors */
 void silk_interpolate(
     opus_int16                  xi[ MAX_LPC_ORDER ],            /* O    interpolated vector                         */
@@ -342,11 +364,12 @@ opus_int32 silk_NLSF_encode(                                    /* O    Returns
     const opus_int16            *pW_QW,                         /* I    NLSF weight vector [ LPC_ORDER ]            */
     const opus_int              NLSF_mu_Q20,                    /* I    Rate weight for the RD optimization         */
     const opus_int              nSurvivors,                     /* I    Max survivors after first stage             */
-    const opus_int              signalType                      /* I    Signal type: 0/1/2                          */
+    const opus_int              signalType,                     /* I    Signal type: 0/1/2                          */
+    int                         arch                            /* I    Run-time architecture                       */
 );
 
 /* Compute quantization errors for an LPC_order element input vector for a VQ codebook */
-void silk_NLSF_VQ(
+void silk_NLSF_VQ_c(
     opus_int32                  err_Q26[],                      /* O    Quantization errors [K]                     */
     const opus_int16            in_Q15[],                       /* I    Input vectors to be quantized [LPC_order]   */
     const opus_uint8            pCB_Q8[],                       /* I    Codebook vectors [K*LPC_order]              */
@@ -355,8 +378,13 @@ void silk_NLSF_VQ(
     const opus_int              LPC_order                       /* I    Number of LPCs                              */
 );
 
+#if !defined(OVERRIDE_silk_NLSF_VQ)
+#define silk_NLSF_VQ(err_Q24, in_Q15, pCB_Q8, pWght_Q9, K, LPC_order, arch) \
+    ((void)(arch),silk_NLSF_VQ_c(err_Q24, in_Q15, pCB_Q8, pWght_Q9, K, LPC_order))
+#endif
+
 /* Delayed-decision quantizer for NLSF residuals */
-opus_int32 silk_NLSF_del_dec_quant(                             /* O    Returns RD value in Q25                     */
+opus_int32 silk_NLSF_del_dec_quant_c(                           /* O    Returns RD value in Q25                     */
     opus_int8                   indices[],                      /* O    Quantization indices [ order ]              */
     const opus_int16            x_Q10[],                        /* I    Input [ order ]                             */
     const opus_int16            w_Q5[],                         /* I    Weights [ order ]                           */
@@ -369,6 +397,13 @@ opus_int32 silk_NLSF_del_dec_quant(                             /* O    Returns
     const opus_int16            order                           /* I    Number of input values                      */
 );
 
+#if !defined(OVERRIDE_silk_NLSF_del_dec_quant)
+#define silk_NLSF_del_dec_quant(indices, x_Q10, w_Q5, pred_coef_Q8, ec_ix, ec_rates_Q5, quant_step_size_Q16, \
+                                inv_quant_step_size_Q6, mu_Q20, order, arch) \
+    ((void)(arch),silk_NLSF_del_dec_quant_c(indices, x_Q10, w_Q5, pred_coef_Q8, ec_ix, ec_rates_Q5, quant_step_size_Q16, \
+                                inv_quant_step_size_Q6, mu_Q20, order))
+#endif
+
 /* Unpack predictor values and indices for entropy coding tables */
 void silk_NLSF_unpack(
           opus_int16            ec_ix[],                        /* O    Indices to entropy tables [ LPC_ORDER ]     */
@@ -394,7 +429,8 @@ opus_int silk_reset_decoder(
 );
 
 opus_int silk_init_decoder(
-    silk_decoder_state          *psDec                          /* I/O  Decoder state pointer                       */
+    silk_decoder_state          *psDec,                         /* I/O  Decoder state pointer                       */
+    int                         arch                            /* I    Run-time architecture                       */
 );
 
 /* Set decoder sampling rate */
@@ -193,6 +193,8 @@ typedef struct {
     opus_int                     controlled_since_last_payload;     /* Flag for ensuring codec_control only runs once per packet        */
     opus_int                     warping_Q16;                       /* Warping parameter for warped noise shaping                       */
     opus_int                     useCBR;                            /* Flag to enable constant bitrate                                  */
+    opus_int                     gainMultPred_Q7;                   /* Predicted log2 of the CBR rate-control gain multiplier           */
+    opus_int                     bitsPerGainOct;                    /* Estimated change in frame bits per octave of gain (0: unknown)   */
     opus_int                     prefillFlag;                       /* Flag to indicate that only buffers are prefilled, no coding      */
     const opus_uint8             *pitch_lag_low_bits_iCDF;          /* Pointer to iCDF table for low bits of pitch lag index            */
     const opus_uint8             *pitch_contour_iCDF;               /* Pointer to iCDF table for pitch contour index                    */
@@ -248,6 +250,8 @@ typedef struct {
     OSCEFeatureState features;
     OSCEState state;
     int method;
+    double (*dnn_clock)(void);  /* Clock timing the enhancement, NULL when not timed */
+    double dnn_time;            /* Time spent in the enhancement since the last frame */
 } silk_OSCE_struct;
 #endif
 
@@ -0,0 +1,139 @@
+/***********************************************************************
+Copyright (c) 2025 Xiph.Org Foundation
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+- Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+- Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+- Neither the name of Internet Society, IETF or IETF Trust, nor the
+names of specific contributors, may be used to endorse or promote
+products derived from this software without specific prior written
+permission.
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+***********************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "celt/stack_alloc.h"
+#include "cpu_support.h"
+#include "main.h"
+
+/* Checks the run-time selected silk_NLSF_VQ() and silk_NLSF_del_dec_quant()
+   against the C versions, which they must match bit-exactly. */
+
+static opus_int16 rand_int16(int shift) {
+    return (opus_int16)rand() >> shift;
+}
+
+static int test_NLSF_VQ(const silk_NLSF_CB_struct *psNLSF_CB, int arch) {
+    int          i;
+    opus_int16   NLSF_Q15[ MAX_LPC_ORDER ];
+    opus_int32   err_c_Q24[ NLSF_VQ_MAX_VECTORS ];
+    opus_int32   err_Q24[ NLSF_VQ_MAX_VECTORS ];
+
+    for( i = 0; i < psNLSF_CB->order; i++ ) {
+        NLSF_Q15[ i ] = rand() & 0x7FFF;
+    }
+    silk_NLSF_VQ_c( err_c_Q24, NLSF_Q15, psNLSF_CB->CB1_NLSF_Q8, psNLSF_CB->CB1_Wght_Q9,
+        psNLSF_CB->nVectors, psNLSF_CB->order );
+    silk_NLSF_VQ( err_Q24, NLSF_Q15, psNLSF_CB->CB1_NLSF_Q8, psNLSF_CB->CB1_Wght_Q9,
+        psNLSF_CB->nVectors, psNLSF_CB->order, arch );
+    for( i = 0; i < psNLSF_CB->nVectors; i++ ) {
+        if( err_c_Q24[ i ] != err_Q24[ i ] ) {
+            fprintf(stderr, "silk_NLSF_VQ() mismatch at vector %d: %d vs %d\n", i,
+                (int)err_c_Q24[ i ], (int)err_Q24[ i ]);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int test_NLSF_del_dec_quant(const silk_NLSF_CB_struct *psNLSF_CB, int shift, int arch) {
+    int          i, ind1;
+    opus_int32   mu_Q20, max_W_Q5, RD_c_Q25, RD_Q25;
+    opus_int8    indices_c[ MAX_LPC_ORDER ];
+    opus_int8    indices[ MAX_LPC_ORDER ];
+    opus_int16   res_Q10[ MAX_LPC_ORDER ];
+    opus_int16   W_Q5[ MAX_LPC_ORDER ];
+    opus_uint8   pred_Q8[ MAX_LPC_ORDER ];
+    opus_int16   ec_ix[ MAX_LPC_ORDER ];
+
+    /* Different dynamic ranges cover both the table and the extrapolated rates; the
+       weights are limited so that the RD values can't overflow */
+    max_W_Q5 = ( 1 << 26 ) / silk_SMULBB( ( 32767 >> shift ) + 2048, ( 32767 >> shift ) + 2048 );
+    ind1 = rand() % psNLSF_CB->nVectors;
+    for( i = 0; i < psNLSF_CB->order; i++ ) {
+        res_Q10[ i ] = rand_int16( shift );
+        W_Q5[ i ] = 1 + rand() % max_W_Q5;
+    }
+    mu_Q20 = rand() & 0x7FFF;
+    silk_NLSF_unpack( ec_ix, pred_Q8, psNLSF_CB, ind1 );
+
+    RD_c_Q25 = silk_NLSF_del_dec_quant_c( indices_c, res_Q10, W_Q5, pred_Q8, ec_ix, psNLSF_CB->ec_Rates_Q5,
+        psNLSF_CB->quantStepSize_Q16, psNLSF_CB->invQuantStepSize_Q6, mu_Q20, psNLSF_CB->order );
+    RD_Q25 = silk_NLSF_del_dec_quant( indices, res_Q10, W_Q5, pred_Q8, ec_ix, psNLSF_CB->ec_Rates_Q5,
+        psNLSF_CB->quantStepSize_Q16, psNLSF_CB->invQuantStepSize_Q6, mu_Q20, psNLSF_CB->order, arch );
+    if( RD_c_Q25 != RD_Q25 ) {
+        fprintf(stderr, "silk_NLSF_del_dec_quant() RD mismatch: %d vs %d\n", (int)RD_c_Q25, (int)RD_Q25);
+        return 1;
+    }
+    for( i = 0; i < psNLSF_CB->order; i++ ) {
+        if( indices_c[ i ] != indices[ i ] ) {
+            fprintf(stderr, "silk_NLSF_del_dec_quant() mismatch at index %d: %d vs %d\n", i,
+                indices_c[ i ], indices[ i ]);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main(void) {
+    const int arch = opus_select_arch();
+    const silk_NLSF_CB_struct *codebooks[ 2 ];
+    const int loop_num = 10000;
+    int count, cb, shift;
+    ALLOC_STACK;
+
+    srand(0);
+    codebooks[ 0 ] = &silk_NLSF_CB_NB_MB;
+    codebooks[ 1 ] = &silk_NLSF_CB_WB;
+
+    printf("Testing silk_NLSF_VQ() and silk_NLSF_del_dec_quant() optimization ...\n");
+    for( count = 0; count < loop_num; count++ ) {
+        for( cb = 0; cb < 2; cb++ ) {
+            if( test_NLSF_VQ( codebooks[ cb ], arch ) ) {
+                fprintf(stderr, "**Loop %4d failed!**\n", count);
+                return 1;
+            }
+            for( shift = 4; shift < 16; shift++ ) {
+                if( test_NLSF_del_dec_quant( codebooks[ cb ], shift, arch ) ) {
+                    fprintf(stderr, "**Loop %4d failed!**\n", count);
+                    return 1;
+                }
+            }
+        }
+        if( !(count % 1000) ) {
+            printf("Loop %4d passed\n", count);
+        }
+    }
+    printf("silk_NLSF_VQ() and silk_NLSF_del_dec_quant() optimization passed\n");
+    RESTORE_STACK;
+    return 0;
+}
@@ -82,6 +82,9 @@ extern "C"
 /* Speech Activity LBRR enable threshold */
 #define LBRR_SPEECH_ACTIVITY_THRES                      0.3f
 
+/* Max number of delayed-decision states used when quantizing the LBRR copy */
+#define LBRR_MAX_DEL_DEC_STATES                         1
+
 /*************************/
 /* Perceptual parameters */
 /*************************/
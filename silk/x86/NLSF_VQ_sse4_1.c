@@ -0,0 +1,116 @@
+/***********************************************************************
+Copyright (c) 2025 Xiph.Org Foundation
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+- Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+- Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+- Neither the name of Internet Society, IETF or IETF Trust, nor the
+names of specific contributors, may be used to endorse or promote
+products derived from this software without specific prior written
+permission.
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+***********************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <xmmintrin.h>
+#include <emmintrin.h>
+#include <smmintrin.h>
+#include "main.h"
+#include "celt/x86/x86cpu.h"
+
+/* Compute quantization errors for an LPC_order element input vector for a VQ codebook */
+/* (same integer arithmetic as silk_NLSF_VQ_c(), evaluated across the vector elements) */
+void silk_NLSF_VQ_sse4_1(
+    opus_int32                  err_Q24[],                      /* O    Quantization errors [K]                     */
+    const opus_int16            in_Q15[],                       /* I    Input vectors to be quantized [LPC_order]   */
+    const opus_uint8            pCB_Q8[],                       /* I    Codebook vectors [K*LPC_order]              */
+    const opus_int16            pWght_Q9[],                     /* I    Codebook weights [K*LPC_order]              */
+    const opus_int              K,                              /* I    Number of codebook vectors                  */
+    const opus_int              LPC_order                       /* I    Number of LPCs                              */
+)
+{
+    opus_int         i, k, m, n8, n4;
+    const opus_int16 *w_Q9_ptr;
+    const opus_uint8 *cb_Q8_ptr;
+    __m128i          in_Q15_tail, cb_Q8_tail, diff_Q15, w_Q9, lo, hi, pred_Q24, sum_error_Q24;
+    __m128i          in_Q15_v[ MAX_LPC_ORDER / 8 ];
+    __m128i          diffw_Q24[ MAX_LPC_ORDER / 4 + 1 ];
+
+    celt_assert( ( LPC_order & 1 ) == 0 );
+    celt_assert( LPC_order <= MAX_LPC_ORDER );
+
+    /* SILK uses orders 10 and 16; anything else that doesn't leave a tail of 0 or 2 goes to C */
+    if( ( LPC_order & 7 ) != 0 && ( LPC_order & 7 ) != 2 ) {
+        silk_NLSF_VQ_c( err_Q24, in_Q15, pCB_Q8, pWght_Q9, K, LPC_order );
+        return;
+    }
+
+    n8 = LPC_order & ~7;
+    n4 = ( LPC_order + 3 ) >> 2;
+    for( m = 0; m < n8; m += 8 ) {
+        in_Q15_v[ m >> 3 ] = _mm_loadu_si128( (__m128i *)(void *)&in_Q15[ m ] );
+    }
+    /* Zero-padded input tail: the padded lanes give a weighted difference of zero */
+    in_Q15_tail = _mm_setzero_si128();
+    if( n8 < LPC_order ) {
+        in_Q15_tail = _mm_loadu_si32( &in_Q15[ n8 ] );
+    }
+    for( k = 0; k < MAX_LPC_ORDER / 4 + 1; k++ ) {
+        diffw_Q24[ k ] = _mm_setzero_si128();
+    }
+
+    /* Loop over codebook */
+    cb_Q8_ptr = pCB_Q8;
+    w_Q9_ptr = pWght_Q9;
+    for( i = 0; i < K; i++ ) {
+        for( m = 0; m < n8; m += 8 ) {
+            diff_Q15 = _mm_cvtepu8_epi16( _mm_loadl_epi64( (__m128i *)(void *)&cb_Q8_ptr[ m ] ) );
+            diff_Q15 = _mm_sub_epi16( in_Q15_v[ m >> 3 ], _mm_slli_epi16( diff_Q15, 7 ) ); /* range: [ -32767 : 32767 ]*/
+            w_Q9     = _mm_loadu_si128( (__m128i *)(void *)&w_Q9_ptr[ m ] );
+            lo       = _mm_mullo_epi16( diff_Q15, w_Q9 );
+            hi       = _mm_mulhi_epi16( diff_Q15, w_Q9 );
+            diffw_Q24[ ( m >> 2 )     ] = _mm_unpacklo_epi16( lo, hi );
+            diffw_Q24[ ( m >> 2 ) + 1 ] = _mm_unpackhi_epi16( lo, hi );
+        }
+        if( n8 < LPC_order ) {
+            cb_Q8_tail = _mm_cvtsi32_si128( (opus_int32)cb_Q8_ptr[ n8 ] | ( (opus_int32)cb_Q8_ptr[ n8 + 1 ] << 8 ) );
+            diff_Q15 = _mm_sub_epi16( in_Q15_tail, _mm_slli_epi16( _mm_cvtepu8_epi16( cb_Q8_tail ), 7 ) );
+            w_Q9     = _mm_loadu_si32( &w_Q9_ptr[ n8 ] );
+            lo       = _mm_mullo_epi16( diff_Q15, w_Q9 );
+            hi       = _mm_mulhi_epi16( diff_Q15, w_Q9 );
+            diffw_Q24[ n8 >> 2 ] = _mm_unpacklo_epi16( lo, hi );
+        }
+
+        /* Weighted absolute predictive quantization error, predicting each element from the next one */
+        sum_error_Q24 = _mm_setzero_si128();
+        for( k = 0; k < n4; k++ ) {
+            pred_Q24 = _mm_alignr_epi8( diffw_Q24[ k + 1 ], diffw_Q24[ k ], 4 );
+            pred_Q24 = _mm_sub_epi32( diffw_Q24[ k ], _mm_srai_epi32( pred_Q24, 1 ) );
+            sum_error_Q24 = _mm_add_epi32( sum_error_Q24, _mm_abs_epi32( pred_Q24 ) );
+        }
+        sum_error_Q24 = _mm_add_epi32( sum_error_Q24, _mm_shuffle_epi32( sum_error_Q24, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+        sum_error_Q24 = _mm_add_epi32( sum_error_Q24, _mm_shuffle_epi32( sum_error_Q24, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+        err_Q24[ i ] = _mm_cvtsi128_si32( sum_error_Q24 );
+        silk_assert( err_Q24[ i ] >= 0 );
+
+        cb_Q8_ptr += LPC_order;
+        w_Q9_ptr += LPC_order;
+    }
+}
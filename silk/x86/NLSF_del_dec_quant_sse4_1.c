@@ -0,0 +1,250 @@
+/***********************************************************************
+Copyright (c) 2025 Xiph.Org Foundation
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+- Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+- Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+- Neither the name of Internet Society, IETF or IETF Trust, nor the
+names of specific contributors, may be used to endorse or promote
+products derived from this software without specific prior written
+permission.
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+***********************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <xmmintrin.h>
+#include <emmintrin.h>
+#include <smmintrin.h>
+#include "main.h"
+#include "celt/x86/x86cpu.h"
+
+#if NLSF_QUANT_DEL_DEC_STATES != 4
+#error "silk_NLSF_del_dec_quant_sse4_1() requires NLSF_QUANT_DEL_DEC_STATES == 4"
+#endif
+
+/* Each 32-bit lane holds an opus_int16 operand in its low half: multiplying by a value */
+/* whose high half is zero gives silk_SMULBB() of the two                               */
+static OPUS_INLINE __m128i silk_mm_smulbb_epi32( __m128i a, __m128i b_lo )
+{
+    return _mm_madd_epi16( a, b_lo );
+}
+
+/* Reconstruction level for quantization index ind, i.e. the out0_Q10_table[] entry of the C version */
+static OPUS_INLINE __m128i silk_mm_NLSF_quant_level( __m128i ind, __m128i step_Q16 )
+{
+    __m128i out_Q10;
+    out_Q10 = _mm_slli_epi32( ind, 10 );
+    out_Q10 = _mm_sub_epi32( out_Q10, _mm_sign_epi32( _mm_set1_epi32( SILK_FIX_CONST( NLSF_QUANT_LEVEL_ADJ, 10 ) ), ind ) );
+    return _mm_srai_epi32( silk_mm_smulbb_epi32( out_Q10, step_Q16 ), 16 );
+}
+
+/* Rate for quantization index k - NLSF_QUANT_MAX_AMPLITUDE: taken from the table inside */
+/* the range and extrapolated with a slope of 43 outside of it, as in the C version      */
+static OPUS_INLINE __m128i silk_mm_NLSF_quant_rate( __m128i k, __m128i rates_Q5 )
+{
+    __m128i k_lim, rate_Q5, ext_Q5;
+    k_lim   = _mm_min_epi32( _mm_max_epi32( k, _mm_set1_epi32( 1 ) ), _mm_set1_epi32( 2 * NLSF_QUANT_MAX_AMPLITUDE - 1 ) );
+    rate_Q5 = _mm_shuffle_epi8( rates_Q5, _mm_or_si128( k_lim, _mm_set1_epi32( (opus_int32)0x80808000 ) ) );
+    ext_Q5  = _mm_abs_epi32( _mm_sub_epi32( k, _mm_set1_epi32( NLSF_QUANT_MAX_AMPLITUDE ) ) );
+    ext_Q5  = _mm_add_epi32( silk_mm_smulbb_epi32( ext_Q5, _mm_set1_epi32( 43 ) ), _mm_set1_epi32( 280 - 43 * NLSF_QUANT_MAX_AMPLITUDE ) );
+    return _mm_blendv_epi8( ext_Q5, rate_Q5, _mm_cmpeq_epi32( k_lim, k ) );
+}
+
+/* Delayed-decision quantizer for NLSF residuals, with the states updated in parallel */
+opus_int32 silk_NLSF_del_dec_quant_sse4_1(                      /* O    Returns RD value in Q25                     */
+    opus_int8                   indices[],                      /* O    Quantization indices [ order ]              */
+    const opus_int16            x_Q10[],                        /* I    Input [ order ]                             */
+    const opus_int16            w_Q5[],                         /* I    Weights [ order ]                           */
+    const opus_uint8            pred_coef_Q8[],                 /* I    Backward predictor coefs [ order ]          */
+    const opus_int16            ec_ix[],                        /* I    Indices to entropy coding tables [ order ]  */
+    const opus_uint8            ec_rates_Q5[],                  /* I    Rates []                                    */
+    const opus_int              quant_step_size_Q16,            /* I    Quantization step size                      */
+    const opus_int16            inv_quant_step_size_Q6,         /* I    Inverse quantization step size              */
+    const opus_int32            mu_Q20,                         /* I    R/D tradeoff                                */
+    const opus_int16            order                           /* I    Number of input values                      */
+)
+{
+    opus_int         i, j, nStates, ind_tmp, ind_min_max, ind_max_min;
+    opus_int32       min_Q25, min_max_Q25, max_min_Q25;
+    opus_int32       ind_sort[         NLSF_QUANT_DEL_DEC_STATES ];
+    opus_int32       ind_Q0[           NLSF_QUANT_DEL_DEC_STATES ];
+    opus_int8        ind[              NLSF_QUANT_DEL_DEC_STATES ][ MAX_LPC_ORDER ];
+    opus_int32       prev_out_Q10[ 2 * NLSF_QUANT_DEL_DEC_STATES ];
+    opus_int32       RD_Q25[       2 * NLSF_QUANT_DEL_DEC_STATES ];
+    opus_int32       RD_min_Q25[       NLSF_QUANT_DEL_DEC_STATES ];
+    opus_int32       RD_max_Q25[       NLSF_QUANT_DEL_DEC_STATES ];
+    __m128i          step_Q16, inv_step_Q6, mu, in_Q10, w, pred_coef, rates_Q5, ind_v, gt, tmp;
+    __m128i          pred_Q10, out0_Q10, out1_Q10, diff_Q10, RD0_Q25, RD1_Q25;
+    __m128i          prev_out_lo_Q10, prev_out_hi_Q10, RD_lo_Q25, RD_hi_Q25, RD_min_v_Q25, RD_max_v_Q25;
+
+    /* Multiplicands with a zero high half, see silk_mm_smulbb_epi32() */
+    step_Q16    = _mm_set1_epi32( quant_step_size_Q16 & 0xFFFF );
+    inv_step_Q6 = _mm_set1_epi32( inv_quant_step_size_Q6 & 0xFFFF );
+    mu          = _mm_set1_epi32( mu_Q20 & 0xFFFF );
+
+    /* Only the low 16 bits of the prev_out_Q10 lanes are significant, as in the opus_int16 array */
+    /* of the C version; unused lanes only ever hold values derived from these zeros              */
+    prev_out_lo_Q10 = _mm_setzero_si128();
+    prev_out_hi_Q10 = _mm_setzero_si128();
+    RD_lo_Q25       = _mm_setzero_si128();
+    RD_hi_Q25       = _mm_setzero_si128();
+
+    nStates = 1;
+    for( i = order - 1; i >= 0; i-- ) {
+        in_Q10    = _mm_set1_epi32( x_Q10[ i ] );
+        w         = _mm_set1_epi32( w_Q5[ i ] );
+        pred_coef = _mm_set1_epi32( pred_coef_Q8[ i ] );
+        /* Only entries 1 to 2 * NLSF_QUANT_MAX_AMPLITUDE - 1 of the rate table are ever used */
+        rates_Q5  = _mm_loadl_epi64( (__m128i *)(void *)&ec_rates_Q5[ ec_ix[ i ] ] );
+
+        pred_Q10 = _mm_srai_epi32( silk_mm_smulbb_epi32( prev_out_lo_Q10, pred_coef ), 8 );
+        ind_v    = _mm_srai_epi32( silk_mm_smulbb_epi32( _mm_sub_epi32( in_Q10, pred_Q10 ), inv_step_Q6 ), 16 );
+        ind_v    = _mm_max_epi32( ind_v, _mm_set1_epi32( -NLSF_QUANT_MAX_AMPLITUDE_EXT ) );
+        ind_v    = _mm_min_epi32( ind_v, _mm_set1_epi32( NLSF_QUANT_MAX_AMPLITUDE_EXT - 1 ) );
+
+        /* compute outputs for ind_tmp and ind_tmp + 1 */
+        out0_Q10 = _mm_add_epi32( silk_mm_NLSF_quant_level( ind_v, step_Q16 ), pred_Q10 );
+        out1_Q10 = _mm_add_epi32( silk_mm_NLSF_quant_level( _mm_add_epi32( ind_v, _mm_set1_epi32( 1 ) ), step_Q16 ), pred_Q10 );
+
+        /* compute RD for ind_tmp and ind_tmp + 1 */
+        tmp      = _mm_add_epi32( ind_v, _mm_set1_epi32( NLSF_QUANT_MAX_AMPLITUDE ) );
+        diff_Q10 = _mm_and_si128( _mm_sub_epi32( in_Q10, out0_Q10 ), _mm_set1_epi32( 0xFFFF ) );
+        RD0_Q25  = _mm_add_epi32( RD_lo_Q25, _mm_mullo_epi32( silk_mm_smulbb_epi32( diff_Q10, diff_Q10 ), w ) );
+        RD0_Q25  = _mm_add_epi32( RD0_Q25, silk_mm_smulbb_epi32( silk_mm_NLSF_quant_rate( tmp, rates_Q5 ), mu ) );
+        tmp      = _mm_add_epi32( tmp, _mm_set1_epi32( 1 ) );
+        diff_Q10 = _mm_and_si128( _mm_sub_epi32( in_Q10, out1_Q10 ), _mm_set1_epi32( 0xFFFF ) );
+        RD1_Q25  = _mm_add_epi32( RD_lo_Q25, _mm_mullo_epi32( silk_mm_smulbb_epi32( diff_Q10, diff_Q10 ), w ) );
+        RD1_Q25  = _mm_add_epi32( RD1_Q25, silk_mm_smulbb_epi32( silk_mm_NLSF_quant_rate( tmp, rates_Q5 ), mu ) );
+
+        if( nStates <= NLSF_QUANT_DEL_DEC_STATES/2 ) {
+            /* place the states for ind_tmp + 1 right after those for ind_tmp */
+            if( nStates == 1 ) {
+                prev_out_lo_Q10 = _mm_unpacklo_epi32( out0_Q10, out1_Q10 );
+                RD_lo_Q25       = _mm_unpacklo_epi32( RD0_Q25, RD1_Q25 );
+            } else {
+                prev_out_lo_Q10 = _mm_unpacklo_epi64( out0_Q10, out1_Q10 );
+                RD_lo_Q25       = _mm_unpacklo_epi64( RD0_Q25, RD1_Q25 );
+            }
+
+            /* double number of states and copy */
+            _mm_storeu_si128( (__m128i *)(void *)&ind_Q0[ 0 ], ind_v );
+            for( j = 0; j < nStates; j++ ) {
+                ind[ j           ][ i ] = (opus_int8)ind_Q0[ j ];
+                ind[ j + nStates ][ i ] = (opus_int8)ind_Q0[ j ] + 1;
+            }
+            nStates = silk_LSHIFT( nStates, 1 );
+            for( j = nStates; j < NLSF_QUANT_DEL_DEC_STATES; j++ ) {
+                ind[ j ][ i ] = ind[ j - nStates ][ i ];
+            }
+        } else {
+            /* sort lower and upper half of RD_Q25, pairwise */
+            gt              = _mm_cmpgt_epi32( RD0_Q25, RD1_Q25 );
+            RD_min_v_Q25    = _mm_min_epi32( RD0_Q25, RD1_Q25 );
+            RD_max_v_Q25    = _mm_max_epi32( RD0_Q25, RD1_Q25 );
+            prev_out_lo_Q10 = _mm_blendv_epi8( out0_Q10, out1_Q10, gt );
+            prev_out_hi_Q10 = _mm_blendv_epi8( out1_Q10, out0_Q10, gt );
+            RD_lo_Q25       = RD_min_v_Q25;
+            RD_hi_Q25       = RD_max_v_Q25;
+
+            /* usually the highest RD value of the winning half is below the lowest one in the losing half */
+            tmp = _mm_min_epi32( RD_max_v_Q25, _mm_shuffle_epi32( RD_max_v_Q25, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+            min_max_Q25 = _mm_cvtsi128_si32( _mm_min_epi32( tmp, _mm_shuffle_epi32( tmp, _MM_SHUFFLE( 2, 3, 0, 1 ) ) ) );
+            tmp = _mm_max_epi32( RD_min_v_Q25, _mm_setzero_si128() );
+            tmp = _mm_max_epi32( tmp, _mm_shuffle_epi32( tmp, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+            max_min_Q25 = _mm_cvtsi128_si32( _mm_max_epi32( tmp, _mm_shuffle_epi32( tmp, _MM_SHUFFLE( 2, 3, 0, 1 ) ) ) );
+            if( min_max_Q25 >= max_min_Q25 ) {
+                /* increment index if it comes from the upper half */
+                _mm_storeu_si128( (__m128i *)(void *)&ind_Q0[ 0 ], _mm_sub_epi32( ind_v, gt ) );
+                for( j = 0; j < NLSF_QUANT_DEL_DEC_STATES; j++ ) {
+                    ind[ j ][ i ] = (opus_int8)ind_Q0[ j ];
+                }
+            } else {
+                _mm_storeu_si128( (__m128i *)(void *)&ind_Q0[ 0 ], ind_v );
+                _mm_storeu_si128( (__m128i *)(void *)&ind_sort[ 0 ], _mm_add_epi32( _mm_setr_epi32( 0, 1, 2, 3 ),
+                    _mm_and_si128( gt, _mm_set1_epi32( NLSF_QUANT_DEL_DEC_STATES ) ) ) );
+                _mm_storeu_si128( (__m128i *)(void *)&RD_min_Q25[ 0 ], RD_min_v_Q25 );
+                _mm_storeu_si128( (__m128i *)(void *)&RD_max_Q25[ 0 ], RD_max_v_Q25 );
+                _mm_storeu_si128( (__m128i *)(void *)&RD_Q25[ 0 ], RD_lo_Q25 );
+                _mm_storeu_si128( (__m128i *)(void *)&RD_Q25[ NLSF_QUANT_DEL_DEC_STATES ], RD_hi_Q25 );
+                _mm_storeu_si128( (__m128i *)(void *)&prev_out_Q10[ 0 ], prev_out_lo_Q10 );
+                _mm_storeu_si128( (__m128i *)(void *)&prev_out_Q10[ NLSF_QUANT_DEL_DEC_STATES ], prev_out_hi_Q10 );
+                for( j = 0; j < NLSF_QUANT_DEL_DEC_STATES; j++ ) {
+                    ind[ j ][ i ] = (opus_int8)ind_Q0[ j ];
+                }
+
+                /* compare the highest RD values of the winning half with the lowest one in the losing half, and copy if necessary */
+                /* afterwards ind_sort[] will contain the indices of the NLSF_QUANT_DEL_DEC_STATES winning RD values */
+                while( 1 ) {
+                    min_max_Q25 = silk_int32_MAX;
+                    max_min_Q25 = 0;
+                    ind_min_max = 0;
+                    ind_max_min = 0;
+                    for( j = 0; j < NLSF_QUANT_DEL_DEC_STATES; j++ ) {
+                        if( min_max_Q25 > RD_max_Q25[ j ] ) {
+                            min_max_Q25 = RD_max_Q25[ j ];
+                            ind_min_max = j;
+                        }
+                        if( max_min_Q25 < RD_min_Q25[ j ] ) {
+                            max_min_Q25 = RD_min_Q25[ j ];
+                            ind_max_min = j;
+                        }
+                    }
+                    if( min_max_Q25 >= max_min_Q25 ) {
+                        break;
+                    }
+                    /* copy ind_min_max to ind_max_min */
+                    ind_sort[     ind_max_min ] = ind_sort[     ind_min_max ] ^ NLSF_QUANT_DEL_DEC_STATES;
+                    RD_Q25[       ind_max_min ] = RD_Q25[       ind_min_max + NLSF_QUANT_DEL_DEC_STATES ];
+                    prev_out_Q10[ ind_max_min ] = prev_out_Q10[ ind_min_max + NLSF_QUANT_DEL_DEC_STATES ];
+                    RD_min_Q25[   ind_max_min ] = 0;
+                    RD_max_Q25[   ind_min_max ] = silk_int32_MAX;
+                    silk_memcpy( ind[ ind_max_min ], ind[ ind_min_max ], MAX_LPC_ORDER * sizeof( opus_int8 ) );
+                }
+                /* increment index if it comes from the upper half */
+                for( j = 0; j < NLSF_QUANT_DEL_DEC_STATES; j++ ) {
+                    ind[ j ][ i ] += silk_RSHIFT( ind_sort[ j ], NLSF_QUANT_DEL_DEC_STATES_LOG2 );
+                }
+                RD_lo_Q25       = _mm_loadu_si128( (__m128i *)(void *)&RD_Q25[ 0 ] );
+                prev_out_lo_Q10 = _mm_loadu_si128( (__m128i *)(void *)&prev_out_Q10[ 0 ] );
+            }
+        }
+    }
+    _mm_storeu_si128( (__m128i *)(void *)&RD_Q25[ 0 ], RD_lo_Q25 );
+    _mm_storeu_si128( (__m128i *)(void *)&RD_Q25[ NLSF_QUANT_DEL_DEC_STATES ], RD_hi_Q25 );
+
+    /* last sample: find winner, copy indices and return RD value */
+    ind_tmp = 0;
+    min_Q25 = silk_int32_MAX;
+    for( j = 0; j < 2 * NLSF_QUANT_DEL_DEC_STATES; j++ ) {
+        if( min_Q25 > RD_Q25[ j ] ) {
+            min_Q25 = RD_Q25[ j ];
+            ind_tmp = j;
+        }
+    }
+    for( j = 0; j < order; j++ ) {
+        indices[ j ] = ind[ ind_tmp & ( NLSF_QUANT_DEL_DEC_STATES - 1 ) ][ j ];
+        silk_assert( indices[ j ] >= -NLSF_QUANT_MAX_AMPLITUDE_EXT );
+        silk_assert( indices[ j ] <=  NLSF_QUANT_MAX_AMPLITUDE_EXT );
+    }
+    indices[ 0 ] += silk_RSHIFT( ind_tmp, NLSF_QUANT_DEL_DEC_STATES_LOG2 );
+    silk_assert( indices[ 0 ] <= NLSF_QUANT_MAX_AMPLITUDE_EXT );
+    silk_assert( min_Q25 >= 0 );
+    return min_Q25;
+}
@@ -41,6 +41,17 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "NSQ.h"
 #include "celt/x86/x86cpu.h"
 
+/* This file is also compiled by NSQ_del_dec_avx512.c with
+   SILK_NSQ_DEL_DEC_AVX512 defined. That variant keeps the warped noise
+   shaping recursion in 64-bit lanes (AVX-512VL has the arithmetic 64-bit
+   shift AVX2 lacks, so no cross-lane permute is needed per tap) and
+   permutes the survivor states four vectors at a time. */
+#ifdef SILK_NSQ_DEL_DEC_AVX512
+# define SILK_NSQ_DEL_DEC_FN silk_NSQ_del_dec_avx512
+#else
+# define SILK_NSQ_DEL_DEC_FN silk_NSQ_del_dec_avx2
+#endif
+
 /* Returns TRUE if all assumptions met */
 static OPUS_INLINE int verify_assumptions(const silk_encoder_state *psEncC)
 {
@@ -275,6 +286,32 @@ static opus_int32 silk_select_winner(__m128i num, __m128i selector)
     return _mm_cvtsi128_si32(_mm_shuffle_epi8(num, selector));
 }
 
+/* Applies the same state permutation to n consecutive state vectors */
+static OPUS_INLINE void silk_mm_shuffle_states(__m128i *v, int n, __m128i selector)
+{
+    int t = 0;
+#ifdef SILK_NSQ_DEL_DEC_AVX512
+    __m512i selector4 = _mm512_broadcast_i32x4(selector);
+    for (; t + 4 <= n; t += 4)
+    {
+        _mm512_storeu_si512((void *)&v[t], _mm512_shuffle_epi8(_mm512_loadu_si512((const void *)&v[t]), selector4));
+    }
+#endif
+    for (; t < n; t++)
+    {
+        v[t] = _mm_shuffle_epi8(v[t], selector);
+    }
+}
+
+#ifdef SILK_NSQ_DEL_DEC_AVX512
+/* (a * (opus_int16)b) >> 16 for 32-bit values held in 64-bit lanes; only the
+   low 32 bits of the result are meaningful, like the 32-bit C arithmetic */
+static OPUS_INLINE __m256i silk_mm256_smulwb_epi64(__m256i a, __m256i b)
+{
+    return _mm256_srai_epi64(_mm256_mul_epi32(a, b), 16);
+}
+#endif
+
 typedef struct
 {
     __m128i RandState;
@@ -358,7 +395,7 @@ static OPUS_INLINE void silk_noise_shape_quantizer_del_dec_avx2(
     opus_int decisionDelay                      /* I                                       */
 );
 
-void silk_NSQ_del_dec_avx2(
+void SILK_NSQ_DEL_DEC_FN(
     const silk_encoder_state *psEncC,                            /* I    Encoder State               */
     silk_nsq_state *NSQ,                                         /* I/O  NSQ state                   */
     SideInfoIndices *psIndices,                                  /* I/O  Quantization Indices        */
@@ -734,6 +771,29 @@ static OPUS_INLINE void silk_noise_shape_quantizer_del_dec_avx2(
         /* Noise shape feedback */
         silk_assert(shapingLPCOrder > 0);
         silk_assert((shapingLPCOrder & 1) == 0); /* check that order is even */
+#ifdef SILK_NSQ_DEL_DEC_AVX512
+        {
+            /* Same recursion in 64-bit lanes; wrap-around only affects the
+               discarded high halves, so the low 32 bits match exactly */
+            __m256i warping = _mm256_set1_epi64x((opus_int16)warping_Q16);
+            __m256i acc, s0, s1;
+            s0 = _mm256_add_epi64(_mm256_cvtepi32_epi64(psDelDec->Diff_Q14),
+                                  silk_mm256_smulwb_epi64(_mm256_cvtepi32_epi64(psDelDec->sAR2_Q14[0]), warping));
+            acc = _mm256_set1_epi64x(shapingLPCOrder >> 1);
+            for (j = 0; j < shapingLPCOrder - 1; j++)
+            {
+                /* Output of allpass section */
+                s1 = _mm256_cvtepi32_epi64(psDelDec->sAR2_Q14[j]);
+                psDelDec->sAR2_Q14[j] = _mm256_cvtepi64_epi32(s0);
+                acc = _mm256_add_epi64(acc, silk_mm256_smulwb_epi64(s0, _mm256_set1_epi64x(AR_shp_Q13[j])));
+                s0 = _mm256_add_epi64(s1, silk_mm256_smulwb_epi64(
+                    _mm256_sub_epi64(_mm256_cvtepi32_epi64(psDelDec->sAR2_Q14[j + 1]), s0), warping));
+            }
+            psDelDec->sAR2_Q14[shapingLPCOrder - 1] = _mm256_cvtepi64_epi32(s0);
+            acc = _mm256_add_epi64(acc, silk_mm256_smulwb_epi64(s0, _mm256_set1_epi64x(AR_shp_Q13[shapingLPCOrder - 1])));
+            n_AR_Q14 = _mm256_cvtepi64_epi32(acc);
+        }
+#else
         /* Output of lowpass section */
         tmp0 = _mm_add_epi32(psDelDec->Diff_Q14, silk_mm_smulwb_epi32(psDelDec->sAR2_Q14[0], warping_Q16));
         n_AR_Q14 = _mm_set1_epi32(shapingLPCOrder >> 1);
@@ -747,6 +807,7 @@ static OPUS_INLINE void silk_noise_shape_quantizer_del_dec_avx2(
         }
         psDelDec->sAR2_Q14[shapingLPCOrder - 1] = tmp0;
         n_AR_Q14 = _mm_add_epi32(n_AR_Q14, silk_mm_smulwb_epi32(tmp0, AR_shp_Q13[shapingLPCOrder - 1]));
+#endif
 
         n_AR_Q14 = _mm_slli_epi32(n_AR_Q14, 1);                                                  /* Q11 -> Q12 */
         n_AR_Q14 = _mm_add_epi32(n_AR_Q14, silk_mm_smulwb_epi32(psDelDec->LF_AR_Q14, Tilt_Q14)); /* Q12 */
@@ -855,7 +916,6 @@ static OPUS_INLINE void silk_noise_shape_quantizer_del_dec_avx2(
         tmp0 = _mm_cmplt_epi32(RDmin_Q10, RDmax_Q10);
         if (!_mm_test_all_zeros(tmp0, tmp0))
         {
-            int t;
             RDmax_ind = silk_index_of_first_equal_epi32(RDmax_Q10, _mm256_extracti128_si256(SS_RD_Q10, 0));
             RDmin_ind = silk_index_of_first_equal_epi32(RDmin_Q10, _mm256_extracti128_si256(SS_RD_Q10, 1));
             tmp1 = _mm_cvtepi8_epi32(_mm_cvtsi32_si128(0xFFU << (unsigned)(RDmax_ind << 3)));
@@ -863,24 +923,12 @@ static OPUS_INLINE void silk_noise_shape_quantizer_del_dec_avx2(
                 _mm_set_epi8(0xF, 0xE, 0xD, 0xC, 0xB, 0xA, 0x9, 0x8, 0x7, 0x6, 0x5, 0x4, 0x3, 0x2, 0x1, 0x0),
                 silk_index_to_selector(RDmin_ind),
                 tmp1);
-            for (t = i; t < MAX_SUB_FRAME_LENGTH + NSQ_LPC_BUF_LENGTH; t++)
-            {
-                psDelDec->sLPC_Q14[t] = _mm_shuffle_epi8(psDelDec->sLPC_Q14[t], tmp0);
-            }
+            silk_mm_shuffle_states(&psDelDec->sLPC_Q14[i], MAX_SUB_FRAME_LENGTH + NSQ_LPC_BUF_LENGTH - i, tmp0);
             psDelDec->Seed = _mm_shuffle_epi8(psDelDec->Seed, tmp0);
             psDelDec->SeedInit = _mm_shuffle_epi8(psDelDec->SeedInit, tmp0);
-            for (t = 0; t < MAX_SHAPE_LPC_ORDER; t++)
-            {
-                psDelDec->sAR2_Q14[t] = _mm_shuffle_epi8(psDelDec->sAR2_Q14[t], tmp0);
-            }
-            for (t = 0; t < DECISION_DELAY; t++)
-            {
-                psDelDec->Samples[t].RandState = _mm_shuffle_epi8(psDelDec->Samples[t].RandState, tmp0);
-                psDelDec->Samples[t].Q_Q10 = _mm_shuffle_epi8(psDelDec->Samples[t].Q_Q10, tmp0);
-                psDelDec->Samples[t].Xq_Q14 = _mm_shuffle_epi8(psDelDec->Samples[t].Xq_Q14, tmp0);
-                psDelDec->Samples[t].Pred_Q15 = _mm_shuffle_epi8(psDelDec->Samples[t].Pred_Q15, tmp0);
-                psDelDec->Samples[t].Shape_Q14 = _mm_shuffle_epi8(psDelDec->Samples[t].Shape_Q14, tmp0);
-            }
+            silk_mm_shuffle_states(psDelDec->sAR2_Q14, MAX_SHAPE_LPC_ORDER, tmp0);
+            /* Every field of the sample structs is a state vector */
+            silk_mm_shuffle_states((__m128i *)(void *)psDelDec->Samples, DECISION_DELAY * (sizeof(NSQ_del_dec_sample_struct) / sizeof(__m128i)), tmp0);
             mask = _mm256_castsi128_si256(_mm_blendv_epi8(_mm_set_epi32(0x3, 0x2, 0x1, 0x0), _mm_set1_epi32(RDmin_ind + 4), tmp1));
             SS_Q_Q10 = _mm256_permutevar8x32_epi32(SS_Q_Q10, mask);
             SS_RD_Q10 = _mm256_permutevar8x32_epi32(SS_RD_Q10, mask);
@@ -70,6 +70,39 @@ extern void (*const SILK_BURG_MODIFIED_IMPL[OPUS_ARCHMASK + 1])(
 
 #  endif
 
+void silk_P_Ana_calc_corr_nrg_st2_sse4_1(
+    opus_int32                  xcorr[],            /* O    Cross-correlations, one per lag                             */
+    opus_int32                  energy[],           /* O    Energies of the lagged vectors, one per lag                 */
+    const opus_int16            target[],           /* I    Target vector, preceded by at least max(lags) samples       */
+    const opus_int16            lags[],             /* I    Lags to evaluate                                            */
+    const opus_int              nb_lags,            /* I    Number of lags                                              */
+    const opus_int              len,                /* I    Vector length                                               */
+    int                         arch                /* I    Run-time architecture                                       */
+);
+
+#  if defined(OPUS_X86_PRESUME_SSE4_1)
+
+#   define OVERRIDE_silk_P_Ana_calc_corr_nrg_st2
+#   define silk_P_Ana_calc_corr_nrg_st2(xcorr, energy, target, lags, nb_lags, len, arch) \
+       ((void)(arch), silk_P_Ana_calc_corr_nrg_st2_sse4_1(xcorr, energy, target, lags, nb_lags, len, arch))
+
+#  elif defined(OPUS_HAVE_RTCD)
+
+extern void (*const SILK_P_ANA_CALC_CORR_NRG_ST2_IMPL[OPUS_ARCHMASK + 1])(
+    opus_int32                  xcorr[],            /* O    Cross-correlations, one per lag                             */
+    opus_int32                  energy[],           /* O    Energies of the lagged vectors, one per lag                 */
+    const opus_int16            target[],           /* I    Target vector, preceded by at least max(lags) samples       */
+    const opus_int16            lags[],             /* I    Lags to evaluate                                            */
+    const opus_int              nb_lags,            /* I    Number of lags                                              */
+    const opus_int              len,                /* I    Vector length                                               */
+    int                         arch                /* I    Run-time architecture                                       */);
+
+#   define OVERRIDE_silk_P_Ana_calc_corr_nrg_st2
+#   define silk_P_Ana_calc_corr_nrg_st2(xcorr, energy, target, lags, nb_lags, len, arch) \
+     ((*SILK_P_ANA_CALC_CORR_NRG_ST2_IMPL[(arch) & OPUS_ARCHMASK])(xcorr, energy, target, lags, nb_lags, len, arch))
+
+#  endif
+
 opus_int64 silk_inner_prod16_sse4_1(
     const opus_int16 *inVec1,
     const opus_int16 *inVec2,
@@ -82,6 +82,76 @@ extern void (*const SILK_VQ_WMAT_EC_IMPL[OPUS_ARCHMASK + 1])(
 
 #  endif
 
+void silk_NLSF_VQ_sse4_1(
+    opus_int32                  err_Q24[],                      /* O    Quantization errors [K]                     */
+    const opus_int16            in_Q15[],                       /* I    Input vectors to be quantized [LPC_order]   */
+    const opus_uint8            pCB_Q8[],                       /* I    Codebook vectors [K*LPC_order]              */
+    const opus_int16            pWght_Q9[],                     /* I    Codebook weights [K*LPC_order]              */
+    const opus_int              K,                              /* I    Number of codebook vectors                  */
+    const opus_int              LPC_order                       /* I    Number of LPCs                              */
+);
+
+opus_int32 silk_NLSF_del_dec_quant_sse4_1(                      /* O    Returns RD value in Q25                     */
+    opus_int8                   indices[],                      /* O    Quantization indices [ order ]              */
+    const opus_int16            x_Q10[],                        /* I    Input [ order ]                             */
+    const opus_int16            w_Q5[],                         /* I    Weights [ order ]                           */
+    const opus_uint8            pred_coef_Q8[],                 /* I    Backward predictor coefs [ order ]          */
+    const opus_int16            ec_ix[],                        /* I    Indices to entropy coding tables [ order ]  */
+    const opus_uint8            ec_rates_Q5[],                  /* I    Rates []                                    */
+    const opus_int              quant_step_size_Q16,            /* I    Quantization step size                      */
+    const opus_int16            inv_quant_step_size_Q6,         /* I    Inverse quantization step size              */
+    const opus_int32            mu_Q20,                         /* I    R/D tradeoff                                */
+    const opus_int16            order                           /* I    Number of input values                      */
+);
+
+#  if defined OPUS_X86_PRESUME_SSE4_1
+
+#   define OVERRIDE_silk_NLSF_VQ
+#   define silk_NLSF_VQ(err_Q24, in_Q15, pCB_Q8, pWght_Q9, K, LPC_order, arch) \
+    ((void)(arch),silk_NLSF_VQ_sse4_1(err_Q24, in_Q15, pCB_Q8, pWght_Q9, K, LPC_order))
+
+#   define OVERRIDE_silk_NLSF_del_dec_quant
+#   define silk_NLSF_del_dec_quant(indices, x_Q10, w_Q5, pred_coef_Q8, ec_ix, ec_rates_Q5, quant_step_size_Q16, \
+                                   inv_quant_step_size_Q6, mu_Q20, order, arch) \
+    ((void)(arch),silk_NLSF_del_dec_quant_sse4_1(indices, x_Q10, w_Q5, pred_coef_Q8, ec_ix, ec_rates_Q5, \
+                                   quant_step_size_Q16, inv_quant_step_size_Q6, mu_Q20, order))
+
+#  elif defined(OPUS_HAVE_RTCD)
+
+extern void (*const SILK_NLSF_VQ_IMPL[OPUS_ARCHMASK + 1])(
+    opus_int32                  err_Q24[],                      /* O    Quantization errors [K]                     */
+    const opus_int16            in_Q15[],                       /* I    Input vectors to be quantized [LPC_order]   */
+    const opus_uint8            pCB_Q8[],                       /* I    Codebook vectors [K*LPC_order]              */
+    const opus_int16            pWght_Q9[],                     /* I    Codebook weights [K*LPC_order]              */
+    const opus_int              K,                              /* I    Number of codebook vectors                  */
+    const opus_int              LPC_order                       /* I    Number of LPCs                              */
+);
+
+#   define OVERRIDE_silk_NLSF_VQ
+#   define silk_NLSF_VQ(err_Q24, in_Q15, pCB_Q8, pWght_Q9, K, LPC_order, arch) \
+    ((*SILK_NLSF_VQ_IMPL[(arch) & OPUS_ARCHMASK])(err_Q24, in_Q15, pCB_Q8, pWght_Q9, K, LPC_order))
+
+extern opus_int32 (*const SILK_NLSF_DEL_DEC_QUANT_IMPL[OPUS_ARCHMASK + 1])(
+    opus_int8                   indices[],                      /* O    Quantization indices [ order ]              */
+    const opus_int16            x_Q10[],                        /* I    Input [ order ]                             */
+    const opus_int16            w_Q5[],                         /* I    Weights [ order ]                           */
+    const opus_uint8            pred_coef_Q8[],                 /* I    Backward predictor coefs [ order ]          */
+    const opus_int16            ec_ix[],                        /* I    Indices to entropy coding tables [ order ]  */
+    const opus_uint8            ec_rates_Q5[],                  /* I    Rates []                                    */
+    const opus_int              quant_step_size_Q16,            /* I    Quantization step size                      */
+    const opus_int16            inv_quant_step_size_Q6,         /* I    Inverse quantization step size              */
+    const opus_int32            mu_Q20,                         /* I    R/D tradeoff                                */
+    const opus_int16            order                           /* I    Number of input values                      */
+);
+
+#   define OVERRIDE_silk_NLSF_del_dec_quant
+#   define silk_NLSF_del_dec_quant(indices, x_Q10, w_Q5, pred_coef_Q8, ec_ix, ec_rates_Q5, quant_step_size_Q16, \
+                                   inv_quant_step_size_Q6, mu_Q20, order, arch) \
+    ((*SILK_NLSF_DEL_DEC_QUANT_IMPL[(arch) & OPUS_ARCHMASK])(indices, x_Q10, w_Q5, pred_coef_Q8, ec_ix, ec_rates_Q5, \
+                                   quant_step_size_Q16, inv_quant_step_size_Q6, mu_Q20, order))
+
+#  endif
+
 void silk_NSQ_sse4_1(
     const silk_encoder_state    *psEncC,                                      /* I    Encoder State                   */
     silk_nsq_state              *NSQ,                                         /* I/O  NSQ state                       */
@@ -172,6 +242,24 @@ void silk_NSQ_del_dec_avx2(
     const opus_int LTP_scale_Q14                                 /* I    LTP state scaling           */
 );
 
+void silk_NSQ_del_dec_avx512(
+    const silk_encoder_state *psEncC,                            /* I    Encoder State               */
+    silk_nsq_state *NSQ,                                         /* I/O  NSQ state                   */
+    SideInfoIndices *psIndices,                                  /* I/O  Quantization Indices        */
+    const opus_int16 x16[],                                      /* I    Input                       */
+    opus_int8 pulses[],                                          /* O    Quantized pulse signal      */
+    const opus_int16 *PredCoef_Q12,                              /* I    Short term prediction coefs */
+    const opus_int16 LTPCoef_Q14[LTP_ORDER * MAX_NB_SUBFR],      /* I    Long term prediction coefs  */
+    const opus_int16 AR_Q13[MAX_NB_SUBFR * MAX_SHAPE_LPC_ORDER], /* I    Noise shaping coefs         */
+    const opus_int HarmShapeGain_Q14[MAX_NB_SUBFR],              /* I    Long term shaping coefs     */
+    const opus_int Tilt_Q14[MAX_NB_SUBFR],                       /* I    Spectral tilt               */
+    const opus_int32 LF_shp_Q14[MAX_NB_SUBFR],                   /* I    Low frequency shaping coefs */
+    const opus_int32 Gains_Q16[MAX_NB_SUBFR],                    /* I    Quantization step sizes     */
+    const opus_int32 pitchL[MAX_NB_SUBFR],                       /* I    Pitch lags                  */
+    const opus_int Lambda_Q10,                                   /* I    Rate/distortion tradeoff    */
+    const opus_int LTP_scale_Q14                                 /* I    LTP state scaling           */
+);
+
 #  if defined (OPUS_X86_PRESUME_AVX2)
 
 #   define OVERRIDE_silk_NSQ_del_dec
@@ -292,6 +380,128 @@ extern double (*const SILK_INNER_PRODUCT_FLP_IMPL[OPUS_ARCHMASK + 1])(
 
 #define silk_inner_product_FLP(data1, data2, dataSize, arch) ((void)arch,(*SILK_INNER_PRODUCT_FLP_IMPL[(arch) & OPUS_ARCHMASK])(data1, data2, dataSize))
 
+#endif
+
+void silk_P_Ana_calc_corr_nrg_st2_FLP_avx2(
+    double              xcorr[],            /* O    Cross-correlations, one per lag                             */
+    double              energy[],           /* O    Energies of the lagged vectors, one per lag                 */
+    const silk_float    target[],           /* I    Target vector, preceded by at least max(lags) samples       */
+    const opus_int16    lags[],             /* I    Lags to evaluate                                            */
+    const opus_int      nb_lags,            /* I    Number of lags                                              */
+    const opus_int      len,                /* I    Vector length                                               */
+    int                 arch                /* I    Run-time architecture                                       */
+);
+
+#if defined (OPUS_X86_PRESUME_AVX2)
+
+#define OVERRIDE_silk_P_Ana_calc_corr_nrg_st2_FLP
+#define silk_P_Ana_calc_corr_nrg_st2_FLP(xcorr, energy, target, lags, nb_lags, len, arch) \
+    ((void)arch,silk_P_Ana_calc_corr_nrg_st2_FLP_avx2(xcorr, energy, target, lags, nb_lags, len, arch))
+
+#elif defined(OPUS_HAVE_RTCD) && defined(OPUS_X86_MAY_HAVE_AVX2)
+
+#define OVERRIDE_silk_P_Ana_calc_corr_nrg_st2_FLP
+extern void (*const SILK_P_ANA_CALC_CORR_NRG_ST2_FLP_IMPL[OPUS_ARCHMASK + 1])(
+    double              xcorr[],            /* O    Cross-correlations, one per lag                             */
+    double              energy[],           /* O    Energies of the lagged vectors, one per lag                 */
+    const silk_float    target[],           /* I    Target vector, preceded by at least max(lags) samples       */
+    const opus_int16    lags[],             /* I    Lags to evaluate                                            */
+    const opus_int      nb_lags,            /* I    Number of lags                                              */
+    const opus_int      len,                /* I    Vector length                                               */
+    int                 arch                /* I    Run-time architecture                                       */
+);
+
+#define silk_P_Ana_calc_corr_nrg_st2_FLP(xcorr, energy, target, lags, nb_lags, len, arch) \
+    ((*SILK_P_ANA_CALC_CORR_NRG_ST2_FLP_IMPL[(arch) & OPUS_ARCHMASK])(xcorr, energy, target, lags, nb_lags, len, arch))
+
+#endif
+
+silk_float silk_burg_modified_FLP_avx2(
+    silk_float          A[],                /* O    prediction coefficients (length order)                      */
+    const silk_float    x[],                /* I    input signal, length: nb_subfr*(D+L_sub)                    */
+    const silk_float    minInvGain,         /* I    minimum inverse prediction gain                             */
+    const opus_int      subfr_length,       /* I    input signal subframe length (incl. D preceding samples)    */
+    const opus_int      nb_subfr,           /* I    number of subframes stacked in x                            */
+    const opus_int      D,                  /* I    order                                                       */
+    int                 arch
+);
+
+void silk_warped_autocorrelation_FLP_avx2(
+    silk_float                      *corr,                              /* O    Result [order + 1]                          */
+    const silk_float                *input,                             /* I    Input data to correlate                     */
+    const silk_float                warping,                            /* I    Warping coefficient                         */
+    const opus_int                  length,                             /* I    Length of input                             */
+    const opus_int                  order                               /* I    Correlation order (even)                    */
+);
+
+void silk_LTP_analysis_filter_FLP_avx2(
+    silk_float                      *LTP_res,                           /* O    LTP res MAX_NB_SUBFR*(pre_lgth+subfr_lngth) */
+    const silk_float                *x,                                 /* I    Input signal, with preceding samples        */
+    const silk_float                B[ LTP_ORDER * MAX_NB_SUBFR ],      /* I    LTP coefficients for each subframe          */
+    const opus_int                  pitchL[   MAX_NB_SUBFR ],           /* I    Pitch lags                                  */
+    const silk_float                invGains[ MAX_NB_SUBFR ],           /* I    Inverse quantization gains                  */
+    const opus_int                  subfr_length,                       /* I    Length of each subframe                     */
+    const opus_int                  nb_subfr,                           /* I    number of subframes                         */
+    const opus_int                  pre_length                          /* I    Preceding samples for each subframe         */
+);
+
+#if defined (OPUS_X86_PRESUME_AVX2)
+
+#define OVERRIDE_silk_burg_modified_FLP
+#define silk_burg_modified_FLP(A, x, minInvGain, subfr_length, nb_subfr, D, arch) \
+    ((void)(arch), silk_burg_modified_FLP_avx2(A, x, minInvGain, subfr_length, nb_subfr, D, arch))
+
+#define OVERRIDE_silk_warped_autocorrelation_FLP
+#define silk_warped_autocorrelation_FLP(corr, input, warping, length, order, arch) \
+    ((void)(arch), silk_warped_autocorrelation_FLP_avx2(corr, input, warping, length, order))
+
+#define OVERRIDE_silk_LTP_analysis_filter_FLP
+#define silk_LTP_analysis_filter_FLP(LTP_res, x, B, pitchL, invGains, subfr_length, nb_subfr, pre_length, arch) \
+    ((void)(arch), silk_LTP_analysis_filter_FLP_avx2(LTP_res, x, B, pitchL, invGains, subfr_length, nb_subfr, pre_length))
+
+#elif defined(OPUS_HAVE_RTCD) && defined(OPUS_X86_MAY_HAVE_AVX2)
+
+#define OVERRIDE_silk_burg_modified_FLP
+extern silk_float (*const SILK_BURG_MODIFIED_FLP_IMPL[OPUS_ARCHMASK + 1])(
+    silk_float          A[],                /* O    prediction coefficients (length order)                      */
+    const silk_float    x[],                /* I    input signal, length: nb_subfr*(D+L_sub)                    */
+    const silk_float    minInvGain,         /* I    minimum inverse prediction gain                             */
+    const opus_int      subfr_length,       /* I    input signal subframe length (incl. D preceding samples)    */
+    const opus_int      nb_subfr,           /* I    number of subframes stacked in x                            */
+    const opus_int      D,                  /* I    order                                                       */
+    int                 arch
+);
+
+#define silk_burg_modified_FLP(A, x, minInvGain, subfr_length, nb_subfr, D, arch) \
+    ((*SILK_BURG_MODIFIED_FLP_IMPL[(arch) & OPUS_ARCHMASK])(A, x, minInvGain, subfr_length, nb_subfr, D, arch))
+
+#define OVERRIDE_silk_warped_autocorrelation_FLP
+extern void (*const SILK_WARPED_AUTOCORRELATION_FLP_IMPL[OPUS_ARCHMASK + 1])(
+    silk_float                      *corr,                              /* O    Result [order + 1]                          */
+    const silk_float                *input,                             /* I    Input data to correlate                     */
+    const silk_float                warping,                            /* I    Warping coefficient                         */
+    const opus_int                  length,                             /* I    Length of input                             */
+    const opus_int                  order                               /* I    Correlation order (even)                    */
+);
+
+#define silk_warped_autocorrelation_FLP(corr, input, warping, length, order, arch) \
+    ((*SILK_WARPED_AUTOCORRELATION_FLP_IMPL[(arch) & OPUS_ARCHMASK])(corr, input, warping, length, order))
+
+#define OVERRIDE_silk_LTP_analysis_filter_FLP
+extern void (*const SILK_LTP_ANALYSIS_FILTER_FLP_IMPL[OPUS_ARCHMASK + 1])(
+    silk_float                      *LTP_res,                           /* O    LTP res MAX_NB_SUBFR*(pre_lgth+subfr_lngth) */
+    const silk_float                *x,                                 /* I    Input signal, with preceding samples        */
+    const silk_float                B[ LTP_ORDER * MAX_NB_SUBFR ],      /* I    LTP coefficients for each subframe          */
+    const opus_int                  pitchL[   MAX_NB_SUBFR ],           /* I    Pitch lags                                  */
+    const silk_float                invGains[ MAX_NB_SUBFR ],           /* I    Inverse quantization gains                  */
+    const opus_int                  subfr_length,                       /* I    Length of each subframe                     */
+    const opus_int                  nb_subfr,                           /* I    number of subframes                         */
+    const opus_int                  pre_length                          /* I    Preceding samples for each subframe         */
+);
+
+#define silk_LTP_analysis_filter_FLP(LTP_res, x, B, pitchL, invGains, subfr_length, nb_subfr, pre_length, arch) \
+    ((*SILK_LTP_ANALYSIS_FILTER_FLP_IMPL[(arch) & OPUS_ARCHMASK])(LTP_res, x, B, pitchL, invGains, subfr_length, nb_subfr, pre_length))
+
 #endif
 #endif
 
@@ -34,6 +34,7 @@
 #include "SigProc_FIX.h"
 #ifndef FIXED_POINT
 #include "SigProc_FLP.h"
+#include "main_FLP.h"
 #endif
 #include "pitch.h"
 #include "main.h"
@@ -53,7 +54,8 @@ opus_int64 (*const SILK_INNER_PROD16_IMPL[ OPUS_ARCHMASK + 1 ] )(
   silk_inner_prod16_c,
   silk_inner_prod16_c,
   MAY_HAVE_SSE4_1( silk_inner_prod16 ), /* sse4.1 */
-  MAY_HAVE_SSE4_1( silk_inner_prod16 )  /* avx */
+  MAY_HAVE_SSE4_1( silk_inner_prod16 ), /* avx */
+  MAY_HAVE_SSE4_1( silk_inner_prod16 )  /* avx512 */
 };
 
 #endif
@@ -66,7 +68,8 @@ opus_int (*const SILK_VAD_GETSA_Q8_IMPL[ OPUS_ARCHMASK + 1 ] )(
   silk_VAD_GetSA_Q8_c,
   silk_VAD_GetSA_Q8_c,
   MAY_HAVE_SSE4_1( silk_VAD_GetSA_Q8 ), /* sse4.1 */
-  MAY_HAVE_SSE4_1( silk_VAD_GetSA_Q8 )  /* avx */
+  MAY_HAVE_SSE4_1( silk_VAD_GetSA_Q8 ), /* avx */
+  MAY_HAVE_SSE4_1( silk_VAD_GetSA_Q8 )  /* avx512 */
 };
 
 void (*const SILK_NSQ_IMPL[ OPUS_ARCHMASK + 1 ] )(
@@ -90,7 +93,8 @@ void (*const SILK_NSQ_IMPL[ OPUS_ARCHMASK + 1 ] )(
   silk_NSQ_c,
   silk_NSQ_c,
   MAY_HAVE_SSE4_1( silk_NSQ ), /* sse4.1 */
-  MAY_HAVE_SSE4_1( silk_NSQ )  /* avx */
+  MAY_HAVE_SSE4_1( silk_NSQ ), /* avx */
+  MAY_HAVE_SSE4_1( silk_NSQ )  /* avx512 */
 };
 
 void (*const SILK_VQ_WMAT_EC_IMPL[ OPUS_ARCHMASK + 1 ] )(
@@ -111,7 +115,44 @@ void (*const SILK_VQ_WMAT_EC_IMPL[ OPUS_ARCHMASK + 1 ] )(
   silk_VQ_WMat_EC_c,
   silk_VQ_WMat_EC_c,
   MAY_HAVE_SSE4_1( silk_VQ_WMat_EC ), /* sse4.1 */
-  MAY_HAVE_SSE4_1( silk_VQ_WMat_EC )  /* avx */
+  MAY_HAVE_SSE4_1( silk_VQ_WMat_EC ), /* avx */
+  MAY_HAVE_SSE4_1( silk_VQ_WMat_EC )  /* avx512 */
+};
+
+void (*const SILK_NLSF_VQ_IMPL[ OPUS_ARCHMASK + 1 ] )(
+    opus_int32                  err_Q24[],                      /* O    Quantization errors [K]                     */
+    const opus_int16            in_Q15[],                       /* I    Input vectors to be quantized [LPC_order]   */
+    const opus_uint8            pCB_Q8[],                       /* I    Codebook vectors [K*LPC_order]              */
+    const opus_int16            pWght_Q9[],                     /* I    Codebook weights [K*LPC_order]              */
+    const opus_int              K,                              /* I    Number of codebook vectors                  */
+    const opus_int              LPC_order                       /* I    Number of LPCs                              */
+) = {
+  silk_NLSF_VQ_c,                  /* non-sse */
+  silk_NLSF_VQ_c,
+  silk_NLSF_VQ_c,
+  MAY_HAVE_SSE4_1( silk_NLSF_VQ ), /* sse4.1 */
+  MAY_HAVE_SSE4_1( silk_NLSF_VQ ), /* avx */
+  MAY_HAVE_SSE4_1( silk_NLSF_VQ )  /* avx512 */
+};
+
+opus_int32 (*const SILK_NLSF_DEL_DEC_QUANT_IMPL[ OPUS_ARCHMASK + 1 ] )(
+    opus_int8                   indices[],                      /* O    Quantization indices [ order ]              */
+    const opus_int16            x_Q10[],                        /* I    Input [ order ]                             */
+    const opus_int16            w_Q5[],                         /* I    Weights [ order ]                           */
+    const opus_uint8            pred_coef_Q8[],                 /* I    Backward predictor coefs [ order ]          */
+    const opus_int16            ec_ix[],                        /* I    Indices to entropy coding tables [ order ]  */
+    const opus_uint8            ec_rates_Q5[],                  /* I    Rates []                                    */
+    const opus_int              quant_step_size_Q16,            /* I    Quantization step size                      */
+    const opus_int16            inv_quant_step_size_Q6,         /* I    Inverse quantization step size              */
+    const opus_int32            mu_Q20,                         /* I    R/D tradeoff                                */
+    const opus_int16            order                           /* I    Number of input values                      */
+) = {
+  silk_NLSF_del_dec_quant_c,                  /* non-sse */
+  silk_NLSF_del_dec_quant_c,
+  silk_NLSF_del_dec_quant_c,
+  MAY_HAVE_SSE4_1( silk_NLSF_del_dec_quant ), /* sse4.1 */
+  MAY_HAVE_SSE4_1( silk_NLSF_del_dec_quant ), /* avx */
+  MAY_HAVE_SSE4_1( silk_NLSF_del_dec_quant )  /* avx512 */
 };
 
 void (*const SILK_NSQ_DEL_DEC_IMPL[ OPUS_ARCHMASK + 1 ] )(
@@ -135,7 +176,8 @@ void (*const SILK_NSQ_DEL_DEC_IMPL[ OPUS_ARCHMASK + 1 ] )(
   silk_NSQ_del_dec_c,
   silk_NSQ_del_dec_c,
   MAY_HAVE_SSE4_1( silk_NSQ_del_dec ), /* sse4.1 */
-  MAY_HAVE_AVX2( silk_NSQ_del_dec )  /* avx */
+  MAY_HAVE_AVX2( silk_NSQ_del_dec ), /* avx */
+  MAY_HAVE_AVX512( silk_NSQ_del_dec )  /* avx512 */
 };
 
 #if defined(FIXED_POINT)
@@ -155,7 +197,25 @@ void (*const SILK_BURG_MODIFIED_IMPL[ OPUS_ARCHMASK + 1 ] )(
   silk_burg_modified_c,
   silk_burg_modified_c,
   MAY_HAVE_SSE4_1( silk_burg_modified ), /* sse4.1 */
-  MAY_HAVE_SSE4_1( silk_burg_modified )  /* avx */
+  MAY_HAVE_SSE4_1( silk_burg_modified ), /* avx */
+  MAY_HAVE_SSE4_1( silk_burg_modified )  /* avx512 */
+};
+
+void (*const SILK_P_ANA_CALC_CORR_NRG_ST2_IMPL[ OPUS_ARCHMASK + 1 ] )(
+    opus_int32                  xcorr[],            /* O    Cross-correlations, one per lag                             */
+    opus_int32                  energy[],           /* O    Energies of the lagged vectors, one per lag                 */
+    const opus_int16            target[],           /* I    Target vector, preceded by at least max(lags) samples       */
+    const opus_int16            lags[],             /* I    Lags to evaluate                                            */
+    const opus_int              nb_lags,            /* I    Number of lags                                              */
+    const opus_int              len,                /* I    Vector length                                               */
+    int                         arch                /* I    Run-time architecture                                       */
+) = {
+  silk_P_Ana_calc_corr_nrg_st2_c,                  /* non-sse */
+  silk_P_Ana_calc_corr_nrg_st2_c,
+  silk_P_Ana_calc_corr_nrg_st2_c,
+  MAY_HAVE_SSE4_1( silk_P_Ana_calc_corr_nrg_st2 ), /* sse4.1 */
+  MAY_HAVE_SSE4_1( silk_P_Ana_calc_corr_nrg_st2 ), /* avx */
+  MAY_HAVE_SSE4_1( silk_P_Ana_calc_corr_nrg_st2 )  /* avx512 */
 };
 
 #endif
@@ -171,7 +231,78 @@ double (*const SILK_INNER_PRODUCT_FLP_IMPL[ OPUS_ARCHMASK + 1 ] )(
   silk_inner_product_FLP_c,
   silk_inner_product_FLP_c,
   silk_inner_product_FLP_c, /* sse4.1 */
-  MAY_HAVE_AVX2( silk_inner_product_FLP )  /* avx */
+  MAY_HAVE_AVX2( silk_inner_product_FLP ), /* avx */
+  MAY_HAVE_AVX2( silk_inner_product_FLP )  /* avx512 */
+};
+
+void (*const SILK_P_ANA_CALC_CORR_NRG_ST2_FLP_IMPL[ OPUS_ARCHMASK + 1 ] )(
+    double              xcorr[],            /* O    Cross-correlations, one per lag                             */
+    double              energy[],           /* O    Energies of the lagged vectors, one per lag                 */
+    const silk_float    target[],           /* I    Target vector, preceded by at least max(lags) samples       */
+    const opus_int16    lags[],             /* I    Lags to evaluate                                            */
+    const opus_int      nb_lags,            /* I    Number of lags                                              */
+    const opus_int      len,                /* I    Vector length                                               */
+    int                 arch                /* I    Run-time architecture                                       */
+) = {
+  silk_P_Ana_calc_corr_nrg_st2_FLP_c,                  /* non-sse */
+  silk_P_Ana_calc_corr_nrg_st2_FLP_c,
+  silk_P_Ana_calc_corr_nrg_st2_FLP_c,
+  silk_P_Ana_calc_corr_nrg_st2_FLP_c, /* sse4.1 */
+  MAY_HAVE_AVX2( silk_P_Ana_calc_corr_nrg_st2_FLP ), /* avx */
+  MAY_HAVE_AVX2( silk_P_Ana_calc_corr_nrg_st2_FLP )  /* avx512 */
+};
+
+silk_float (*const SILK_BURG_MODIFIED_FLP_IMPL[ OPUS_ARCHMASK + 1 ] )(
+    silk_float          A[],                /* O    prediction coefficients (length order)                      */
+    const silk_float    x[],                /* I    input signal, length: nb_subfr*(D+L_sub)                    */
+    const silk_float    minInvGain,         /* I    minimum inverse prediction gain                             */
+    const opus_int      subfr_length,       /* I    input signal subframe length (incl. D preceding samples)    */
+    const opus_int      nb_subfr,           /* I    number of subframes stacked in x                            */
+    const opus_int      D,                  /* I    order                                                       */
+    int                 arch
+
+) = {
+  silk_burg_modified_FLP_c,                  /* non-sse */
+  silk_burg_modified_FLP_c,
+  silk_burg_modified_FLP_c,
+  silk_burg_modified_FLP_c, /* sse4.1 */
+  MAY_HAVE_AVX2( silk_burg_modified_FLP ), /* avx */
+  MAY_HAVE_AVX2( silk_burg_modified_FLP )  /* avx512 */
+};
+
+void (*const SILK_WARPED_AUTOCORRELATION_FLP_IMPL[ OPUS_ARCHMASK + 1 ] )(
+    silk_float                      *corr,                              /* O    Result [order + 1]                          */
+    const silk_float                *input,                             /* I    Input data to correlate                     */
+    const silk_float                warping,                            /* I    Warping coefficient                         */
+    const opus_int                  length,                             /* I    Length of input                             */
+    const opus_int                  order                               /* I    Correlation order (even)                    */
+
+) = {
+  silk_warped_autocorrelation_FLP_c,                  /* non-sse */
+  silk_warped_autocorrelation_FLP_c,
+  silk_warped_autocorrelation_FLP_c,
+  silk_warped_autocorrelation_FLP_c, /* sse4.1 */
+  MAY_HAVE_AVX2( silk_warped_autocorrelation_FLP ), /* avx */
+  MAY_HAVE_AVX2( silk_warped_autocorrelation_FLP )  /* avx512 */
+};
+
+void (*const SILK_LTP_ANALYSIS_FILTER_FLP_IMPL[ OPUS_ARCHMASK + 1 ] )(
+    silk_float                      *LTP_res,                           /* O    LTP res MAX_NB_SUBFR*(pre_lgth+subfr_lngth) */
+    const silk_float                *x,                                 /* I    Input signal, with preceding samples        */
+    const silk_float                B[ LTP_ORDER * MAX_NB_SUBFR ],      /* I    LTP coefficients for each subframe          */
+    const opus_int                  pitchL[   MAX_NB_SUBFR ],           /* I    Pitch lags                                  */
+    const silk_float                invGains[ MAX_NB_SUBFR ],           /* I    Inverse quantization gains                  */
+    const opus_int                  subfr_length,                       /* I    Length of each subframe                     */
+    const opus_int                  nb_subfr,                           /* I    number of subframes                         */
+    const opus_int                  pre_length                          /* I    Preceding samples for each subframe         */
+
+) = {
+  silk_LTP_analysis_filter_FLP_c,                  /* non-sse */
+  silk_LTP_analysis_filter_FLP_c,
+  silk_LTP_analysis_filter_FLP_c,
+  silk_LTP_analysis_filter_FLP_c, /* sse4.1 */
+  MAY_HAVE_AVX2( silk_LTP_analysis_filter_FLP ), /* avx */
+  MAY_HAVE_AVX2( silk_LTP_analysis_filter_FLP )  /* avx512 */
 };
 
 #endif
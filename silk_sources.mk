@@ -83,12 +83,17 @@ silk/x86/x86_silk_map.c
 SILK_SOURCES_SSE4_1 = \
 silk/x86/NSQ_sse4_1.c \
 silk/x86/NSQ_del_dec_sse4_1.c \
+silk/x86/NLSF_VQ_sse4_1.c \
+silk/x86/NLSF_del_dec_quant_sse4_1.c \
 silk/x86/VAD_sse4_1.c \
 silk/x86/VQ_WMat_EC_sse4_1.c
 
 SILK_SOURCES_AVX2 =  \
 silk/x86/NSQ_del_dec_avx2.c
 
+SILK_SOURCES_AVX512 = \
+silk/x86/NSQ_del_dec_avx512.c
+
 SILK_SOURCES_ARM_RTCD = \
 silk/arm/arm_silk_map.c
 
@@ -125,7 +130,8 @@ silk/fixed/schur_FIX.c
 
 SILK_SOURCES_FIXED_SSE4_1 = \
 silk/fixed/x86/vector_ops_FIX_sse4_1.c \
-silk/fixed/x86/burg_modified_FIX_sse4_1.c
+silk/fixed/x86/burg_modified_FIX_sse4_1.c \
+silk/fixed/x86/pitch_analysis_core_FIX_sse4_1.c
 
 SILK_SOURCES_FIXED_ARM_NEON_INTR = \
 silk/fixed/arm/warped_autocorrelation_FIX_neon_intr.c
@@ -161,4 +167,8 @@ silk/float/schur_FLP.c \
 silk/float/sort_FLP.c
 
 SILK_SOURCES_FLOAT_AVX2 = \
-silk/float/x86/inner_product_FLP_avx2.c
\ No newline at end of file
+silk/float/x86/inner_product_FLP_avx2.c \
+silk/float/x86/pitch_analysis_core_FLP_avx2.c \
+silk/float/x86/burg_modified_FLP_avx2.c \
+silk/float/x86/LTP_analysis_filter_FLP_avx2.c \
+silk/float/x86/warped_autocorrelation_FLP_avx2.c
@@ -214,10 +214,10 @@ static opus_val32 downmix_and_resample(downmix_func downmix, const void *_x, opu
    return ret;
 }
 
-void tonality_analysis_init(TonalityAnalysisState *tonal, opus_int32 Fs)
+void tonality_analysis_init(TonalityAnalysisState *tonal, opus_int32 Fs, int arch)
 {
   /* Initialize reusable fields. */
-  tonal->arch = opus_select_arch();
+  tonal->arch = arch;
   tonal->Fs = Fs;
   /* Clear remaining fields. */
   tonality_analysis_reset(tonal);
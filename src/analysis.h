@@ -86,7 +86,7 @@ typedef struct {
  * not be repeated every analysis step. No allocated memory is retained
  * by the state struct, so no cleanup call is required.
  */
-void tonality_analysis_init(TonalityAnalysisState *analysis, opus_int32 Fs);
+void tonality_analysis_init(TonalityAnalysisState *analysis, opus_int32 Fs, int arch);
 
 /** Reset a TonalityAnalysisState stuct.
  *
@@ -29,8 +29,125 @@
 #include "config.h"
 #endif
 
+#include <time.h>
+#if defined(_WIN32)
+# define WIN32_LEAN_AND_MEAN
+# include <windows.h>
+#endif
+#if defined(_MSC_VER) && !defined(__GNUC__)
+#include <intrin.h>
+#endif
 #include "opus.h"
 #include "opus_private.h"
+#include "os_support.h"
+
+double opus_wall_time(void)
+{
+#if defined(_WIN32)
+   LARGE_INTEGER count, freq;
+   if (QueryPerformanceCounter(&count) && QueryPerformanceFrequency(&freq))
+      return (double)count.QuadPart/freq.QuadPart;
+#elif defined(CLOCK_MONOTONIC)
+   struct timespec ts;
+   if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0)
+      return ts.tv_sec + 1e-9*ts.tv_nsec;
+#endif
+   /* Last resort, which only counts the time this process runs. */
+   return (double)clock()/CLOCKS_PER_SEC;
+}
+
+/* Length of the window over which the time spent is added up */
+#define CPU_BUDGET_WINDOW_US 100000
+
+#if defined(__GNUC__)
+#define cpu_atomic_add(x, v) __sync_add_and_fetch((x), (v))
+#define cpu_atomic_cas(x, old, new_val) __sync_bool_compare_and_swap((x), (old), (new_val))
+#elif defined(_MSC_VER)
+#define cpu_atomic_add(x, v) (_InterlockedExchangeAdd((volatile long*)(x), (v)) + (v))
+#define cpu_atomic_cas(x, old, new_val) (_InterlockedCompareExchange((volatile long*)(x), (new_val), (old)) == (old))
+#else
+/* Without atomics, users sharing a budget across threads can lose an update
+   now and then, which only makes the load estimate noisier. */
+static opus_int32 cpu_atomic_add(volatile opus_int32 *x, opus_int32 v)
+{
+   *x += v;
+   return *x;
+}
+static int cpu_atomic_cas(volatile opus_int32 *x, opus_int32 old, opus_int32 new_val)
+{
+   if (*x != old)
+      return 0;
+   *x = new_val;
+   return 1;
+}
+#endif
+
+int opus_cpu_budget_get_size(void)
+{
+   return sizeof(OpusCPUBudget);
+}
+
+int opus_cpu_budget_init(OpusCPUBudget *budget, opus_int32 target_us)
+{
+   if (target_us <= 0)
+      return OPUS_BAD_ARG;
+   OPUS_CLEAR((char*)budget, sizeof(*budget));
+   budget->target = target_us;
+   budget->clock = opus_wall_time;
+   return OPUS_OK;
+}
+
+OpusCPUBudget *opus_cpu_budget_create(opus_int32 target_us, int *error)
+{
+   int ret;
+   OpusCPUBudget *budget;
+   budget = (OpusCPUBudget *)opus_alloc(opus_cpu_budget_get_size());
+   if (budget == NULL)
+   {
+      if (error)
+         *error = OPUS_ALLOC_FAIL;
+      return NULL;
+   }
+   ret = opus_cpu_budget_init(budget, target_us);
+   if (error)
+      *error = ret;
+   if (ret != OPUS_OK)
+   {
+      opus_free(budget);
+      budget = NULL;
+   }
+   return budget;
+}
+
+void opus_cpu_budget_destroy(OpusCPUBudget *budget)
+{
+   opus_free(budget);
+}
+
+void opus_cpu_budget_set_clock(OpusCPUBudget *budget, double (*clock)(void))
+{
+   budget->clock = clock;
+}
+
+opus_int32 opus_cpu_budget_update(OpusCPUBudget *budget, double spent, double now)
+{
+   opus_int32 now_us, window_start, window;
+   if (spent > 0)
+      cpu_atomic_add(&budget->spent, (opus_int32)(.5 + 1e6*spent));
+   now_us = (opus_int32)((opus_int64)(1e6*now) & 0x7fffffff);
+   window_start = budget->window_start;
+   window = (now_us - window_start) & 0x7fffffff;
+   /* The first user to see the window expire turns what was spent into a load and
+      starts the next window. Whatever other users add meanwhile counts in the next one. */
+   if (window >= CPU_BUDGET_WINDOW_US && cpu_atomic_cas(&budget->window_start, window_start, now_us))
+   {
+      opus_int32 total;
+      total = cpu_atomic_add(&budget->spent, 0);
+      cpu_atomic_add(&budget->spent, -total);
+      budget->load = (opus_int32)((opus_int64)total*20000/window);
+   }
+   return budget->load;
+}
 
 #ifndef DISABLE_FLOAT_API
 OPUS_EXPORT void opus_pcm_soft_clip(float *_x, int N, int C, float *declip_mem)
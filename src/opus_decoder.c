@@ -61,15 +61,29 @@
 #include "osce.h"
 #endif
 
+/* DNN governor levels: each one disables one more piece of neural processing. */
+#define DNN_GOVERNOR_NO_NOLACE   1
+#define DNN_GOVERNOR_NO_OSCE     2
+#define DNN_GOVERNOR_NO_DEEP_PLC 3
+
 struct OpusDecoder {
    int          celt_dec_offset;
    int          silk_dec_offset;
+#ifdef SCRATCH_ARENA
+   int          scratch_offset;
+#endif
+#ifdef OPUS_SCRATCH_STATS
+   opus_scratch_stats scratch_stats;
+#endif
    int          channels;
    opus_int32   Fs;          /** Sampling rate (at the API level) */
    silk_DecControlStruct DecControl;
    int          decode_gain;
    int          complexity;
    int          arch;
+   OpusCPUBudget *dnn_budget;
+   int          dnn_level;
+   int          dnn_hold;
 #ifdef ENABLE_DEEP_PLC
     LPCNetPLCState lpcnet;
 #endif
@@ -123,6 +137,9 @@ int opus_decoder_get_size(int channels)
       return 0;
    silkDecSizeBytes = align(silkDecSizeBytes);
    celtDecSizeBytes = celt_decoder_get_size(channels);
+#ifdef SCRATCH_ARENA
+   celtDecSizeBytes = align(celtDecSizeBytes)+OPUS_DECODER_SCRATCH_SIZE;
+#endif
    return align(sizeof(OpusDecoder))+silkDecSizeBytes+celtDecSizeBytes;
 }
 
@@ -145,6 +162,9 @@ int opus_decoder_init(OpusDecoder *st, opus_int32 Fs, int channels)
    silkDecSizeBytes = align(silkDecSizeBytes);
    st->silk_dec_offset = align(sizeof(OpusDecoder));
    st->celt_dec_offset = st->silk_dec_offset+silkDecSizeBytes;
+#ifdef SCRATCH_ARENA
+   st->scratch_offset = st->celt_dec_offset+align(celt_decoder_get_size(channels));
+#endif
    silk_dec = (char*)st+st->silk_dec_offset;
    celt_dec = (CELTDecoder*)((char*)st+st->celt_dec_offset);
    st->stream_channels = st->channels = channels;
@@ -153,13 +173,14 @@ int opus_decoder_init(OpusDecoder *st, opus_int32 Fs, int channels)
    st->Fs = Fs;
    st->DecControl.API_sampleRate = st->Fs;
    st->DecControl.nChannelsAPI      = st->channels;
+   st->arch = opus_select_arch();
 
    /* Reset decoder */
-   ret = silk_InitDecoder( silk_dec );
+   ret = silk_InitDecoder( silk_dec, st->arch );
    if(ret)return OPUS_INTERNAL_ERROR;
 
    /* Initialize CELT decoder */
-   ret = celt_decoder_init(celt_dec, Fs, channels);
+   ret = celt_decoder_init(celt_dec, Fs, channels, st->arch);
    if(ret!=OPUS_OK)return OPUS_INTERNAL_ERROR;
 
    celt_decoder_ctl(celt_dec, CELT_SET_SIGNALLING(0));
@@ -169,10 +190,16 @@ int opus_decoder_init(OpusDecoder *st, opus_int32 Fs, int channels)
 #ifdef ENABLE_DEEP_PLC
     lpcnet_plc_init( &st->lpcnet);
 #endif
-   st->arch = opus_select_arch();
    return OPUS_OK;
 }
 
+#ifdef SCRATCH_ARENA
+char *opus_decoder_get_scratch(OpusDecoder *st)
+{
+   return (char*)st+st->scratch_offset;
+}
+#endif
+
 OpusDecoder *opus_decoder_create(opus_int32 Fs, int channels, int *error)
 {
    int ret;
@@ -234,7 +261,13 @@ static int opus_packet_get_mode(const unsigned char *data)
    return mode;
 }
 
-static int opus_decode_frame(OpusDecoder *st, const unsigned char *data,
+/* CELT only runs its deep PLC at complexity 5 and above. */
+static int celt_complexity(const OpusDecoder *st)
+{
+   return st->dnn_level >= DNN_GOVERNOR_NO_DEEP_PLC ? IMIN(st->complexity, 4) : st->complexity;
+}
+
+static int opus_decode_frame_impl(OpusDecoder *st, const unsigned char *data,
       opus_int32 len, opus_val16 *pcm, int frame_size, int decode_fec)
 {
    void *silk_dec;
@@ -265,7 +298,7 @@ static int opus_decode_frame(OpusDecoder *st, const unsigned char *data,
    const opus_val16 *window;
    opus_uint32 redundant_rng = 0;
    int celt_accum;
-   ALLOC_STACK;
+   ALLOC_STACK_ARENA((char*)st+st->scratch_offset, OPUS_DECODER_SCRATCH_SIZE, &st->scratch_stats);
 
    silk_dec = (char*)st+st->silk_dec_offset;
    celt_dec = (CELTDecoder*)((char*)st+st->celt_dec_offset);
@@ -313,7 +346,7 @@ static int opus_decode_frame(OpusDecoder *st, const unsigned char *data,
       if (audiosize > F20)
       {
          do {
-            int ret = opus_decode_frame(st, NULL, 0, pcm, IMIN(audiosize, F20), 0);
+            int ret = opus_decode_frame_impl(st, NULL, 0, pcm, IMIN(audiosize, F20), 0);
             if (ret<0)
             {
                RESTORE_STACK;
@@ -359,7 +392,7 @@ static int opus_decode_frame(OpusDecoder *st, const unsigned char *data,
    if (transition && mode == MODE_CELT_ONLY)
    {
       pcm_transition = pcm_transition_celt;
-      opus_decode_frame(st, NULL, 0, pcm_transition, IMIN(F5, audiosize), 0);
+      opus_decode_frame_impl(st, NULL, 0, pcm_transition, IMIN(F5, audiosize), 0);
    }
    if (audiosize > frame_size)
    {
@@ -411,14 +444,14 @@ static int opus_decode_frame(OpusDecoder *st, const unsigned char *data,
            st->DecControl.internalSampleRate = 16000;
         }
      }
-     st->DecControl.enable_deep_plc = st->complexity >= 5;
+     st->DecControl.enable_deep_plc = st->complexity >= 5 && st->dnn_level < DNN_GOVERNOR_NO_DEEP_PLC;
 #ifdef ENABLE_OSCE
      st->DecControl.osce_method = OSCE_METHOD_NONE;
 #ifndef DISABLE_LACE
-     if (st->complexity >= 6) {st->DecControl.osce_method = OSCE_METHOD_LACE;}
+     if (st->complexity >= 6 && st->dnn_level < DNN_GOVERNOR_NO_OSCE) {st->DecControl.osce_method = OSCE_METHOD_LACE;}
 #endif
 #ifndef DISABLE_NOLACE
-     if (st->complexity >= 7) {st->DecControl.osce_method = OSCE_METHOD_NOLACE;}
+     if (st->complexity >= 7 && st->dnn_level < DNN_GOVERNOR_NO_NOLACE) {st->DecControl.osce_method = OSCE_METHOD_NOLACE;}
 #endif
 #endif
 
@@ -493,7 +526,7 @@ static int opus_decode_frame(OpusDecoder *st, const unsigned char *data,
    if (transition && mode != MODE_CELT_ONLY)
    {
       pcm_transition = pcm_transition_silk;
-      opus_decode_frame(st, NULL, 0, pcm_transition, IMIN(F5, audiosize), 0);
+      opus_decode_frame_impl(st, NULL, 0, pcm_transition, IMIN(F5, audiosize), 0);
    }
 
 
@@ -667,7 +700,61 @@ static int opus_decode_frame(OpusDecoder *st, const unsigned char *data,
 
 }
 
-int opus_decode_native(OpusDecoder *st, const unsigned char *data,
+#ifdef ENABLE_DEEP_PLC
+/* Adds the time the neural processing (deep PLC and OSCE) took on this frame to the
+   budget and steps the DNN level so that all the decoders sharing it stay within its
+   target. */
+static void dnn_governor_update(OpusDecoder *st, int frame_size)
+{
+   OpusCPUBudget *budget;
+   opus_int32 load;
+   int level;
+   budget = st->dnn_budget;
+   load = opus_cpu_budget_update(budget, st->lpcnet.dnn_time, budget->clock());
+   st->lpcnet.dnn_time = 0;
+   st->dnn_hold -= frame_size;
+   if (st->dnn_hold > 0)
+      return;
+   level = st->dnn_level;
+   if (load > budget->target && level < DNN_GOVERNOR_NO_DEEP_PLC)
+   {
+      level++;
+      /* Give the load a full window to reflect the new level before stepping down again. */
+      st->dnn_hold = st->Fs/5;
+   } else if (load < .5f*budget->target && level > 0)
+   {
+      level--;
+      /* Be slow to step back up to avoid oscillating around the budget. */
+      st->dnn_hold = 2*st->Fs;
+   }
+   if (level != st->dnn_level)
+   {
+      CELTDecoder *celt_dec = (CELTDecoder*)((char*)st+st->celt_dec_offset);
+      st->dnn_level = level;
+      celt_decoder_ctl(celt_dec, OPUS_SET_COMPLEXITY(celt_complexity(st)));
+   }
+}
+#endif
+
+static int opus_decode_frame(OpusDecoder *st, const unsigned char *data,
+      opus_int32 len, opus_val16 *pcm, int frame_size, int decode_fec)
+{
+#ifdef ENABLE_DEEP_PLC
+   if (st->dnn_budget != NULL)
+   {
+      int ret;
+      /* Only the neural processing is timed, not the rest of the decoding. */
+      st->lpcnet.dnn_clock = st->dnn_budget->clock;
+      ret = opus_decode_frame_impl(st, data, len, pcm, frame_size, decode_fec);
+      if (ret > 0)
+         dnn_governor_update(st, ret);
+      return ret;
+   }
+#endif
+   return opus_decode_frame_impl(st, data, len, pcm, frame_size, decode_fec);
+}
+
+static int opus_decode_native_impl(OpusDecoder *st, const unsigned char *data,
       opus_int32 len, opus_val16 *pcm, int frame_size, int decode_fec,
       int self_delimited, opus_int32 *packet_offset, int soft_clip, const OpusDRED *dred, opus_int32 dred_offset)
 {
@@ -695,6 +782,8 @@ int opus_decode_native(OpusDecoder *st, const unsigned char *data,
       init_frames = (st->lpcnet.blend == 0) ? 2 : 0;
       features_per_frame = IMAX(1, frame_size/F10);
       needed_feature_frames = init_frames + features_per_frame;
+      /* A call spanning more than the FEC queue conceals the remainder. */
+      needed_feature_frames = IMIN(needed_feature_frames, PLC_MAX_FEC);
       lpcnet_plc_fec_clear(&st->lpcnet);
       for (i=0;i<needed_feature_frames;i++) {
          int feature_offset;
@@ -810,6 +899,84 @@ int opus_decode_native(OpusDecoder *st, const unsigned char *data,
    return nb_samples;
 }
 
+int opus_decode_native(OpusDecoder *st, const unsigned char *data,
+      opus_int32 len, opus_val16 *pcm, int frame_size, int decode_fec,
+      int self_delimited, opus_int32 *packet_offset, int soft_clip, const OpusDRED *dred, opus_int32 dred_offset)
+{
+   int ret;
+   /* Makes the arena current for all the frames of the packet, so that the
+      usage reported covers the whole call. */
+   ALLOC_STACK_ARENA((char*)st+st->scratch_offset, OPUS_DECODER_SCRATCH_SIZE, &st->scratch_stats);
+   ret = opus_decode_native_impl(st, data, len, pcm, frame_size, decode_fec,
+         self_delimited, packet_offset, soft_clip, dred, dred_offset);
+   RESTORE_STACK;
+   return ret;
+}
+
+#if !defined(FIXED_POINT) || !defined(DISABLE_FLOAT_API) || defined(ENABLE_DRED)
+/* Decodes through a temporary buffer and converts to the other sample format
+   (float to 16-bit, or 16-bit to float in fixed-point builds). A packet holds
+   at most 120 ms, but PLC, FEC and DRED requests can be arbitrarily long, so
+   the buffer only covers 120 ms and longer requests are decoded in pieces.
+   All pieces but the last are concealed (or recovered from DRED); the last
+   one carries the FEC. */
+static int opus_decode_convert(OpusDecoder *st, const unsigned char *data,
+      opus_int32 len, void *pcm, int frame_size, int decode_fec, int soft_clip,
+      const OpusDRED *dred, opus_int32 dred_offset)
+{
+   VARDECL(opus_val16, out);
+   int max_chunk;
+   int count;
+   int i;
+   ALLOC_STACK_ARENA((char*)st+st->scratch_offset, OPUS_DECODER_SCRATCH_SIZE, &st->scratch_stats);
+
+   if (data != NULL && len > 0 && !decode_fec)
+   {
+      int nb_samples;
+      nb_samples = opus_decoder_get_nb_samples(st, data, len);
+      if (nb_samples<=0)
+      {
+         RESTORE_STACK;
+         return OPUS_INVALID_PACKET;
+      }
+      frame_size = IMIN(frame_size, nb_samples);
+   }
+   celt_assert(st->channels == 1 || st->channels == 2);
+   max_chunk = st->Fs/25*3;
+   ALLOC(out, IMIN(frame_size, max_chunk)*st->channels, opus_val16);
+   count = 0;
+   do {
+      int chunk;
+      int last;
+      int ret;
+      chunk = frame_size-count;
+      if (chunk > max_chunk)
+         chunk = decode_fec ? IMIN(max_chunk, chunk-max_chunk) : max_chunk;
+      last = count+chunk == frame_size;
+      ret = opus_decode_native(st, last ? data : NULL, last ? len : 0, out, chunk,
+            last ? decode_fec : 0, 0, NULL, soft_clip, dred, dred_offset-count);
+      if (ret < 0)
+      {
+         RESTORE_STACK;
+         return ret;
+      }
+      for (i=0;i<ret*st->channels;i++)
+      {
+#ifdef FIXED_POINT
+         ((float*)pcm)[count*st->channels+i] = (1.f/32768.f)*out[i];
+#else
+         ((opus_int16*)pcm)[count*st->channels+i] = FLOAT2INT16(out[i]);
+#endif
+      }
+      count += ret;
+      if (ret < chunk)
+         break;
+   } while (count < frame_size);
+   RESTORE_STACK;
+   return count;
+}
+#endif
+
 #ifdef FIXED_POINT
 
 int opus_decode(OpusDecoder *st, const unsigned char *data,
@@ -824,35 +991,9 @@ int opus_decode(OpusDecoder *st, const unsigned char *data,
 int opus_decode_float(OpusDecoder *st, const unsigned char *data,
       opus_int32 len, float *pcm, int frame_size, int decode_fec)
 {
-   VARDECL(opus_int16, out);
-   int ret, i;
-   int nb_samples;
-   ALLOC_STACK;
-
    if(frame_size<=0)
-   {
-      RESTORE_STACK;
       return OPUS_BAD_ARG;
-   }
-   if (data != NULL && len > 0 && !decode_fec)
-   {
-      nb_samples = opus_decoder_get_nb_samples(st, data, len);
-      if (nb_samples>0)
-         frame_size = IMIN(frame_size, nb_samples);
-      else
-         return OPUS_INVALID_PACKET;
-   }
-   celt_assert(st->channels == 1 || st->channels == 2);
-   ALLOC(out, frame_size*st->channels, opus_int16);
-
-   ret = opus_decode_native(st, data, len, out, frame_size, decode_fec, 0, NULL, 0, NULL, 0);
-   if (ret > 0)
-   {
-      for (i=0;i<ret*st->channels;i++)
-         pcm[i] = (1.f/32768.f)*(out[i]);
-   }
-   RESTORE_STACK;
-   return ret;
+   return opus_decode_convert(st, data, len, pcm, frame_size, decode_fec, 0, NULL, 0);
 }
 #endif
 
@@ -861,36 +1002,9 @@ int opus_decode_float(OpusDecoder *st, const unsigned char *data,
 int opus_decode(OpusDecoder *st, const unsigned char *data,
       opus_int32 len, opus_int16 *pcm, int frame_size, int decode_fec)
 {
-   VARDECL(float, out);
-   int ret, i;
-   int nb_samples;
-   ALLOC_STACK;
-
    if(frame_size<=0)
-   {
-      RESTORE_STACK;
       return OPUS_BAD_ARG;
-   }
-
-   if (data != NULL && len > 0 && !decode_fec)
-   {
-      nb_samples = opus_decoder_get_nb_samples(st, data, len);
-      if (nb_samples>0)
-         frame_size = IMIN(frame_size, nb_samples);
-      else
-         return OPUS_INVALID_PACKET;
-   }
-   celt_assert(st->channels == 1 || st->channels == 2);
-   ALLOC(out, frame_size*st->channels, float);
-
-   ret = opus_decode_native(st, data, len, out, frame_size, decode_fec, 0, NULL, 1, NULL, 0);
-   if (ret > 0)
-   {
-      for (i=0;i<ret*st->channels;i++)
-         pcm[i] = FLOAT2INT16(out[i]);
-   }
-   RESTORE_STACK;
-   return ret;
+   return opus_decode_convert(st, data, len, pcm, frame_size, decode_fec, 1, NULL, 0);
 }
 
 int opus_decode_float(OpusDecoder *st, const unsigned char *data,
@@ -936,7 +1050,7 @@ int opus_decoder_ctl(OpusDecoder *st, int request, ...)
           goto bad_arg;
        }
        st->complexity = value;
-       celt_decoder_ctl(celt_dec, OPUS_SET_COMPLEXITY(value));
+       celt_decoder_ctl(celt_dec, OPUS_SET_COMPLEXITY(celt_complexity(st)));
    }
    break;
    case OPUS_GET_COMPLEXITY_REQUEST:
@@ -949,6 +1063,33 @@ int opus_decoder_ctl(OpusDecoder *st, int request, ...)
        *value = st->complexity;
    }
    break;
+   case OPUS_SET_DNN_CPU_BUDGET_REQUEST:
+   {
+       OpusCPUBudget *value = va_arg(ap, OpusCPUBudget*);
+       st->dnn_budget = value;
+       /* Start over with all the neural processing the complexity allows. */
+       st->dnn_hold = 0;
+#ifdef ENABLE_DEEP_PLC
+       st->lpcnet.dnn_clock = NULL;
+       st->lpcnet.dnn_time = 0;
+#endif
+       if (st->dnn_level != 0)
+       {
+          st->dnn_level = 0;
+          celt_decoder_ctl(celt_dec, OPUS_SET_COMPLEXITY(celt_complexity(st)));
+       }
+   }
+   break;
+   case OPUS_GET_DNN_CPU_BUDGET_REQUEST:
+   {
+       OpusCPUBudget **value = va_arg(ap, OpusCPUBudget**);
+       if (!value)
+       {
+          goto bad_arg;
+       }
+       *value = st->dnn_budget;
+   }
+   break;
    case OPUS_GET_FINAL_RANGE_REQUEST:
    {
       opus_uint32 *value = va_arg(ap, opus_uint32*);
@@ -959,6 +1100,22 @@ int opus_decoder_ctl(OpusDecoder *st, int request, ...)
       *value = st->rangeFinal;
    }
    break;
+   case OPUS_GET_SCRATCH_USAGE_REQUEST:
+   case OPUS_GET_PEAK_SCRATCH_USAGE_REQUEST:
+   {
+      opus_int32 *value = va_arg(ap, opus_int32*);
+      if (!value)
+      {
+         goto bad_arg;
+      }
+#ifdef OPUS_SCRATCH_STATS
+      *value = request == OPUS_GET_SCRATCH_USAGE_REQUEST ?
+            st->scratch_stats.last : st->scratch_stats.peak;
+#else
+      ret = OPUS_UNIMPLEMENTED;
+#endif
+   }
+   break;
    case OPUS_RESET_STATE:
    {
       OPUS_CLEAR((char*)&st->OPUS_DECODER_RESET_START,
@@ -1442,27 +1599,13 @@ int opus_dred_process(OpusDREDDecoder *dred_dec, const OpusDRED *src, OpusDRED *
 int opus_decoder_dred_decode(OpusDecoder *st, const OpusDRED *dred, opus_int32 dred_offset, opus_int16 *pcm, opus_int32 frame_size)
 {
 #ifdef ENABLE_DRED
-   VARDECL(float, out);
-   int ret, i;
-   ALLOC_STACK;
-
    if(frame_size<=0)
-   {
-      RESTORE_STACK;
       return OPUS_BAD_ARG;
-   }
-
-   celt_assert(st->channels == 1 || st->channels == 2);
-   ALLOC(out, frame_size*st->channels, float);
-
-   ret = opus_decode_native(st, NULL, 0, out, frame_size, 0, 0, NULL, 1, dred, dred_offset);
-   if (ret > 0)
-   {
-      for (i=0;i<ret*st->channels;i++)
-         pcm[i] = FLOAT2INT16(out[i]);
-   }
-   RESTORE_STACK;
-   return ret;
+#ifdef FIXED_POINT
+   return opus_decode_native(st, NULL, 0, pcm, frame_size, 0, 0, NULL, 0, dred, dred_offset);
+#else
+   return opus_decode_convert(st, NULL, 0, pcm, frame_size, 0, 1, dred, dred_offset);
+#endif
 #else
    (void)st;
    (void)dred;
@@ -1478,7 +1621,11 @@ int opus_decoder_dred_decode_float(OpusDecoder *st, const OpusDRED *dred, opus_i
 #ifdef ENABLE_DRED
    if(frame_size<=0)
       return OPUS_BAD_ARG;
+#ifdef FIXED_POINT
+   return opus_decode_convert(st, NULL, 0, pcm, frame_size, 0, 0, dred, dred_offset);
+#else
    return opus_decode_native(st, NULL, 0, pcm, frame_size, 0, 0, NULL, 0, dred, dred_offset);
+#endif
 #else
    (void)st;
    (void)dred;
@@ -61,6 +61,13 @@
 
 #define MAX_ENCODER_BUFFER 480
 
+/* Lowest complexity that runs the tonality analysis */
+#ifdef FIXED_POINT
+#define ANALYSIS_MIN_COMPLEXITY 10
+#else
+#define ANALYSIS_MIN_COMPLEXITY 7
+#endif
+
 #ifndef DISABLE_FLOAT_API
 #define PSEUDO_SNR_THRESHOLD 316.23f    /* 10^(25/10) */
 #endif
@@ -74,6 +81,13 @@ typedef struct {
 struct OpusEncoder {
     int          celt_enc_offset;
     int          silk_enc_offset;
+#ifdef SCRATCH_ARENA
+    int          scratch_offset;
+#endif
+#ifdef OPUS_SCRATCH_STATS
+    opus_scratch_stats scratch_stats;
+#endif
+    OpusCPUBudget *cpu_budget;            /* shared with other encoders, NULL when detached */
     silk_EncControlStruct silk_mode;
 #ifdef ENABLE_DRED
     DREDEnc      dred_encoder;
@@ -99,6 +113,11 @@ struct OpusEncoder {
     int          arch;
     int          use_dtx;                 /* general DTX for both SILK and CELT */
     int          fec_config;
+    int          user_complexity;
+    int          cpu_hold;
+#ifdef ENABLE_DRED
+    int          cpu_dred_off;            /* DRED turned off by the CPU budget */
+#endif
 #ifndef DISABLE_FLOAT_API
     TonalityAnalysisState analysis;
 #endif
@@ -196,6 +215,9 @@ int opus_encoder_get_size(int channels)
         return 0;
     silkEncSizeBytes = align(silkEncSizeBytes);
     celtEncSizeBytes = celt_encoder_get_size(channels);
+#ifdef SCRATCH_ARENA
+    celtEncSizeBytes = align(celtEncSizeBytes)+OPUS_ENCODER_SCRATCH_SIZE;
+#endif
     return align(sizeof(OpusEncoder))+silkEncSizeBytes+celtEncSizeBytes;
 }
 
@@ -219,6 +241,9 @@ int opus_encoder_init(OpusEncoder* st, opus_int32 Fs, int channels, int applicat
     silkEncSizeBytes = align(silkEncSizeBytes);
     st->silk_enc_offset = align(sizeof(OpusEncoder));
     st->celt_enc_offset = st->silk_enc_offset+silkEncSizeBytes;
+#ifdef SCRATCH_ARENA
+    st->scratch_offset = st->celt_enc_offset+align(celt_encoder_get_size(channels));
+#endif
     silk_enc = (char*)st+st->silk_enc_offset;
     celt_enc = (CELTEncoder*)((char*)st+st->celt_enc_offset);
 
@@ -255,6 +280,7 @@ int opus_encoder_init(OpusEncoder* st, opus_int32 Fs, int channels, int applicat
 
     celt_encoder_ctl(celt_enc, CELT_SET_SIGNALLING(0));
     celt_encoder_ctl(celt_enc, OPUS_SET_COMPLEXITY(st->silk_mode.complexity));
+    st->user_complexity = st->silk_mode.complexity;
 
 #ifdef ENABLE_DRED
     /* Initialize DRED Encoder */
@@ -289,7 +315,7 @@ int opus_encoder_init(OpusEncoder* st, opus_int32 Fs, int channels, int applicat
     st->bandwidth = OPUS_BANDWIDTH_FULLBAND;
 
 #ifndef DISABLE_FLOAT_API
-    tonality_analysis_init(&st->analysis, st->Fs);
+    tonality_analysis_init(&st->analysis, st->Fs, st->arch);
     st->analysis.application = st->application;
 #endif
 
@@ -539,6 +565,13 @@ static void gain_fade(const opus_val16 *in, opus_val16 *out, opus_val16 g1, opus
     while (++c<channels);
 }
 
+#ifdef SCRATCH_ARENA
+char *opus_encoder_get_scratch(OpusEncoder *st)
+{
+    return (char*)st+st->scratch_offset;
+}
+#endif
+
 OpusEncoder *opus_encoder_create(opus_int32 Fs, int channels, int application, int *error)
 {
    int ret;
@@ -571,6 +604,12 @@ OpusEncoder *opus_encoder_create(opus_int32 Fs, int channels, int application, i
 
 #ifdef ENABLE_DRED
 
+/* DRED is on when the application asked for it, unless the CPU budget has turned it off. */
+static int dred_enabled(const OpusEncoder *st)
+{
+   return st->dred_duration > 0 && !st->cpu_dred_off;
+}
+
 static const float dred_bits_table[16] = {73.2f, 68.1f, 62.5f, 57.0f, 51.5f, 45.7f, 39.9f, 32.4f, 26.4f, 20.4f, 16.3f, 13.f, 9.3f, 8.2f, 7.2f, 6.4f};
 static int estimate_dred_bitrate(int q0, int dQ, int qmax, int duration, opus_int32 target_bits, int *target_chunks) {
    int dred_chunks;
@@ -617,7 +656,7 @@ static opus_int32 compute_dred_bitrate(OpusEncoder *st, opus_int32 bitrate_bps,
    dQ = bitrate_bps-bitrate_offset > 36000 ? 3 : 5;
    qmax = 15;
    target_dred_bitrate = IMAX(0, (int)(dred_frac*(bitrate_bps-bitrate_offset)));
-   if (st->dred_duration > 0) {
+   if (dred_enabled(st)) {
       opus_int32 target_bits = target_dred_bitrate*frame_size/st->Fs;
       max_dred_bits = estimate_dred_bitrate(q0, dQ, qmax, st->dred_duration, target_bits, &target_chunks);
    } else {
@@ -1054,7 +1093,7 @@ static opus_int32 opus_encode_frame_native(OpusEncoder *st, const opus_val16 *pc
                 int redundancy, int celt_to_silk, int prefill,
                 opus_int32 equiv_rate, int to_celt);
 
-opus_int32 opus_encode_native(OpusEncoder *st, const opus_val16 *pcm, int frame_size,
+static opus_int32 opus_encode_native_impl(OpusEncoder *st, const opus_val16 *pcm, int frame_size,
                 unsigned char *data, opus_int32 out_data_bytes, int lsb_depth,
                 const void *analysis_pcm, opus_int32 analysis_size, int c1, int c2,
                 int analysis_channels, downmix_func downmix, int float_api)
@@ -1085,7 +1124,7 @@ opus_int32 opus_encode_native(OpusEncoder *st, const opus_val16 *pcm, int frame_
 #ifdef ENABLE_DRED
     opus_int32 dred_bitrate_bps;
 #endif
-    ALLOC_STACK;
+    ALLOC_STACK_ARENA((char*)st+st->scratch_offset, OPUS_ENCODER_SCRATCH_SIZE, &st->scratch_stats);
 
     max_data_bytes = IMIN(1276, out_data_bytes);
 
@@ -1111,11 +1150,7 @@ opus_int32 opus_encode_native(OpusEncoder *st, const opus_val16 *pcm, int frame_
     celt_encoder_ctl(celt_enc, CELT_GET_MODE(&celt_mode));
 #ifndef DISABLE_FLOAT_API
     analysis_info.valid = 0;
-#ifdef FIXED_POINT
-    if (st->silk_mode.complexity >= 10 && st->Fs>=16000)
-#else
-    if (st->silk_mode.complexity >= 7 && st->Fs>=16000)
-#endif
+    if (st->silk_mode.complexity >= ANALYSIS_MIN_COMPLEXITY && st->Fs>=16000)
     {
        is_silence = is_digital_silence(pcm, frame_size, st->channels, lsb_depth);
        analysis_read_pos_bak = st->analysis.read_pos;
@@ -1695,6 +1730,78 @@ opus_int32 opus_encode_native(OpusEncoder *st, const opus_val16 *pcm, int frame_
     }
 }
 
+/* Adds the time spent on this frame to the budget and adjusts the complexity actually
+   used (never above the one set by the user) so that all the encoders sharing the budget
+   stay within its target. */
+static void update_cpu_budget(OpusEncoder *st, double start, double end, int frame_size)
+{
+    OpusCPUBudget *budget;
+    opus_int32 load;
+    int complexity;
+    budget = st->cpu_budget;
+    load = opus_cpu_budget_update(budget, end - start, end);
+    st->cpu_hold -= frame_size;
+    if (st->cpu_hold > 0)
+       return;
+    complexity = st->silk_mode.complexity;
+    if (load > budget->target)
+    {
+#ifdef ENABLE_DRED
+       /* DRED only codes voice, and below ANALYSIS_MIN_COMPLEXITY nothing tells it where
+          the voice is, so it would compute its latents for nothing. It goes just before
+          that point, after the steps that keep it useful. */
+       if (dred_enabled(st) && complexity <= ANALYSIS_MIN_COMPLEXITY)
+          st->cpu_dred_off = 1;
+       else
+#endif
+       if (complexity > 0)
+          complexity--;
+       else
+          return;
+       /* Give the load a full window to reflect the change before going down again. */
+       st->cpu_hold = st->Fs/5;
+    } else if (load < .7f*budget->target)
+    {
+#ifdef ENABLE_DRED
+       if (st->cpu_dred_off && complexity >= IMIN(st->user_complexity, ANALYSIS_MIN_COMPLEXITY))
+          st->cpu_dred_off = 0;
+       else
+#endif
+       if (complexity < st->user_complexity)
+          complexity++;
+       else
+          return;
+       /* Be slow to go back up to avoid oscillating around the budget. */
+       st->cpu_hold = st->Fs;
+    }
+    if (complexity != st->silk_mode.complexity)
+    {
+       CELTEncoder *celt_enc = (CELTEncoder*)((char*)st+st->celt_enc_offset);
+       st->silk_mode.complexity = complexity;
+       celt_encoder_ctl(celt_enc, OPUS_SET_COMPLEXITY(complexity));
+    }
+}
+
+opus_int32 opus_encode_native(OpusEncoder *st, const opus_val16 *pcm, int frame_size,
+                unsigned char *data, opus_int32 out_data_bytes, int lsb_depth,
+                const void *analysis_pcm, opus_int32 analysis_size, int c1, int c2,
+                int analysis_channels, downmix_func downmix, int float_api)
+{
+    if (st->cpu_budget != NULL)
+    {
+       opus_int32 ret;
+       double start;
+       start = st->cpu_budget->clock();
+       ret = opus_encode_native_impl(st, pcm, frame_size, data, out_data_bytes, lsb_depth,
+             analysis_pcm, analysis_size, c1, c2, analysis_channels, downmix, float_api);
+       if (ret > 0)
+          update_cpu_budget(st, start, st->cpu_budget->clock(), frame_size);
+       return ret;
+    }
+    return opus_encode_native_impl(st, pcm, frame_size, data, out_data_bytes, lsb_depth,
+          analysis_pcm, analysis_size, c1, c2, analysis_channels, downmix, float_api);
+}
+
 static opus_int32 opus_encode_frame_native(OpusEncoder *st, const opus_val16 *pcm, int frame_size,
                 unsigned char *data, opus_int32 max_data_bytes,
                 int float_api, int first_frame,
@@ -1728,6 +1835,9 @@ static opus_int32 opus_encode_frame_native(OpusEncoder *st, const opus_val16 *pc
     int delay_compensation;
     int total_buffer;
     opus_int activity = VAD_NO_DECISION;
+#ifdef ENABLE_DRED
+    int dred_use_silk;
+#endif
     VARDECL(opus_val16, pcm_buf);
     VARDECL(opus_val16, tmp_prefill);
     SAVE_STACK;
@@ -1847,10 +1957,15 @@ static opus_int32 opus_encode_frame_native(OpusEncoder *st, const opus_val16 *pc
 #endif
 
 #ifdef ENABLE_DRED
-    if ( st->dred_duration > 0 && st->dred_encoder.loaded ) {
+    dred_use_silk = 0;
+    if ( dred_enabled(st) && st->dred_encoder.loaded ) {
         int frame_size_400Hz;
-        /* DRED Encoder */
-        dred_compute_latents( &st->dred_encoder, &pcm_buf[total_buffer*st->channels], frame_size, total_buffer, st->arch );
+        /* DRED Encoder. When SILK runs on input above 16 kHz, the latents are only computed
+           after the SILK encoder so we can reuse its internal 16 kHz signal. */
+        if (st->mode != MODE_CELT_ONLY && st->Fs > 16000)
+            dred_use_silk = 1;
+        else
+            dred_compute_latents( &st->dred_encoder, &pcm_buf[total_buffer*st->channels], NULL, frame_size, total_buffer, activity, st->arch );
         frame_size_400Hz = frame_size*400/st->Fs;
         OPUS_MOVE(&st->activity_mem[frame_size_400Hz], st->activity_mem, 4*DRED_MAX_FRAMES-frame_size_400Hz);
         for (i=0;i<frame_size_400Hz;i++)
@@ -1866,12 +1981,18 @@ static opus_int32 opus_encode_frame_native(OpusEncoder *st, const opus_val16 *pc
     if (st->mode != MODE_CELT_ONLY)
     {
         opus_int32 total_bitRate, celt_rate;
+#ifdef ENABLE_DRED
+       VARDECL(opus_int16, dred_silk_16k);
+#endif
 #ifdef FIXED_POINT
        const opus_int16 *pcm_silk;
 #else
        VARDECL(opus_int16, pcm_silk);
        ALLOC(pcm_silk, st->channels*frame_size, opus_int16);
 #endif
+#ifdef ENABLE_DRED
+       ALLOC(dred_silk_16k, dred_use_silk ? frame_size*16000/st->Fs : ALLOC_NONE, opus_int16);
+#endif
 
         /* Distribute bits between SILK and CELT */
         total_bitRate = 8 * bytes_target * frame_rate;
@@ -2030,7 +2151,7 @@ static opus_int32 opus_encode_frame_native(OpusEncoder *st, const opus_val16 *pc
             for (i=0;i<st->encoder_buffer*st->channels;i++)
                 pcm_silk[i] = FLOAT2INT16(st->delay_buffer[i]);
 #endif
-            silk_Encode( silk_enc, &st->silk_mode, pcm_silk, st->encoder_buffer, NULL, &zero, prefill, activity );
+            silk_Encode( silk_enc, &st->silk_mode, pcm_silk, st->encoder_buffer, NULL, &zero, prefill, activity, NULL );
             /* Prevent a second switch in the real encode call. */
             st->silk_mode.opusCanSwitch = 0;
         }
@@ -2041,13 +2162,25 @@ static opus_int32 opus_encode_frame_native(OpusEncoder *st, const opus_val16 *pc
         for (i=0;i<frame_size*st->channels;i++)
             pcm_silk[i] = FLOAT2INT16(pcm_buf[total_buffer*st->channels + i]);
 #endif
-        ret = silk_Encode( silk_enc, &st->silk_mode, pcm_silk, frame_size, &enc, &nBytes, 0, activity );
+#ifdef ENABLE_DRED
+        ret = silk_Encode( silk_enc, &st->silk_mode, pcm_silk, frame_size, &enc, &nBytes, 0, activity, dred_use_silk ? dred_silk_16k : NULL );
+#else
+        ret = silk_Encode( silk_enc, &st->silk_mode, pcm_silk, frame_size, &enc, &nBytes, 0, activity, NULL );
+#endif
         if( ret ) {
             /*fprintf (stderr, "SILK encode error: %d\n", ret);*/
             /* Handle error */
            RESTORE_STACK;
            return OPUS_INTERNAL_ERROR;
         }
+#ifdef ENABLE_DRED
+        if (dred_use_silk)
+        {
+           /* Only SILK running at 16 kHz gives us the signal DRED needs. */
+           dred_compute_latents( &st->dred_encoder, &pcm_buf[total_buffer*st->channels],
+                 st->silk_mode.internalSampleRate == 16000 ? dred_silk_16k : NULL, frame_size, total_buffer, activity, st->arch );
+        }
+#endif
 
         /* Extract SILK internal bandwidth for signaling in first byte */
         if( st->mode == MODE_SILK_ONLY ) {
@@ -2208,7 +2341,7 @@ static opus_int32 opus_encode_frame_native(OpusEncoder *st, const opus_val16 *pc
     } else {
         nb_compr_bytes = (max_data_bytes-1)-redundancy_bytes;
 #ifdef ENABLE_DRED
-        if (st->dred_duration > 0)
+        if (dred_enabled(st))
         {
             int max_celt_bytes;
             opus_int32 dred_bytes = dred_bitrate_bps/(frame_rate*8);
@@ -2273,7 +2406,7 @@ static opus_int32 opus_encode_frame_native(OpusEncoder *st, const opus_val16 *pc
         }
 #ifdef ENABLE_DRED
         /* When Using DRED CBR, we can actually make the CELT part VBR and have DRED pick up the slack. */
-        if (!st->use_vbr && st->dred_duration > 0)
+        if (!st->use_vbr && dred_enabled(st))
         {
             opus_int32 celt_bitrate = st->bitrate_bps;
             celt_encoder_ctl(celt_enc, OPUS_SET_VBR(1));
@@ -2403,7 +2536,7 @@ static opus_int32 opus_encode_frame_native(OpusEncoder *st, const opus_val16 *pc
     ret += 1+redundancy_bytes;
     apply_padding = !st->use_vbr;
 #ifdef ENABLE_DRED
-    if (st->dred_duration > 0 && st->dred_encoder.loaded && first_frame) {
+    if (dred_enabled(st) && st->dred_encoder.loaded && first_frame) {
        opus_extension_data extension;
        unsigned char buf[DRED_MAX_DATA_SIZE];
        int dred_chunks;
@@ -2467,7 +2600,7 @@ opus_int32 opus_encode_float(OpusEncoder *st, const float *pcm, int analysis_fra
    int i, ret;
    int frame_size;
    VARDECL(opus_int16, in);
-   ALLOC_STACK;
+   ALLOC_STACK_ARENA((char*)st+st->scratch_offset, OPUS_ENCODER_SCRATCH_SIZE, &st->scratch_stats);
 
    frame_size = frame_size_select(analysis_frame_size, st->variable_duration, st->Fs);
    if (frame_size <= 0)
@@ -2502,7 +2635,7 @@ opus_int32 opus_encode(OpusEncoder *st, const opus_int16 *pcm, int analysis_fram
    int i, ret;
    int frame_size;
    VARDECL(float, in);
-   ALLOC_STACK;
+   ALLOC_STACK_ARENA((char*)st+st->scratch_offset, OPUS_ENCODER_SCRATCH_SIZE, &st->scratch_stats);
 
    frame_size = frame_size_select(analysis_frame_size, st->variable_duration, st->Fs);
    if (frame_size <= 0)
@@ -2695,6 +2828,7 @@ int opus_encoder_ctl(OpusEncoder *st, int request, ...)
             {
                goto bad_arg;
             }
+            st->user_complexity = value;
             st->silk_mode.complexity = value;
             celt_encoder_ctl(celt_enc, OPUS_SET_COMPLEXITY(value));
         }
@@ -2706,7 +2840,65 @@ int opus_encoder_ctl(OpusEncoder *st, int request, ...)
             {
                goto bad_arg;
             }
-            *value = st->silk_mode.complexity;
+            *value = st->user_complexity;
+        }
+        break;
+        case OPUS_SET_CPU_BUDGET_REQUEST:
+        {
+            OpusCPUBudget *value = va_arg(ap, OpusCPUBudget*);
+            st->cpu_budget = value;
+            /* Start over from the configured settings. */
+            st->cpu_hold = 0;
+#ifdef ENABLE_DRED
+            st->cpu_dred_off = 0;
+#endif
+            if (st->silk_mode.complexity != st->user_complexity)
+            {
+               st->silk_mode.complexity = st->user_complexity;
+               celt_encoder_ctl(celt_enc, OPUS_SET_COMPLEXITY(st->user_complexity));
+            }
+        }
+        break;
+        case OPUS_GET_CPU_BUDGET_REQUEST:
+        {
+            OpusCPUBudget **value = va_arg(ap, OpusCPUBudget**);
+            if (!value)
+            {
+               goto bad_arg;
+            }
+            *value = st->cpu_budget;
+        }
+        break;
+        case OPUS_GET_CPU_BUDGET_STATE_REQUEST:
+        {
+            opus_int32 *complexity = va_arg(ap, opus_int32*);
+            opus_int32 *dred_off = va_arg(ap, opus_int32*);
+            if (!complexity || !dred_off)
+            {
+               goto bad_arg;
+            }
+            *complexity = st->silk_mode.complexity;
+#ifdef ENABLE_DRED
+            *dred_off = st->cpu_dred_off;
+#else
+            *dred_off = 0;
+#endif
+        }
+        break;
+        case OPUS_GET_SCRATCH_USAGE_REQUEST:
+        case OPUS_GET_PEAK_SCRATCH_USAGE_REQUEST:
+        {
+            opus_int32 *value = va_arg(ap, opus_int32*);
+            if (!value)
+            {
+               goto bad_arg;
+            }
+#ifdef OPUS_SCRATCH_STATS
+            *value = request == OPUS_GET_SCRATCH_USAGE_REQUEST ?
+                  st->scratch_stats.last : st->scratch_stats.peak;
+#else
+            ret = OPUS_UNIMPLEMENTED;
+#endif
         }
         break;
         case OPUS_SET_INBAND_FEC_REQUEST:
@@ -2966,6 +3158,26 @@ int opus_encoder_ctl(OpusEncoder *st, int request, ...)
             *value = st->dred_duration;
         }
         break;
+        case OPUS_SET_DRED_ACTIVITY_GATING_REQUEST:
+        {
+            opus_int32 value = va_arg(ap, opus_int32);
+            if(value<0 || value>1)
+            {
+               goto bad_arg;
+            }
+            st->dred_encoder.activity_gating = value;
+        }
+        break;
+        case OPUS_GET_DRED_ACTIVITY_GATING_REQUEST:
+        {
+            opus_int32 *value = va_arg(ap, opus_int32*);
+            if (!value)
+            {
+               goto bad_arg;
+            }
+            *value = st->dred_encoder.activity_gating;
+        }
+        break;
 #endif
         case OPUS_RESET_STATE:
         {
@@ -3087,3 +3299,72 @@ void opus_encoder_destroy(OpusEncoder *st)
 {
     opus_free(st);
 }
+
+/* Byte ranges of OpusEncoder held in a snapshot: everything after the layout,
+   scratch bookkeeping and CPU budget, except the DRED model weights. */
+static const int snapshot_ranges[][2] = {
+#ifdef ENABLE_DRED
+    {offsetof(OpusEncoder, silk_mode), offsetof(OpusEncoder, dred_encoder)},
+    {offsetof(OpusEncoder, dred_encoder)+offsetof(DREDEnc, lpcnet_enc_state), sizeof(OpusEncoder)}
+#else
+    {offsetof(OpusEncoder, silk_mode), sizeof(OpusEncoder)}
+#endif
+};
+#define NB_SNAPSHOT_RANGES ((int)(sizeof(snapshot_ranges)/sizeof(snapshot_ranges[0])))
+
+int opus_encoder_get_snapshot_size(int channels)
+{
+    int i;
+    int silkSnapshotBytes;
+    int size;
+    if (channels<1 || channels > 2)
+        return 0;
+    if (silk_Get_Encoder_Snapshot_Size(channels, &silkSnapshotBytes))
+        return 0;
+    /* The snapshot starts with its own size, as a check on restore. */
+    size = sizeof(opus_int32);
+    for (i=0;i<NB_SNAPSHOT_RANGES;i++)
+        size += snapshot_ranges[i][1]-snapshot_ranges[i][0];
+    return size+silkSnapshotBytes+celt_encoder_get_snapshot_size(channels);
+}
+
+int opus_encoder_snapshot(const OpusEncoder *st, void *snapshot)
+{
+    int i;
+    opus_int32 size;
+    unsigned char *data = (unsigned char*)snapshot;
+    size = opus_encoder_get_snapshot_size(st->channels);
+    OPUS_COPY(data, (unsigned char*)&size, sizeof(size));
+    data += sizeof(size);
+    for (i=0;i<NB_SNAPSHOT_RANGES;i++)
+    {
+        OPUS_COPY(data, (const unsigned char*)st+snapshot_ranges[i][0],
+              snapshot_ranges[i][1]-snapshot_ranges[i][0]);
+        data += snapshot_ranges[i][1]-snapshot_ranges[i][0];
+    }
+    data += silk_SaveEncoder((const char*)st+st->silk_enc_offset, st->channels, data);
+    data += celt_encoder_save((const CELTEncoder*)(const void*)((const char*)st+st->celt_enc_offset), data);
+    celt_assert(data-(unsigned char*)snapshot == size);
+    return OPUS_OK;
+}
+
+int opus_encoder_restore(OpusEncoder *st, const void *snapshot)
+{
+    int i;
+    opus_int32 size;
+    const unsigned char *data = (const unsigned char*)snapshot;
+    OPUS_COPY((unsigned char*)&size, data, sizeof(size));
+    if (size != opus_encoder_get_snapshot_size(st->channels))
+        return OPUS_BAD_ARG;
+    data += sizeof(size);
+    for (i=0;i<NB_SNAPSHOT_RANGES;i++)
+    {
+        OPUS_COPY((unsigned char*)st+snapshot_ranges[i][0], data,
+              snapshot_ranges[i][1]-snapshot_ranges[i][0]);
+        data += snapshot_ranges[i][1]-snapshot_ranges[i][0];
+    }
+    data += silk_RestoreEncoder((char*)st+st->silk_enc_offset, st->channels, data);
+    data += celt_encoder_restore((CELTEncoder*)(void*)((char*)st+st->celt_enc_offset), data);
+    celt_assert(data-(const unsigned char*)snapshot == size);
+    return OPUS_OK;
+}
@@ -63,6 +63,13 @@ opus_int32 opus_multistream_decoder_get_size(int nb_streams, int nb_coupled_stre
          + (nb_streams-nb_coupled_streams) * align(mono_size);
 }
 
+#ifdef SCRATCH_ARENA
+static char *ms_decoder_get_scratch(OpusMSDecoder *st)
+{
+   return opus_decoder_get_scratch((OpusDecoder*)((char*)st + align(sizeof(OpusMSDecoder))));
+}
+#endif
+
 int opus_multistream_decoder_init(
       OpusMSDecoder *st,
       opus_int32 Fs,
@@ -84,6 +91,9 @@ int opus_multistream_decoder_init(
    st->layout.nb_channels = channels;
    st->layout.nb_streams = streams;
    st->layout.nb_coupled_streams = coupled_streams;
+#ifdef OPUS_SCRATCH_STATS
+   OPUS_CLEAR(&st->scratch_stats, 1);
+#endif
 
    for (i=0;i<st->layout.nb_channels;i++)
       st->layout.mapping[i] = mapping[i];
@@ -194,7 +204,7 @@ int opus_multistream_decode_native(
    char *ptr;
    int do_plc=0;
    VARDECL(opus_val16, buf);
-   ALLOC_STACK;
+   ALLOC_STACK_ARENA(ms_decoder_get_scratch(st), OPUS_DECODER_SCRATCH_SIZE, &st->scratch_stats);
 
    VALIDATE_MS_DECODER(st);
    if (frame_size <= 0)
@@ -465,6 +475,23 @@ int opus_multistream_decoder_ctl_va_list(OpusMSDecoder *st, int request,
           }
        }
        break;
+       case OPUS_GET_SCRATCH_USAGE_REQUEST:
+       case OPUS_GET_PEAK_SCRATCH_USAGE_REQUEST:
+       {
+          /* The streams share the multistream arena */
+          opus_int32 *value = va_arg(ap, opus_int32*);
+          if (!value)
+          {
+             goto bad_arg;
+          }
+#ifdef OPUS_SCRATCH_STATS
+          *value = request == OPUS_GET_SCRATCH_USAGE_REQUEST ?
+                st->scratch_stats.last : st->scratch_stats.peak;
+#else
+          ret = OPUS_UNIMPLEMENTED;
+#endif
+       }
+       break;
        case OPUS_RESET_STATE:
        {
           int s;
@@ -527,6 +554,35 @@ int opus_multistream_decoder_ctl_va_list(OpusMSDecoder *st, int request,
           }
        }
        break;
+       case OPUS_SET_DNN_CPU_BUDGET_REQUEST:
+       {
+          int s;
+          /* Every stream counts against the same budget */
+          OpusCPUBudget *value = va_arg(ap, OpusCPUBudget*);
+          for (s=0;s<st->layout.nb_streams;s++)
+          {
+             OpusDecoder *dec;
+
+             dec = (OpusDecoder*)ptr;
+             if (s < st->layout.nb_coupled_streams)
+                ptr += align(coupled_size);
+             else
+                ptr += align(mono_size);
+             ret = opus_decoder_ctl(dec, request, value);
+             if (ret != OPUS_OK)
+                break;
+          }
+       }
+       break;
+       case OPUS_GET_DNN_CPU_BUDGET_REQUEST:
+       {
+          OpusDecoder *dec;
+          /* All streams share the same budget, just query the first one */
+          OpusCPUBudget **value = va_arg(ap, OpusCPUBudget**);
+          dec = (OpusDecoder*)ptr;
+          ret = opus_decoder_ctl(dec, request, value);
+       }
+       break;
        default:
           ret = OPUS_UNIMPLEMENTED;
        break;
@@ -101,6 +101,13 @@ static opus_val32 *ms_get_window_mem(OpusMSEncoder *st)
    return (opus_val32*)(void*)ptr;
 }
 
+#ifdef SCRATCH_ARENA
+static char *ms_get_scratch(OpusMSEncoder *st)
+{
+   return opus_encoder_get_scratch((OpusEncoder*)((char*)st + align(sizeof(OpusMSEncoder))));
+}
+#endif
+
 static int validate_ambisonics(int nb_channels, int *nb_streams, int *nb_coupled_streams)
 {
    int order_plus_one;
@@ -456,6 +463,9 @@ static int opus_multistream_encoder_init_impl(
    st->bitrate_bps = OPUS_AUTO;
    st->application = application;
    st->variable_duration = OPUS_FRAMESIZE_ARG;
+#ifdef OPUS_SCRATCH_STATS
+   OPUS_CLEAR(&st->scratch_stats, 1);
+#endif
    for (i=0;i<st->layout.nb_channels;i++)
       st->layout.mapping[i] = mapping[i];
    if (!validate_layout(&st->layout))
@@ -832,7 +842,7 @@ int opus_multistream_encode_native
    int frame_size;
    opus_int32 rate_sum;
    opus_int32 smallest_packet;
-   ALLOC_STACK;
+   ALLOC_STACK_ARENA(ms_get_scratch(st), OPUS_ENCODER_SCRATCH_SIZE, &st->scratch_stats);
 
    if (st->mapping_type == MAPPING_TYPE_SURROUND)
    {
@@ -1243,6 +1253,35 @@ int opus_multistream_encoder_ctl_va_list(OpusMSEncoder *st, int request,
       }
    }
    break;
+   case OPUS_SET_CPU_BUDGET_REQUEST:
+   {
+      int s;
+      /* Every stream counts against the same budget */
+      OpusCPUBudget *value = va_arg(ap, OpusCPUBudget*);
+      for (s=0;s<st->layout.nb_streams;s++)
+      {
+         OpusEncoder *enc;
+
+         enc = (OpusEncoder*)ptr;
+         if (s < st->layout.nb_coupled_streams)
+            ptr += align(coupled_size);
+         else
+            ptr += align(mono_size);
+         ret = opus_encoder_ctl(enc, request, value);
+         if (ret != OPUS_OK)
+            break;
+      }
+   }
+   break;
+   case OPUS_GET_CPU_BUDGET_REQUEST:
+   {
+      OpusEncoder *enc;
+      /* All streams share the same budget, just query the first one */
+      OpusCPUBudget **value = va_arg(ap, OpusCPUBudget**);
+      enc = (OpusEncoder*)ptr;
+      ret = opus_encoder_ctl(enc, request, value);
+   }
+   break;
    case OPUS_MULTISTREAM_GET_ENCODER_STATE_REQUEST:
    {
       int s;
@@ -1282,6 +1321,23 @@ int opus_multistream_encoder_ctl_va_list(OpusMSEncoder *st, int request,
        *value = st->variable_duration;
    }
    break;
+   case OPUS_GET_SCRATCH_USAGE_REQUEST:
+   case OPUS_GET_PEAK_SCRATCH_USAGE_REQUEST:
+   {
+      /* The streams share the multistream arena */
+      opus_int32 *value = va_arg(ap, opus_int32*);
+      if (!value)
+      {
+         goto bad_arg;
+      }
+#ifdef OPUS_SCRATCH_STATS
+      *value = request == OPUS_GET_SCRATCH_USAGE_REQUEST ?
+            st->scratch_stats.last : st->scratch_stats.peak;
+#else
+      ret = OPUS_UNIMPLEMENTED;
+#endif
+   }
+   break;
    case OPUS_RESET_STATE:
    {
       int s;
@@ -32,6 +32,9 @@
 #include "arch.h"
 #include "opus.h"
 #include "celt.h"
+#if defined(SCRATCH_ARENA) || defined(NONTHREADSAFE_PSEUDOSTACK)
+#include "stack_alloc.h" /* opus_scratch_stats */
+#endif
 
 #include <stdarg.h> /* va_list */
 #include <stddef.h> /* offsetof */
@@ -91,6 +94,9 @@ struct OpusMSEncoder {
    int variable_duration;
    MappingType mapping_type;
    opus_int32 bitrate_bps;
+#ifdef OPUS_SCRATCH_STATS
+   opus_scratch_stats scratch_stats;
+#endif
    /* Encoder states go here */
    /* then opus_val32 window_mem[channels*120]; */
    /* then opus_val32 preemph_mem[channels]; */
@@ -98,6 +104,9 @@ struct OpusMSEncoder {
 
 struct OpusMSDecoder {
    ChannelLayout layout;
+#ifdef OPUS_SCRATCH_STATS
+   opus_scratch_stats scratch_stats;
+#endif
    /* Decoder states go here */
 };
 
@@ -158,11 +167,38 @@ typedef void (*opus_copy_channel_out_func)(
 #define OPUS_SET_FORCE_MODE_REQUEST    11002
 #define OPUS_SET_FORCE_MODE(x) OPUS_SET_FORCE_MODE_REQUEST, __opus_check_int(x)
 
+#define OPUS_GET_CPU_BUDGET_STATE_REQUEST 11020
+/** Gets the complexity the encoder actually uses under its CPU budget, and
+  * whether the budget has turned DRED off.
+  * @param[out] x <tt>opus_int32*</tt>: Complexity in use (0-10)
+  * @param[out] y <tt>opus_int32*</tt>: 1 when DRED is turned off, 0 otherwise
+  * @hideinitializer */
+#define OPUS_GET_CPU_BUDGET_STATE(x, y) OPUS_GET_CPU_BUDGET_STATE_REQUEST, __opus_check_int_ptr(x), __opus_check_int_ptr(y)
+
 typedef void (*downmix_func)(const void *, opus_val32 *, int, int, int, int, int);
 void downmix_float(const void *_x, opus_val32 *sub, int subframe, int offset, int c1, int c2, int C);
 void downmix_int(const void *_x, opus_val32 *sub, int subframe, int offset, int c1, int c2, int C);
 int is_digital_silence(const opus_val16* pcm, int frame_size, int channels, int lsb_depth);
 
+/* Monotonic wall-clock time in seconds, used for the CPU budgets. */
+double opus_wall_time(void);
+
+struct OpusCPUBudget {
+   opus_int32 target;             /* microseconds per 20 ms of audio, all users together */
+   volatile opus_int32 spent;     /* microseconds spent in the current window */
+   volatile opus_int32 window_start; /* microseconds, modulo 2^31 */
+   volatile opus_int32 load;      /* microseconds per 20 ms of audio over the last window */
+   double (*clock)(void);
+};
+
+/* Adds spent seconds to the budget at time now (as read from budget->clock)
+   and returns the load of all its users over the last complete window. */
+opus_int32 opus_cpu_budget_update(OpusCPUBudget *budget, double spent, double now);
+
+/* Replaces the clock an OpusCPUBudget reads (opus_wall_time() by default),
+   so that tests can drive the controllers with simulated time. */
+void opus_cpu_budget_set_clock(OpusCPUBudget *budget, double (*clock)(void));
+
 int encode_size(int size, unsigned char *data);
 
 opus_int32 frame_size_select(opus_int32 frame_size, int variable_duration, opus_int32 Fs);
@@ -176,6 +212,24 @@ int opus_decode_native(OpusDecoder *st, const unsigned char *data, opus_int32 le
       opus_val16 *pcm, int frame_size, int decode_fec, int self_delimited,
       opus_int32 *packet_offset, int soft_clip, const OpusDRED *dred, opus_int32 dred_offset);
 
+#ifdef SCRATCH_ARENA
+/* Size in bytes of the scratch arena at the end of each encoder/decoder state.
+   Multistream objects use the arena of their first stream, which then also
+   holds the allocations of the stream being coded.
+   These cover the float build's worst case (120 ms frames at 48 kHz) with
+   some margin; fixed-point builds need about half as much. The compact
+   decoder also expands its CELT history into the arena. */
+#define OPUS_ENCODER_SCRATCH_SIZE    122880
+#ifdef COMPACT_DECODER
+#define OPUS_DECODER_SCRATCH_SIZE    106496
+#else
+#define OPUS_DECODER_SCRATCH_SIZE    81920
+#endif
+
+char *opus_encoder_get_scratch(OpusEncoder *st);
+char *opus_decoder_get_scratch(OpusDecoder *st);
+#endif
+
 /* Make sure everything is properly aligned. */
 static OPUS_INLINE int align(int i)
 {
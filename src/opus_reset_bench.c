@@ -0,0 +1,181 @@
+/* Copyright (c) 2025 Xiph.Org Foundation */
+/*
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   - Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+   - Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+   OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+   EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+   PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Measures what it costs to get a fresh encoder or decoder: creating and
+   destroying one, re-initialising one in place with *_init(), and resetting
+   one with OPUS_RESET_STATE after it has coded a few frames, as a pool of
+   instances reused across calls would. */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "opus.h"
+
+#define MAX_FRAME 960
+#define MAX_PACKET 1500
+/* Frames coded before each reset so that the state is actually used */
+#define WARMUP_FRAMES 3
+
+static void check(int err, const char *what)
+{
+   if (err < 0)
+   {
+      fprintf(stderr, "%s failed: %s\n", what, opus_strerror(err));
+      exit(EXIT_FAILURE);
+   }
+}
+
+/* Seconds on a monotonic clock. Resets take well under a microsecond, so
+   each one is timed on its own with clock_gettime() where available; clock()
+   is usually too coarse for that. */
+static double now(void)
+{
+#ifdef CLOCK_MONOTONIC
+   struct timespec ts;
+   if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0)
+      return ts.tv_sec + 1e-9*ts.tv_nsec;
+#endif
+   return (double)clock()/CLOCKS_PER_SEC;
+}
+
+static void bench(opus_int32 Fs, int channels, int application, int iterations)
+{
+   short pcm[MAX_FRAME*2];
+   unsigned char packet[MAX_PACKET];
+   opus_int32 len[WARMUP_FRAMES];
+   unsigned char packets[WARMUP_FRAMES][MAX_PACKET];
+   OpusEncoder *enc;
+   OpusDecoder *dec;
+   double start, t;
+   int frame_size;
+   int i, j, err;
+
+   frame_size = Fs/50;
+   for (i=0;i<frame_size*channels;i++)
+      pcm[i] = (short)((rand()&0x3fff) - 0x2000);
+
+   /* Create and destroy */
+   start = now();
+   for (i=0;i<iterations;i++)
+   {
+      enc = opus_encoder_create(Fs, channels, application, &err);
+      check(err, "opus_encoder_create");
+      opus_encoder_destroy(enc);
+   }
+   t = now() - start;
+   printf("%6d Hz %d ch  encoder create+destroy %8.2f us\n", (int)Fs, channels,
+         1e6*t/iterations);
+   start = now();
+   for (i=0;i<iterations;i++)
+   {
+      dec = opus_decoder_create(Fs, channels, &err);
+      check(err, "opus_decoder_create");
+      opus_decoder_destroy(dec);
+   }
+   t = now() - start;
+   printf("%6d Hz %d ch  decoder create+destroy %8.2f us\n", (int)Fs, channels,
+         1e6*t/iterations);
+
+   enc = opus_encoder_create(Fs, channels, application, &err);
+   check(err, "opus_encoder_create");
+   dec = opus_decoder_create(Fs, channels, &err);
+   check(err, "opus_decoder_create");
+   for (j=0;j<WARMUP_FRAMES;j++)
+   {
+      len[j] = opus_encode(enc, pcm, frame_size, packets[j], MAX_PACKET);
+      check(len[j], "opus_encode");
+   }
+
+   /* Init in place and reset, each after coding a few frames. Only the
+      init or reset itself is timed. */
+   t = 0;
+   for (i=0;i<iterations;i++)
+   {
+      for (j=0;j<WARMUP_FRAMES;j++)
+         check(opus_encode(enc, pcm, frame_size, packet, MAX_PACKET), "opus_encode");
+      start = now();
+      check(opus_encoder_init(enc, Fs, channels, application), "opus_encoder_init");
+      t += now() - start;
+   }
+   printf("%6d Hz %d ch  encoder init           %8.2f us\n", (int)Fs, channels,
+         1e6*t/iterations);
+   t = 0;
+   for (i=0;i<iterations;i++)
+   {
+      for (j=0;j<WARMUP_FRAMES;j++)
+         check(opus_encode(enc, pcm, frame_size, packet, MAX_PACKET), "opus_encode");
+      start = now();
+      check(opus_encoder_ctl(enc, OPUS_RESET_STATE), "OPUS_RESET_STATE");
+      t += now() - start;
+   }
+   printf("%6d Hz %d ch  encoder reset          %8.2f us\n", (int)Fs, channels,
+         1e6*t/iterations);
+   t = 0;
+   for (i=0;i<iterations;i++)
+   {
+      for (j=0;j<WARMUP_FRAMES;j++)
+         check(opus_decode(dec, packets[j], len[j], pcm, frame_size, 0), "opus_decode");
+      start = now();
+      check(opus_decoder_init(dec, Fs, channels), "opus_decoder_init");
+      t += now() - start;
+   }
+   printf("%6d Hz %d ch  decoder init           %8.2f us\n", (int)Fs, channels,
+         1e6*t/iterations);
+   t = 0;
+   for (i=0;i<iterations;i++)
+   {
+      for (j=0;j<WARMUP_FRAMES;j++)
+         check(opus_decode(dec, packets[j], len[j], pcm, frame_size, 0), "opus_decode");
+      start = now();
+      check(opus_decoder_ctl(dec, OPUS_RESET_STATE), "OPUS_RESET_STATE");
+      t += now() - start;
+   }
+   printf("%6d Hz %d ch  decoder reset          %8.2f us\n", (int)Fs, channels,
+         1e6*t/iterations);
+
+   opus_encoder_destroy(enc);
+   opus_decoder_destroy(dec);
+}
+
+int main(int argc, char **argv)
+{
+   int iterations;
+   iterations = argc > 1 ? atoi(argv[1]) : 5000;
+   if (iterations <= 0)
+   {
+      fprintf(stderr, "usage: %s [iterations]\n", argv[0]);
+      return EXIT_FAILURE;
+   }
+   printf("%s, %d iterations\n", opus_get_version_string(), iterations);
+   bench(16000, 1, OPUS_APPLICATION_VOIP, iterations);
+   bench(48000, 2, OPUS_APPLICATION_AUDIO, iterations);
+   return EXIT_SUCCESS;
+}
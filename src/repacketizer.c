@@ -121,7 +121,7 @@ opus_int32 opus_repacketizer_out_range_impl(OpusRepacketizer *rp, int begin, int
    int ext_begin=0, ext_len=0;
    int ext_count, total_ext_count;
    VARDECL(opus_extension_data, all_extensions);
-   SAVE_STACK;
+   ALLOC_STACK;
 
    if (begin<0 || begin>=end || end>rp->nb_frames)
    {
@@ -258,7 +258,11 @@ opus_int32 opus_repacketizer_out_range_impl(OpusRepacketizer *rp, int begin, int
       {
          /* figure out how much space we need for the extensions */
          ext_len = opus_packet_extensions_generate(NULL, maxlen-tot_size, all_extensions, ext_count, 0);
-         if (ext_len < 0) return ext_len;
+         if (ext_len < 0)
+         {
+            RESTORE_STACK;
+            return ext_len;
+         }
          if (!pad)
             pad_amount = ext_len + ext_len/254 + 1;
       }
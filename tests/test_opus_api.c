@@ -236,6 +236,33 @@ opus_int32 test_dec_api(void)
    fprintf(stdout,"    OPUS_SET_GAIN ................................ OK.\n");
    fprintf(stdout,"    OPUS_GET_GAIN ................................ OK.\n");
 
+   {
+      OpusCPUBudget *budget;
+      OpusCPUBudget *budget2;
+      budget=opus_cpu_budget_create(5000, &err);
+      if(err!=OPUS_OK || budget==NULL)test_failed();
+      cfgs++;
+      err=opus_decoder_ctl(dec, OPUS_GET_DNN_CPU_BUDGET((OpusCPUBudget**)NULL));
+      if(err != OPUS_BAD_ARG)test_failed();
+      cfgs++;
+      budget2=budget;
+      err=opus_decoder_ctl(dec, OPUS_GET_DNN_CPU_BUDGET(&budget2));
+      if(err != OPUS_OK || budget2!=NULL)test_failed();
+      cfgs++;
+      err=opus_decoder_ctl(dec, OPUS_SET_DNN_CPU_BUDGET(budget));
+      if(err != OPUS_OK)test_failed();
+      cfgs++;
+      err=opus_decoder_ctl(dec, OPUS_GET_DNN_CPU_BUDGET(&budget2));
+      if(err != OPUS_OK || budget2!=budget)test_failed();
+      cfgs++;
+      err=opus_decoder_ctl(dec, OPUS_SET_DNN_CPU_BUDGET((OpusCPUBudget*)NULL));
+      if(err != OPUS_OK)test_failed();
+      cfgs++;
+      opus_cpu_budget_destroy(budget);
+   }
+   fprintf(stdout,"    OPUS_SET_DNN_CPU_BUDGET ...................... OK.\n");
+   fprintf(stdout,"    OPUS_GET_DNN_CPU_BUDGET ...................... OK.\n");
+
    /*Reset the decoder*/
    dec2=malloc(opus_decoder_get_size(2));
    memcpy(dec2,dec,opus_decoder_get_size(2));
@@ -1295,6 +1322,36 @@ opus_int32 test_enc_api(void)
      "    OPUS_SET_COMPLEXITY .......................... OK.\n",
      "    OPUS_GET_COMPLEXITY .......................... OK.\n")
 
+   {
+      OpusCPUBudget *budget;
+      OpusCPUBudget *budget2;
+      budget=opus_cpu_budget_create(0, &err);
+      if(err!=OPUS_BAD_ARG || budget!=NULL)test_failed();
+      cfgs++;
+      budget=opus_cpu_budget_create(5000, &err);
+      if(err!=OPUS_OK || budget==NULL)test_failed();
+      cfgs++;
+      err=opus_encoder_ctl(enc,OPUS_GET_CPU_BUDGET((OpusCPUBudget**)NULL));
+      if(err!=OPUS_BAD_ARG)test_failed();
+      cfgs++;
+      budget2=NULL;
+      err=opus_encoder_ctl(enc,OPUS_GET_CPU_BUDGET(&budget2));
+      if(err!=OPUS_OK || budget2!=NULL)test_failed();
+      cfgs++;
+      err=opus_encoder_ctl(enc,OPUS_SET_CPU_BUDGET(budget));
+      if(err!=OPUS_OK)test_failed();
+      cfgs++;
+      fprintf(stdout,"    OPUS_SET_CPU_BUDGET .......................... OK.\n");
+      err=opus_encoder_ctl(enc,OPUS_GET_CPU_BUDGET(&budget2));
+      if(err!=OPUS_OK || budget2!=budget)test_failed();
+      cfgs++;
+      fprintf(stdout,"    OPUS_GET_CPU_BUDGET .......................... OK.\n");
+      err=opus_encoder_ctl(enc,OPUS_SET_CPU_BUDGET((OpusCPUBudget*)NULL));
+      if(err!=OPUS_OK)test_failed();
+      cfgs++;
+      opus_cpu_budget_destroy(budget);
+   }
+
    err=opus_encoder_ctl(enc,OPUS_GET_INBAND_FEC(null_int_ptr));
    if(err!=OPUS_BAD_ARG)test_failed();
    cfgs++;
@@ -1748,6 +1805,111 @@ int test_repacketizer_api(void)
    return cfgs;
 }
 
+static int nb_allocs;
+static int fail_allocs;
+static void *last_alloc;
+
+static void *test_alloc(void *user_data, size_t size, size_t alignment)
+{
+   unsigned char *raw;
+   unsigned char *ptr;
+   if(user_data!=&nb_allocs)test_failed();
+   if(alignment<sizeof(void*)||(alignment&(alignment-1))!=0)test_failed();
+   if(fail_allocs)return NULL;
+   /* Hand out exactly the requested alignment, keeping the malloc() pointer
+      just before the block. */
+   raw=(unsigned char *)malloc(size+alignment+sizeof(void*));
+   if(raw==NULL)return NULL;
+   ptr=raw+sizeof(void*);
+   ptr+=(alignment-((size_t)ptr&(alignment-1)))&(alignment-1);
+   ((void**)ptr)[-1]=raw;
+   nb_allocs++;
+   last_alloc=ptr;
+   return ptr;
+}
+
+static void test_free(void *user_data, void *ptr)
+{
+   if(user_data!=&nb_allocs)test_failed();
+   if(ptr==NULL)test_failed();
+   nb_allocs--;
+   free(((void**)ptr)[-1]);
+}
+
+int test_allocator(void)
+{
+   OpusDecoder *dec;
+   OpusEncoder *enc;
+   OpusRepacketizer *rp;
+   OpusMSDecoder *msdec;
+   OpusMSEncoder *msenc;
+   unsigned char mapping[2] = {0,1};
+   int cfgs,err;
+   cfgs=0;
+
+   fprintf(stdout,"\n  Allocator tests\n");
+   fprintf(stdout,"  ---------------------------------------------------\n");
+   if(opus_set_allocator(test_alloc,NULL,&nb_allocs)!=OPUS_BAD_ARG)test_failed();
+   cfgs++;
+   if(opus_set_allocator(NULL,test_free,&nb_allocs)!=OPUS_BAD_ARG)test_failed();
+   cfgs++;
+   err=opus_set_allocator(test_alloc,test_free,&nb_allocs);
+   cfgs++;
+   if(err==OPUS_UNIMPLEMENTED)
+   {
+      fprintf(stdout,"    opus_set_allocator() .................... SKIPPED.\n");
+      fprintf(stdout,"(Not supported with OVERRIDE_OPUS_ALLOC)\n");
+      return cfgs;
+   }
+   if(err!=OPUS_OK)test_failed();
+
+   dec=opus_decoder_create(48000,2,&err);
+   if(err!=OPUS_OK||dec==NULL||(void*)dec!=last_alloc)test_failed();
+   cfgs++;
+   enc=opus_encoder_create(48000,2,OPUS_APPLICATION_AUDIO,&err);
+   if(err!=OPUS_OK||enc==NULL||(void*)enc!=last_alloc)test_failed();
+   cfgs++;
+   msdec=opus_multistream_decoder_create(48000,2,1,1,mapping,&err);
+   if(err!=OPUS_OK||msdec==NULL||(void*)msdec!=last_alloc)test_failed();
+   cfgs++;
+   msenc=opus_multistream_encoder_create(48000,2,1,1,mapping,OPUS_APPLICATION_AUDIO,&err);
+   if(err!=OPUS_OK||msenc==NULL||(void*)msenc!=last_alloc)test_failed();
+   cfgs++;
+   rp=opus_repacketizer_create();
+   if(rp==NULL||(void*)rp!=last_alloc)test_failed();
+   cfgs++;
+   if(nb_allocs!=5)test_failed();
+   opus_decoder_destroy(dec);
+   opus_encoder_destroy(enc);
+   opus_multistream_decoder_destroy(msdec);
+   opus_multistream_encoder_destroy(msenc);
+   opus_repacketizer_destroy(rp);
+   cfgs+=5;
+   if(nb_allocs!=0)test_failed();
+   fprintf(stdout,"    opus_set_allocator() ......................... OK.\n");
+
+   fail_allocs=1;
+   dec=opus_decoder_create(48000,2,&err);
+   if(dec!=NULL||err!=OPUS_ALLOC_FAIL)test_failed();
+   cfgs++;
+   enc=opus_encoder_create(48000,2,OPUS_APPLICATION_AUDIO,&err);
+   if(enc!=NULL||err!=OPUS_ALLOC_FAIL)test_failed();
+   cfgs++;
+   fail_allocs=0;
+   fprintf(stdout,"    allocation failure ........................... OK.\n");
+
+   if(opus_set_allocator(NULL,NULL,NULL)!=OPUS_OK)test_failed();
+   cfgs++;
+   dec=opus_decoder_create(48000,2,&err);
+   if(err!=OPUS_OK||dec==NULL||nb_allocs!=0)test_failed();
+   opus_decoder_destroy(dec);
+   cfgs+=2;
+   fprintf(stdout,"    restoring malloc() ........................... OK.\n");
+   fprintf(stdout,"                            All allocator tests passed\n");
+   fprintf(stdout,"                                 (%2d API invocations)\n",cfgs);
+   return cfgs;
+}
+
 #ifdef MALLOC_FAIL
 /* GLIBC 2.14 declares __malloc_hook as deprecated, generating a warning
  * under GCC. However, this is the cleanest way to test malloc failure
@@ -1782,7 +1944,7 @@ int test_malloc_fail(void)
 #ifdef MALLOC_FAIL
    orig_malloc=__malloc_hook;
    __malloc_hook=malloc_hook;
-   ep=(int *)opus_alloc(sizeof(int));
+   ep=(int *)malloc(sizeof(int));
    if(ep!=NULL)
    {
       if(ep)free(ep);
@@ -1896,6 +2058,7 @@ int main(int _argc, char **_argv)
    total+=test_parse();
    total+=test_enc_api();
    total+=test_repacketizer_api();
+   total+=test_allocator();
    total+=test_malloc_fail();
 
    fprintf(stderr,"\nAll API tests passed.\nThe libopus API was invoked %d times.\n",total);
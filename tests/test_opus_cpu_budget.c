@@ -0,0 +1,236 @@
+/* Copyright (c) 2025 Xiph.Org Foundation */
+/*
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   - Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+   - Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+   OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+   EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+   PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Drives the CPU budget controller of two encoders sharing one budget with a
+   simulated clock. Each frame appears to take a time that grows with the
+   complexity the encoder is using and with DRED, scaled by a load factor.
+   Raising the factor must bring the complexity down and turn DRED off, and
+   going back to normal must restore both. */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "opus.h"
+#include "../src/opus_private.h"
+#include "test_opus_common.h"
+
+#define FS 48000
+#define FRAME 960
+#define NB_ENCODERS 2
+/* Time allowed to both encoders together for every 20 ms */
+#define TARGET_US 1400
+/* Simulated cost of a frame at complexity 0, and of each step above it */
+#define COST_US 25
+/* Simulated cost of DRED on a frame */
+#define DRED_COST_US 75
+
+#ifndef M_PI
+#define M_PI 3.141592653589793
+#endif
+
+/* Start of the current 20 ms period and time spent in it, in seconds */
+static double period_start;
+static double period_used;
+/* Cost of the frame being encoded, in seconds */
+static double frame_cost;
+/* Whether the library supports DRED */
+static int has_dred;
+
+/* Called once before and once after each frame, so the encoder measures
+   exactly frame_cost. Periods stay 20 ms long, so what both encoders spend
+   in one must stay below that, as it would in real time. The load is
+   measured over windows holding a whole number of frames, so it is only
+   accurate to about one frame: the loads below stay at least 10% away from
+   the target. */
+static double test_clock(void)
+{
+   period_used += frame_cost;
+   return period_start + period_used;
+}
+
+static void get_state(OpusEncoder *enc, opus_int32 *complexity, opus_int32 *dred_off)
+{
+   if (opus_encoder_ctl(enc, OPUS_GET_CPU_BUDGET_STATE(complexity, dred_off)) != OPUS_OK)
+      test_failed();
+}
+
+/* Encodes nb_frames periods with both encoders at the given load factor.
+   Returns how many packets carried DRED over the last 25 periods. */
+static int run(OpusEncoder **enc, OpusDREDDecoder *dred_dec, OpusDRED *dred,
+      int nb_frames, int factor)
+{
+   static int t;
+   int f, i, k;
+   int nb_dred;
+   nb_dred = 0;
+   for (f=0;f<nb_frames;f++)
+   {
+      opus_int16 pcm[FRAME];
+      for (i=0;i<FRAME;i++)
+      {
+         double x = (t+i)/(double)FS;
+         double v = 0;
+         int h;
+         for (h=1;h<=6;h++)
+            v += sin(2*M_PI*h*(140+20*sin(2*M_PI*3*x))*x)/h;
+         pcm[i] = (opus_int16)(4000*v + (int)(fast_rand()%201) - 100);
+      }
+      t += FRAME;
+      for (k=0;k<NB_ENCODERS;k++)
+      {
+         unsigned char packet[1500];
+         opus_int32 len;
+         opus_int32 complexity, dred_off;
+         get_state(enc[k], &complexity, &dred_off);
+         frame_cost = 1e-6*factor*(COST_US*(1+complexity) + (has_dred && !dred_off ? DRED_COST_US : 0));
+         len = opus_encode(enc[k], pcm, FRAME, packet, sizeof(packet));
+         if (len < 0) test_failed();
+         if (dred_dec != NULL && f >= nb_frames-25)
+         {
+            int dred_end;
+            if (opus_dred_parse(dred_dec, dred, packet, len, FS, FS, &dred_end, 0) > 0)
+               nb_dred++;
+         }
+      }
+      frame_cost = 0;
+      period_start += .02;
+      period_used = 0;
+   }
+   return nb_dred;
+}
+
+static void check_state(OpusEncoder **enc, int complexity, int dred_off)
+{
+   int k;
+   for (k=0;k<NB_ENCODERS;k++)
+   {
+      opus_int32 c, off;
+      get_state(enc[k], &c, &off);
+      fprintf(stdout, "    encoder %d: complexity %d, DRED %s\n", k, (int)c,
+            off ? "off" : "on");
+      fflush(stdout);
+      if (c != complexity || off != dred_off) test_failed();
+   }
+}
+
+int main(int _argc, char **_argv)
+{
+   OpusEncoder *enc[NB_ENCODERS];
+   OpusCPUBudget *budget;
+   OpusDREDDecoder *dred_dec;
+   OpusDRED *dred;
+   int nb_dred;
+   int k, err;
+   (void)_argc;
+   (void)_argv;
+
+   iseed = 0;
+   Rw = Rz = iseed;
+
+   budget = opus_cpu_budget_create(TARGET_US, &err);
+   if (err != OPUS_OK || budget == NULL) test_failed();
+   opus_cpu_budget_set_clock(budget, test_clock);
+
+   has_dred = 1;
+   for (k=0;k<NB_ENCODERS;k++)
+   {
+      enc[k] = opus_encoder_create(FS, 1, OPUS_APPLICATION_VOIP, &err);
+      if (err != OPUS_OK || enc[k] == NULL) test_failed();
+      if (opus_encoder_ctl(enc[k], OPUS_SET_COMPLEXITY(10)) != OPUS_OK) test_failed();
+      if (opus_encoder_ctl(enc[k], OPUS_SET_BITRATE(32000)) != OPUS_OK) test_failed();
+      if (opus_encoder_ctl(enc[k], OPUS_SET_PACKET_LOSS_PERC(20)) != OPUS_OK) test_failed();
+      if (opus_encoder_ctl(enc[k], OPUS_SET_DRED_DURATION(100)) != OPUS_OK)
+         has_dred = 0;
+      if (opus_encoder_ctl(enc[k], OPUS_SET_CPU_BUDGET(budget)) != OPUS_OK) test_failed();
+   }
+   dred_dec = NULL;
+   dred = NULL;
+   if (has_dred)
+   {
+      dred_dec = opus_dred_decoder_create(&err);
+      if (err != OPUS_OK) test_failed();
+      err = OPUS_OK;
+      dred = opus_dred_alloc(&err);
+      if (err != OPUS_OK || dred == NULL) test_failed();
+   }
+
+   /* With DRED, both encoders together take 2*(275+75) = 700 us, under 70%
+      of the target, so nothing changes. */
+   fprintf(stdout,"Testing the CPU budget controller.\n  Normal load:\n");
+   nb_dred = run(enc, dred_dec, dred, 100, 1);
+   check_state(enc, 10, 0);
+   /* Without a model (external weights), DRED is still turned off and on,
+      but the packets carry none. */
+   if (nb_dred == 0)
+   {
+      if (dred_dec != NULL) opus_dred_decoder_destroy(dred_dec);
+      if (dred != NULL) opus_dred_free(dred);
+      dred_dec = NULL;
+      dred = NULL;
+   }
+
+   /* Eight times slower: 400*(c+4) us with DRED, 400*(c+1) without. DRED
+      goes once the complexity is down to where it stops coding anything
+      (7, or 10 in fixed point), then the complexity comes down to 2. */
+   fprintf(stdout,"  Eight times the load:\n");
+   nb_dred = run(enc, dred_dec, dred, 150, 8);
+   check_state(enc, 2, has_dred);
+   if (nb_dred != 0) test_failed();
+
+   /* 24 times slower: 1200*(c+1) us, so complexity 0. */
+   fprintf(stdout,"  24 times the load:\n");
+   nb_dred = run(enc, dred_dec, dred, 100, 24);
+   check_state(enc, 0, has_dred);
+   if (nb_dred != 0) test_failed();
+
+   /* Back to normal: one complexity step per second, with DRED back on the
+      way up. */
+   fprintf(stdout,"  Back to normal load:\n");
+   nb_dred = run(enc, dred_dec, dred, 700, 1);
+   check_state(enc, 10, 0);
+   if (dred_dec != NULL && nb_dred != 25*NB_ENCODERS) test_failed();
+
+   /* Detaching restores the configured complexity right away. */
+   fprintf(stdout,"  Eight times the load, then detached:\n");
+   run(enc, dred_dec, dred, 150, 8);
+   check_state(enc, 2, has_dred);
+   for (k=0;k<NB_ENCODERS;k++)
+      if (opus_encoder_ctl(enc[k], OPUS_SET_CPU_BUDGET(NULL)) != OPUS_OK) test_failed();
+   check_state(enc, 10, 0);
+
+   for (k=0;k<NB_ENCODERS;k++)
+      opus_encoder_destroy(enc[k]);
+   if (dred_dec != NULL) opus_dred_decoder_destroy(dred_dec);
+   if (dred != NULL) opus_dred_free(dred);
+   opus_cpu_budget_destroy(budget);
+   fprintf(stdout,"All CPU budget tests passed.\n");
+   return EXIT_SUCCESS;
+}
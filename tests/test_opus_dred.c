@@ -40,10 +40,12 @@
 #define getpid _getpid
 #endif
 
-/* including sources directly to test internal APIs */
-#define CELT_C /* to make celt_assert work */
+#include <math.h>
 #include "opus.h"
 #include "test_opus_common.h"
+#include "dred_encoder.h"
+#include "dred_decoder.h"
+#include "../src/opus_private.h"
 
 
 
@@ -51,6 +53,24 @@
 #define MAX_EXTENSION_SIZE 200
 #define MAX_NB_EXTENSIONS 100
 
+#define GATING_FS 16000
+#define GATING_FRAME 320
+#define GATING_SILENCE_FRAMES 100
+#define GATING_NOISE_FRAMES 100
+#define GATING_SPEECH_FRAMES 50
+#define GATING_MAX_BYTES 1000
+
+#define SPAN_FS 16000
+#define SPAN_FRAME 320
+#define SPAN_NB_FRAMES 150
+#define SPAN_MAX_PACKET 1500
+
+#define SWITCH_FS 48000
+#define SWITCH_FRAME 960
+#define SWITCH_NB_FRAMES 200
+#define SWITCH_PERIOD 5
+#define SWITCH_WARMUP 25
+
 void test_random_dred(void)
 {
    int error;
@@ -83,6 +103,318 @@ void test_random_dred(void)
    opus_dred_decoder_destroy(dred_dec);
 }
 
+#ifndef M_PI
+#define M_PI 3.141592653589793
+#endif
+
+#define GATING_SILENCE 0
+/* Low-level noise, as from a muted microphone that keeps transmitting */
+#define GATING_NOISE 1
+#define GATING_SPEECH 2
+
+/* Deterministic voiced-like signal with a wobbling pitch and amplitude
+   modulation, low-level noise, or digital silence. */
+static void gating_frame(float *x, int start, int len, int Fs, int type)
+{
+   int i;
+   for (i=0;i<len;i++)
+   {
+      double t;
+      double v;
+      int h;
+      t = (start+i)/(double)Fs;
+      v = 0;
+      if (type == GATING_NOISE)
+         v = 1e-6*((int)(fast_rand()%2001) - 1000);
+      else if (type == GATING_SPEECH)
+      {
+         double f0;
+         f0 = 130 + 20*sin(2*M_PI*3*t);
+         for (h=1;h<12;h++)
+            v += sin(2*M_PI*h*f0*t)/h;
+         v *= .15*(.6 + .4*sin(2*M_PI*4*t));
+      }
+      x[i] = (float)v;
+   }
+}
+
+/* Encodes the same input, digital silence, then low-level noise, then
+   speech, with and without activity gating. While inactive, the gated
+   encoder must only run one DRED frame out of DRED_GATING_DECIMATION. Once
+   speech has been active for longer than the hangover, its latents must
+   have converged to the ungated ones and its DRED payloads must decode to
+   the same data. */
+void test_dred_activity_gating(void)
+{
+   DREDEnc *enc[2];
+   OpusDRED *dred[2];
+   unsigned char activity_mem[2][4*DRED_MAX_FRAMES];
+   unsigned char buf[2][GATING_MAX_BYTES];
+   float x[GATING_FRAME];
+   int nb_held;
+   int nb_compared;
+   int nb_values;
+   int nb_equal;
+   float onset_dist, dist;
+   int f, k, i;
+   for (k=0;k<2;k++)
+   {
+      enc[k] = (DREDEnc*)calloc(1, sizeof(DREDEnc));
+      dred[k] = (OpusDRED*)calloc(1, sizeof(OpusDRED));
+      expect_true(enc[k] != NULL && dred[k] != NULL, "allocation failed");
+      dred_encoder_init(enc[k], GATING_FS, 1);
+      enc[k]->activity_gating = k;
+      memset(activity_mem[k], 0, sizeof(activity_mem[k]));
+   }
+   nb_held = nb_compared = nb_values = nb_equal = 0;
+   onset_dist = dist = 0;
+   for (f=0;f<GATING_SILENCE_FRAMES+GATING_NOISE_FRAMES+GATING_SPEECH_FRAMES;f++)
+   {
+      int active;
+      int held;
+      int speech_frame;
+      speech_frame = f - GATING_SILENCE_FRAMES - GATING_NOISE_FRAMES;
+      active = speech_frame >= 0;
+      gating_frame(x, f*GATING_FRAME, GATING_FRAME, GATING_FS,
+            active ? GATING_SPEECH : f >= GATING_SILENCE_FRAMES ? GATING_NOISE : GATING_SILENCE);
+      for (k=0;k<2;k++)
+      {
+         dred_compute_latents(enc[k], x, NULL, GATING_FRAME, 0, active, 0);
+         /* Same 2.5-ms activity history the Opus encoder keeps. */
+         memmove(&activity_mem[k][8], activity_mem[k], 4*DRED_MAX_FRAMES-8);
+         memset(activity_mem[k], active, 8);
+      }
+      held = !memcmp(enc[1]->latents_buffer, enc[1]->latents_buffer+DRED_LATENT_DIM,
+            DRED_LATENT_DIM*sizeof(float));
+      expect_true(enc[0]->gated_frames == 0, "ungated encoder skipped a frame");
+      if (!active && f > DRED_GATING_HANGOVER)
+      {
+         /* Inside a gated stretch, exactly DRED_GATING_DECIMATION-1 frames out of
+            DRED_GATING_DECIMATION repeat the previous latents. */
+         expect_true(held == (enc[1]->gated_frames != 0), "gated frame not held");
+         nb_held += held;
+      } else if (active) {
+         expect_true(enc[1]->gated_frames == 0, "frame gated during speech");
+         /* Largest difference between the newest latents of both encoders. */
+         dist = 0;
+         for (i=0;i<DRED_LATENT_DIM;i++)
+            dist = MAX16(dist, (float)fabs(enc[0]->latents_buffer[i] - enc[1]->latents_buffer[i]));
+         if (speech_frame == 0)
+            onset_dist = dist;
+      }
+      if (speech_frame >= DRED_GATING_HANGOVER + 2)
+      {
+         int n[2];
+         /* Only ask for as many chunks as there are speech frames past the
+            hangover so the payload does not reach back into the noise. */
+         for (k=0;k<2;k++)
+         {
+            n[k] = dred_encode_silk_frame(enc[k], buf[k], 2, GATING_MAX_BYTES, 6, 3, 15, activity_mem[k], 0);
+            expect_true(n[k] > 0, "no DRED payload during speech");
+            dred_ec_decode(dred[k], buf[k], n[k], 4*2, 0);
+         }
+         expect_true(dred[0]->nb_latents == dred[1]->nb_latents, "different number of latents");
+         expect_true(dred[0]->dred_offset == dred[1]->dred_offset, "different DRED offset");
+         for (i=0;i<DRED_STATE_DIM;i++)
+            nb_equal += dred[0]->state[i] == dred[1]->state[i];
+         for (i=0;i<dred[0]->nb_latents*DRED_LATENT_DIM;i++)
+            nb_equal += dred[0]->latents[i] == dred[1]->latents[i];
+         nb_values += DRED_STATE_DIM + dred[0]->nb_latents*DRED_LATENT_DIM;
+         nb_compared++;
+      }
+   }
+   fprintf(stderr,"  gated latents at speech onset differ by %g, at the end by %g\n", onset_dist, dist);
+   /* Both the silence and the noise are gated. */
+   expect_true(nb_held >= (GATING_SILENCE_FRAMES+GATING_NOISE_FRAMES-2*DRED_GATING_HANGOVER)/2, "gating did not skip frames");
+   expect_true(nb_compared > 0, "no speech payloads compared");
+   /* The gated encoder state resynchronises during the hangover, so the
+      latents converge and the quantised DRED data should be (nearly always
+      exactly) the same. */
+   expect_true(dist < 1e-3f && dist <= onset_dist, "gated latents did not converge");
+   expect_true(nb_equal >= nb_values - nb_values/100, "gated DRED does not match ungated DRED");
+   for (k=0;k<2;k++)
+   {
+      free(enc[k]);
+      free(dred[k]);
+   }
+}
+
+/* Recovers bursts of lost frames from DRED with one opus_decoder_dred_decode()
+   call covering the whole burst on one decoder, and with one call per frame on
+   another. The single call lets the deep PLC batch the FARGAN conditioning
+   over the burst, and the output must be the same either way. */
+void test_dred_span_recovery(void)
+{
+   static unsigned char packets[SPAN_NB_FRAMES][SPAN_MAX_PACKET];
+   opus_int32 len[SPAN_NB_FRAMES];
+   opus_int16 pcm[SPAN_FRAME];
+   opus_int16 out_span[5*SPAN_FRAME];
+   opus_int16 out_frames[5*SPAN_FRAME];
+   float x[SPAN_FRAME];
+   OpusEncoder *enc;
+   OpusDecoder *dec[2];
+   OpusDREDDecoder *dred_dec;
+   OpusDRED *dred;
+   int i, j, k, err;
+   int nb_bursts;
+
+   enc = opus_encoder_create(SPAN_FS, 1, OPUS_APPLICATION_VOIP, &err);
+   if (err != OPUS_OK || enc == NULL) test_failed();
+   if (opus_encoder_ctl(enc, OPUS_SET_BITRATE(24000)) != OPUS_OK) test_failed();
+   if (opus_encoder_ctl(enc, OPUS_SET_PACKET_LOSS_PERC(20)) != OPUS_OK) test_failed();
+   if (opus_encoder_ctl(enc, OPUS_SET_DRED_DURATION(100)) != OPUS_OK) test_failed();
+   for (i=0;i<SPAN_NB_FRAMES;i++)
+   {
+      gating_frame(x, i*SPAN_FRAME, SPAN_FRAME, SPAN_FS, GATING_SPEECH);
+      for (j=0;j<SPAN_FRAME;j++)
+         pcm[j] = (opus_int16)floor(.5 + 32767*x[j]);
+      len[i] = opus_encode(enc, pcm, SPAN_FRAME, packets[i], SPAN_MAX_PACKET);
+      if (len[i] < 0) test_failed();
+   }
+   opus_encoder_destroy(enc);
+
+   for (k=0;k<2;k++)
+   {
+      dec[k] = opus_decoder_create(SPAN_FS, 1, &err);
+      if (err != OPUS_OK || dec[k] == NULL) test_failed();
+   }
+   err = OPUS_OK;
+   dred = opus_dred_alloc(&err);
+   if (err != OPUS_OK || dred == NULL) test_failed();
+   dred_dec = opus_dred_decoder_create(&err);
+   if (err != OPUS_OK || dred_dec == NULL) test_failed();
+
+   /* Bursts of 2 to 5 frames every 25 frames, after a second of warm-up */
+   nb_bursts = 0;
+   i = 0;
+   while (i < SPAN_NB_FRAMES)
+   {
+      int burst;
+      burst = 2 + (i/25)%4;
+      if (i >= 50 && i%25 == 0 && i+burst < SPAN_NB_FRAMES)
+      {
+         int ret, dred_end;
+         ret = opus_dred_parse(dred_dec, dred, packets[i+burst], len[i+burst],
+               SPAN_FS, SPAN_FS, &dred_end, 0);
+         if (ret < burst*SPAN_FRAME) test_failed();
+         if (opus_decoder_dred_decode(dec[0], dred, burst*SPAN_FRAME, out_span,
+               burst*SPAN_FRAME) != burst*SPAN_FRAME) test_failed();
+         for (j=0;j<burst;j++)
+         {
+            if (opus_decoder_dred_decode(dec[1], dred, (burst-j)*SPAN_FRAME,
+                  out_frames+j*SPAN_FRAME, SPAN_FRAME) != SPAN_FRAME) test_failed();
+         }
+         if (memcmp(out_span, out_frames, burst*SPAN_FRAME*sizeof(*out_span)) != 0)
+            test_failed();
+         nb_bursts++;
+         i += burst;
+         continue;
+      }
+      for (k=0;k<2;k++)
+      {
+         if (opus_decode(dec[k], packets[i], len[i], k ? out_frames : out_span,
+               SPAN_FRAME, 0) != SPAN_FRAME) test_failed();
+      }
+      if (memcmp(out_span, out_frames, SPAN_FRAME*sizeof(*out_span)) != 0)
+         test_failed();
+      i++;
+   }
+   if (nb_bursts != 4) test_failed();
+
+   for (k=0;k<2;k++)
+      opus_decoder_destroy(dec[k]);
+   opus_dred_free(dred);
+   opus_dred_decoder_destroy(dred_dec);
+}
+
+/* Mean squared difference between the features of the two most recent DRED
+   latents (the part of the redundancy that overlaps the most between packets). */
+static double dred_feature_distance(const OpusDRED *a, const OpusDRED *b)
+{
+   int i, nb;
+   double dist;
+   nb = 4*IMIN(2, IMIN(a->nb_latents, b->nb_latents))*DRED_NUM_FEATURES;
+   dist = 0;
+   for (i=0;i<nb;i++)
+   {
+      double d = a->fec_features[i] - b->fec_features[i];
+      dist += d*d;
+   }
+   return dist/IMAX(nb, 1);
+}
+
+/* Encodes 48 kHz wideband speech with DRED while switching between SILK-only,
+   where DRED takes SILK's 16 kHz signal, and CELT-only, where it resamples the
+   input itself. A CELT-only encoder is the reference and an always-SILK one
+   gives the difference due to the resamplers alone. Switching must not move
+   the DRED timeline: the offsets and latent counts must match the reference in
+   every packet, and the features must not drift further from it than the
+   always-SILK ones. */
+void test_dred_mode_switching(void)
+{
+   OpusEncoder *enc[3];
+   OpusDREDDecoder *dred_dec;
+   OpusDRED *dred[3];
+   opus_int16 pcm[SWITCH_FRAME];
+   float x[SWITCH_FRAME];
+   double dist_silk, dist_switch;
+   int i, j, k, err;
+
+   for (k=0;k<3;k++)
+   {
+      enc[k] = opus_encoder_create(SWITCH_FS, 1, OPUS_APPLICATION_VOIP, &err);
+      if (err != OPUS_OK || enc[k] == NULL) test_failed();
+      if (opus_encoder_ctl(enc[k], OPUS_SET_BITRATE(32000)) != OPUS_OK) test_failed();
+      if (opus_encoder_ctl(enc[k], OPUS_SET_BANDWIDTH(OPUS_BANDWIDTH_WIDEBAND)) != OPUS_OK) test_failed();
+      if (opus_encoder_ctl(enc[k], OPUS_SET_PACKET_LOSS_PERC(20)) != OPUS_OK) test_failed();
+      if (opus_encoder_ctl(enc[k], OPUS_SET_DRED_DURATION(100)) != OPUS_OK) test_failed();
+      err = OPUS_OK;
+      dred[k] = opus_dred_alloc(&err);
+      if (err != OPUS_OK || dred[k] == NULL) test_failed();
+   }
+   dred_dec = opus_dred_decoder_create(&err);
+   if (err != OPUS_OK || dred_dec == NULL) test_failed();
+   if (opus_encoder_ctl(enc[0], OPUS_SET_FORCE_MODE(MODE_CELT_ONLY)) != OPUS_OK) test_failed();
+   if (opus_encoder_ctl(enc[1], OPUS_SET_FORCE_MODE(MODE_SILK_ONLY)) != OPUS_OK) test_failed();
+
+   dist_silk = dist_switch = 0;
+   for (i=0;i<SWITCH_NB_FRAMES;i++)
+   {
+      unsigned char packet[3][1500];
+      opus_int32 len[3];
+      gating_frame(x, i*SWITCH_FRAME, SWITCH_FRAME, SWITCH_FS, GATING_SPEECH);
+      for (j=0;j<SWITCH_FRAME;j++)
+         pcm[j] = (opus_int16)floor(.5 + 32767*x[j]);
+      if (opus_encoder_ctl(enc[2], OPUS_SET_FORCE_MODE((i/SWITCH_PERIOD)&1 ? MODE_CELT_ONLY : MODE_SILK_ONLY)) != OPUS_OK)
+         test_failed();
+      for (k=0;k<3;k++)
+      {
+         len[k] = opus_encode(enc[k], pcm, SWITCH_FRAME, packet[k], sizeof(packet[k]));
+         if (len[k] < 0) test_failed();
+      }
+      if (i < SWITCH_WARMUP)
+         continue;
+      for (k=0;k<3;k++)
+      {
+         int dred_end;
+         if (opus_dred_parse(dred_dec, dred[k], packet[k], len[k], SWITCH_FS, SWITCH_FS, &dred_end, 0) <= 0)
+            test_failed();
+         if (dred[k]->dred_offset != dred[0]->dred_offset || dred[k]->nb_latents != dred[0]->nb_latents)
+            test_failed();
+      }
+      dist_silk += dred_feature_distance(dred[0], dred[1]);
+      dist_switch += dred_feature_distance(dred[0], dred[2]);
+   }
+   if (dist_switch > 4*dist_silk) test_failed();
+
+   for (k=0;k<3;k++)
+   {
+      opus_encoder_destroy(enc[k]);
+      opus_dred_free(dred[k]);
+   }
+   opus_dred_decoder_destroy(dred_dec);
+}
+
 int main(int argc, char **argv)
 {
    int env_used;
@@ -102,6 +434,9 @@ int main(int argc, char **argv)
    if(env_used)fprintf(stderr,"  Random seed set from the environment (SEED=%s).\n", env_seed);
 
    test_random_dred();
+   test_dred_activity_gating();
+   test_dred_span_recovery();
+   test_dred_mode_switching();
    fprintf(stderr,"Tests completed successfully.\n");
    return 0;
 }
@@ -278,6 +278,7 @@ void fuzz_encoder_settings(const int num_encoders, const int num_setting_changes
          if(opus_encoder_ctl(enc, OPUS_SET_EXPERT_FRAME_DURATION(frame_size_enum)) != OPUS_OK) test_failed();
 #ifdef ENABLE_DRED
          if(opus_encoder_ctl(enc, OPUS_SET_DRED_DURATION(fast_rand()%101)) != OPUS_OK) test_failed();
+         if(opus_encoder_ctl(enc, OPUS_SET_DRED_ACTIVITY_GATING(fast_rand()&1)) != OPUS_OK) test_failed();
 #endif
          if(test_encode(enc, num_channels, frame_size, dec)) {
             fprintf(stderr,
@@ -307,6 +308,7 @@ int run_test1(int no_fuzz)
    int rc,err;
    OpusEncoder *enc;
    OpusMSEncoder *MSenc;
+   OpusCPUBudget *budget;
    OpusDecoder *dec;
    OpusMSDecoder *MSdec;
    OpusMSDecoder *MSdec_err;
@@ -356,6 +358,10 @@ int run_test1(int no_fuzz)
    MSenc = opus_multistream_encoder_create(8000, 2, 2, 0, mapping, OPUS_APPLICATION_AUDIO, &err);
    if(err != OPUS_OK || MSenc==NULL)test_failed();
 
+   /*Tight enough for the controller to actually lower the complexity*/
+   budget = opus_cpu_budget_create(500, &err);
+   if(err != OPUS_OK || budget==NULL)test_failed();
+
    /*Some multistream encoder API tests*/
    if(opus_multistream_encoder_ctl(MSenc, OPUS_GET_BITRATE(&i))!=OPUS_OK)test_failed();
    if(opus_multistream_encoder_ctl(MSenc, OPUS_GET_LSB_DEPTH(&i))!=OPUS_OK)test_failed();
@@ -461,6 +467,7 @@ int run_test1(int no_fuzz)
             if(opus_encoder_ctl(enc, OPUS_SET_BITRATE(rate))!=OPUS_OK)test_failed();
             if(opus_encoder_ctl(enc, OPUS_SET_FORCE_CHANNELS((rates[j]>=64000?2:1)))!=OPUS_OK)test_failed();
             if(opus_encoder_ctl(enc, OPUS_SET_COMPLEXITY((count>>2)%11))!=OPUS_OK)test_failed();
+            if(opus_encoder_ctl(enc, OPUS_SET_CPU_BUDGET((fast_rand()&7)==0?budget:NULL))!=OPUS_OK)test_failed();
             if(opus_encoder_ctl(enc, OPUS_SET_PACKET_LOSS_PERC((fast_rand()&15)&(fast_rand()%15)))!=OPUS_OK)test_failed();
             bw=modes[j]==0?OPUS_BANDWIDTH_NARROWBAND+(fast_rand()%3):
                modes[j]==1?OPUS_BANDWIDTH_SUPERWIDEBAND+(fast_rand()&1):
@@ -532,6 +539,7 @@ int run_test1(int no_fuzz)
             if(opus_multistream_encoder_ctl(MSenc, OPUS_SET_PREDICTION_DISABLED((int)(fast_rand()&15)<(pred?11:4)))!=OPUS_OK)test_failed();
             frame_size=frame[j];
             if(opus_multistream_encoder_ctl(MSenc, OPUS_SET_COMPLEXITY((count>>2)%11))!=OPUS_OK)test_failed();
+            if(opus_multistream_encoder_ctl(MSenc, OPUS_SET_CPU_BUDGET((fast_rand()&7)==0?budget:NULL))!=OPUS_OK)test_failed();
             if(opus_multistream_encoder_ctl(MSenc, OPUS_SET_PACKET_LOSS_PERC((fast_rand()&15)&(fast_rand()%15)))!=OPUS_OK)test_failed();
             if((fast_rand()&255)==0)
             {
@@ -652,6 +660,7 @@ int run_test1(int no_fuzz)
    opus_encoder_destroy(enc);
    if(opus_multistream_encoder_ctl(MSenc, OPUS_RESET_STATE)!=OPUS_OK)test_failed();
    opus_multistream_encoder_destroy(MSenc);
+   opus_cpu_budget_destroy(budget);
    if(opus_decoder_ctl(dec, OPUS_RESET_STATE)!=OPUS_OK)test_failed();
    opus_decoder_destroy(dec);
    if(opus_multistream_decoder_ctl(MSdec, OPUS_RESET_STATE)!=OPUS_OK)test_failed();
@@ -664,6 +673,77 @@ int run_test1(int no_fuzz)
    return 0;
 }
 
+/* Trial-encodes every frame with other settings between a snapshot and a
+   restore, and checks the packets match an encoder that never did. */
+void test_snapshot(void)
+{
+   static const int apps[3] = {OPUS_APPLICATION_VOIP, OPUS_APPLICATION_AUDIO,
+         OPUS_APPLICATION_RESTRICTED_LOWDELAY};
+   short *inbuf;
+   unsigned char packet[MAX_PACKET];
+   unsigned char trial[MAX_PACKET];
+   unsigned char ref[MAX_PACKET];
+   void *snapshot;
+   int channels, a, i, err;
+   inbuf=(short *)malloc(sizeof(*inbuf)*SSAMPLES*2);
+   generate_music(inbuf, SSAMPLES);
+   for(channels=1;channels<=2;channels++)
+   {
+      int snapshot_size;
+      snapshot_size=opus_encoder_get_snapshot_size(channels);
+      if(snapshot_size<=0||snapshot_size>=opus_encoder_get_size(channels))test_failed();
+      snapshot=malloc(snapshot_size);
+      if(!snapshot)test_failed();
+      for(a=0;a<3;a++)
+      {
+         OpusEncoder *enc, *enc_ref;
+         enc=opus_encoder_create(48000, channels, apps[a], &err);
+         if(err!=OPUS_OK || enc==NULL)test_failed();
+         enc_ref=opus_encoder_create(48000, channels, apps[a], &err);
+         if(err!=OPUS_OK || enc_ref==NULL)test_failed();
+         for(i=0;i<200;i++)
+         {
+            opus_int32 bitrate;
+            opus_uint32 rng, rng_ref;
+            int frame_size, len, len_ref, len_trial;
+            short *pcm;
+            frame_size=i&1?960:480;
+            pcm=&inbuf[(i*960)%(SSAMPLES-960)*channels];
+            bitrate=(i*7919)%64000+8000;
+            if(opus_encoder_ctl(enc, OPUS_SET_BITRATE(bitrate))!=OPUS_OK)test_failed();
+            if(opus_encoder_ctl(enc_ref, OPUS_SET_BITRATE(bitrate))!=OPUS_OK)test_failed();
+            if(opus_encoder_snapshot(enc, snapshot)!=OPUS_OK)test_failed();
+            if(opus_encoder_ctl(enc, OPUS_SET_BITRATE(bitrate/2+6000))!=OPUS_OK)test_failed();
+            if(opus_encoder_ctl(enc, OPUS_SET_INBAND_FEC(1))!=OPUS_OK)test_failed();
+            if(opus_encoder_ctl(enc, OPUS_SET_PACKET_LOSS_PERC(20))!=OPUS_OK)test_failed();
+            len_trial=opus_encode(enc, pcm, frame_size, trial, MAX_PACKET);
+            if(len_trial<=0)test_failed();
+            if(opus_encoder_restore(enc, snapshot)!=OPUS_OK)test_failed();
+            len=opus_encode(enc, pcm, frame_size, packet, MAX_PACKET);
+            len_ref=opus_encode(enc_ref, pcm, frame_size, ref, MAX_PACKET);
+            if(len<=0||len!=len_ref||memcmp(packet, ref, len)!=0)test_failed();
+            opus_encoder_ctl(enc, OPUS_GET_FINAL_RANGE(&rng));
+            opus_encoder_ctl(enc_ref, OPUS_GET_FINAL_RANGE(&rng_ref));
+            if(rng!=rng_ref)test_failed();
+         }
+         opus_encoder_destroy(enc);
+         opus_encoder_destroy(enc_ref);
+      }
+      if(channels==2)
+      {
+         /* A snapshot from an encoder with another channel count is refused. */
+         OpusEncoder *enc;
+         enc=opus_encoder_create(48000, 1, OPUS_APPLICATION_AUDIO, &err);
+         if(err!=OPUS_OK || enc==NULL)test_failed();
+         if(opus_encoder_restore(enc, snapshot)!=OPUS_BAD_ARG)test_failed();
+         opus_encoder_destroy(enc);
+      }
+      free(snapshot);
+   }
+   free(inbuf);
+   fprintf(stdout,"    Encoder snapshot/restore OK.\n");
+}
+
 void print_usage(char* _argv[])
 {
    fprintf(stderr,"Usage: %s [<seed>] [-fuzz <num_encoders> <num_settings_per_encoder>]\n",_argv[0]);
@@ -725,6 +805,8 @@ int main(int _argc, char **_argv)
      may cause the decoders to clip, which angers CLANG IOC.*/
    run_test1(getenv("TEST_OPUS_NOFUZZ")!=NULL);
 
+   test_snapshot();
+
    /* Fuzz encoder settings online */
    if(getenv("TEST_OPUS_NOFUZZ")==NULL) {
       fprintf(stderr,"Running fuzz_encoder_settings with %d encoder(s) and %d setting change(s) each.\n",
@@ -0,0 +1,470 @@
+/* Copyright (c) 2025 Xiph.Org Foundation */
+/*
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   - Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+   - Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+   OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+   EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+   PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Sweeps the encoder, decoder and multistream objects over all modes and
+   frame sizes and reports the scratch memory each of them needed, as
+   returned by OPUS_GET_SCRATCH_USAGE. This is only meaningful when the
+   library is built with OPUS_SCRATCH_ARENA or OPUS_NONTHREADSAFE_PSEUDOSTACK;
+   other builds only check that the request is reported as unimplemented. */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "opus_multistream.h"
+#include "opus.h"
+#include "../src/opus_private.h"
+#include "test_opus_common.h"
+
+#define MAX_PACKET (1500)
+#define MAX_FRAME_SAMP (5760)
+#define MAX_CHANNELS (8)
+#define NB_FRAME_SIZES (9)
+
+/* Frame sizes in units of 2.5 ms */
+static const int frame_units[NB_FRAME_SIZES] = {1, 2, 4, 8, 16, 24, 32, 40, 48};
+
+enum {
+   OBJ_ENCODER,
+   OBJ_DECODER,
+   OBJ_MS_ENCODER,
+   OBJ_MS_DECODER,
+   NB_OBJECTS
+};
+
+static const char *object_names[NB_OBJECTS] = {
+   "encoder", "decoder", "ms encoder", "ms decoder"
+};
+
+/* Largest per-call usage seen, per object type and frame size */
+static opus_int32 usage[NB_OBJECTS][NB_FRAME_SIZES];
+
+static short pcm[MAX_FRAME_SAMP*MAX_CHANNELS];
+static short out[MAX_FRAME_SAMP*MAX_CHANNELS];
+#ifndef DISABLE_FLOAT_API
+static float fpcm[MAX_FRAME_SAMP*MAX_CHANNELS];
+static float fout[MAX_FRAME_SAMP*MAX_CHANNELS];
+#endif
+
+static void generate_signal(int len)
+{
+   int i;
+   for (i=0;i<len;i++)
+   {
+      /* Noise bursts over a slowly varying square wave */
+      int v = ((i/97)&1 ? 8000 : -8000) + (int)(fast_rand()%4001) - 2000;
+      if ((i/1500)%3 == 0)
+         v /= 64;
+      pcm[i] = (short)v;
+#ifndef DISABLE_FLOAT_API
+      fpcm[i] = v*(1.f/32768.f);
+#endif
+   }
+}
+
+/* Checks the usage reported after a call and records it. */
+static void check_usage(int obj, int fsize, opus_int32 last, opus_int32 peak,
+      opus_int32 *expected_peak)
+{
+   if (last <= 0 || last > peak) test_failed();
+   if (last > *expected_peak)
+      *expected_peak = last;
+   if (peak != *expected_peak) test_failed();
+   if (last > usage[obj][fsize])
+      usage[obj][fsize] = last;
+}
+
+static void check_encoder(OpusEncoder *enc, int fsize, opus_int32 *expected_peak)
+{
+   opus_int32 last, peak;
+   if (opus_encoder_ctl(enc, OPUS_GET_SCRATCH_USAGE(&last)) != OPUS_OK) test_failed();
+   if (opus_encoder_ctl(enc, OPUS_GET_PEAK_SCRATCH_USAGE(&peak)) != OPUS_OK) test_failed();
+   check_usage(OBJ_ENCODER, fsize, last, peak, expected_peak);
+}
+
+static void check_decoder(OpusDecoder *dec, int fsize, opus_int32 *expected_peak)
+{
+   opus_int32 last, peak;
+   if (opus_decoder_ctl(dec, OPUS_GET_SCRATCH_USAGE(&last)) != OPUS_OK) test_failed();
+   if (opus_decoder_ctl(dec, OPUS_GET_PEAK_SCRATCH_USAGE(&peak)) != OPUS_OK) test_failed();
+   check_usage(OBJ_DECODER, fsize, last, peak, expected_peak);
+}
+
+static void check_ms_encoder(OpusMSEncoder *enc, int fsize, opus_int32 *expected_peak)
+{
+   opus_int32 last, peak;
+   if (opus_multistream_encoder_ctl(enc, OPUS_GET_SCRATCH_USAGE(&last)) != OPUS_OK) test_failed();
+   if (opus_multistream_encoder_ctl(enc, OPUS_GET_PEAK_SCRATCH_USAGE(&peak)) != OPUS_OK) test_failed();
+   check_usage(OBJ_MS_ENCODER, fsize, last, peak, expected_peak);
+}
+
+static void check_ms_decoder(OpusMSDecoder *dec, int fsize, opus_int32 *expected_peak)
+{
+   opus_int32 last, peak;
+   if (opus_multistream_decoder_ctl(dec, OPUS_GET_SCRATCH_USAGE(&last)) != OPUS_OK) test_failed();
+   if (opus_multistream_decoder_ctl(dec, OPUS_GET_PEAK_SCRATCH_USAGE(&peak)) != OPUS_OK) test_failed();
+   check_usage(OBJ_MS_DECODER, fsize, last, peak, expected_peak);
+}
+
+/* Returns 1 if the library reports scratch usage, 0 if it was built without
+   a scratch arena. */
+static int test_availability(void)
+{
+   OpusEncoder *enc;
+   OpusDecoder *dec;
+   OpusMSEncoder *msenc;
+   OpusMSDecoder *msdec;
+   unsigned char mapping[2] = {0, 1};
+   opus_int32 last, peak;
+   int err, ret;
+
+   enc = opus_encoder_create(48000, 2, OPUS_APPLICATION_AUDIO, &err);
+   if (err != OPUS_OK || enc == NULL) test_failed();
+   dec = opus_decoder_create(48000, 2, &err);
+   if (err != OPUS_OK || dec == NULL) test_failed();
+   msenc = opus_multistream_encoder_create(48000, 2, 1, 1, mapping, OPUS_APPLICATION_AUDIO, &err);
+   if (err != OPUS_OK || msenc == NULL) test_failed();
+   msdec = opus_multistream_decoder_create(48000, 2, 1, 1, mapping, &err);
+   if (err != OPUS_OK || msdec == NULL) test_failed();
+
+   ret = opus_encoder_ctl(enc, OPUS_GET_SCRATCH_USAGE(&last));
+   if (ret == OPUS_UNIMPLEMENTED)
+   {
+      if (opus_encoder_ctl(enc, OPUS_GET_PEAK_SCRATCH_USAGE(&peak)) != OPUS_UNIMPLEMENTED) test_failed();
+      if (opus_decoder_ctl(dec, OPUS_GET_SCRATCH_USAGE(&last)) != OPUS_UNIMPLEMENTED) test_failed();
+      if (opus_decoder_ctl(dec, OPUS_GET_PEAK_SCRATCH_USAGE(&peak)) != OPUS_UNIMPLEMENTED) test_failed();
+      if (opus_multistream_encoder_ctl(msenc, OPUS_GET_SCRATCH_USAGE(&last)) != OPUS_UNIMPLEMENTED) test_failed();
+      if (opus_multistream_decoder_ctl(msdec, OPUS_GET_SCRATCH_USAGE(&last)) != OPUS_UNIMPLEMENTED) test_failed();
+   } else {
+      if (ret != OPUS_OK || last != 0) test_failed();
+      if (opus_encoder_ctl(enc, OPUS_GET_PEAK_SCRATCH_USAGE(&peak)) != OPUS_OK || peak != 0) test_failed();
+      if (opus_decoder_ctl(dec, OPUS_GET_SCRATCH_USAGE(&last)) != OPUS_OK || last != 0) test_failed();
+      if (opus_decoder_ctl(dec, OPUS_GET_PEAK_SCRATCH_USAGE(&peak)) != OPUS_OK || peak != 0) test_failed();
+      if (opus_multistream_encoder_ctl(msenc, OPUS_GET_SCRATCH_USAGE(&last)) != OPUS_OK || last != 0) test_failed();
+      if (opus_multistream_decoder_ctl(msdec, OPUS_GET_SCRATCH_USAGE(&last)) != OPUS_OK || last != 0) test_failed();
+      if (opus_encoder_ctl(enc, OPUS_GET_SCRATCH_USAGE_REQUEST, (opus_int32*)NULL) != OPUS_BAD_ARG) test_failed();
+      if (opus_decoder_ctl(dec, OPUS_GET_PEAK_SCRATCH_USAGE_REQUEST, (opus_int32*)NULL) != OPUS_BAD_ARG) test_failed();
+   }
+
+   opus_encoder_destroy(enc);
+   opus_decoder_destroy(dec);
+   opus_multistream_encoder_destroy(msenc);
+   opus_multistream_decoder_destroy(msdec);
+   return ret == OPUS_OK;
+}
+
+static void test_encoder_decoder(void)
+{
+   static const opus_int32 rates[3] = {8000, 16000, 48000};
+   static const int modes[4] = {OPUS_AUTO, MODE_SILK_ONLY, MODE_HYBRID, MODE_CELT_ONLY};
+   static const int complexities[2] = {0, 10};
+   int r, c, m, f, x, api;
+
+   for (r=0;r<3;r++)
+   {
+      for (c=1;c<=2;c++)
+      {
+         for (m=0;m<4;m++)
+         {
+            for (f=0;f<NB_FRAME_SIZES;f++)
+            {
+               for (x=0;x<2;x++)
+               {
+                  OpusEncoder *enc;
+                  OpusDecoder *dec;
+                  opus_int32 enc_peak=0, dec_peak=0;
+                  opus_int32 peak;
+                  int frame_size, err, i;
+
+                  frame_size = rates[r]/400*frame_units[f];
+                  enc = opus_encoder_create(rates[r], c, OPUS_APPLICATION_AUDIO, &err);
+                  if (err != OPUS_OK || enc == NULL) test_failed();
+                  dec = opus_decoder_create(rates[r], c, &err);
+                  if (err != OPUS_OK || dec == NULL) test_failed();
+                  if (opus_encoder_ctl(enc, OPUS_SET_FORCE_MODE(modes[m])) != OPUS_OK) test_failed();
+                  if (opus_encoder_ctl(enc, OPUS_SET_COMPLEXITY(complexities[x])) != OPUS_OK) test_failed();
+                  if (opus_encoder_ctl(enc, OPUS_SET_INBAND_FEC(1)) != OPUS_OK) test_failed();
+                  if (opus_encoder_ctl(enc, OPUS_SET_PACKET_LOSS_PERC(20)) != OPUS_OK) test_failed();
+                  for (api=0;api<2;api++)
+                  {
+                     for (i=0;i<3;i++)
+                     {
+                        unsigned char packet[MAX_PACKET];
+                        int len, ret;
+                        if (opus_encoder_ctl(enc, OPUS_SET_BITRATE(i==2 ? 256000 : 12000+i*40000)) != OPUS_OK) test_failed();
+                        generate_signal(frame_size*c);
+#ifndef DISABLE_FLOAT_API
+                        if (api)
+                           len = opus_encode_float(enc, fpcm, frame_size, packet, MAX_PACKET);
+                        else
+#endif
+                           len = opus_encode(enc, pcm, frame_size, packet, MAX_PACKET);
+                        if (len < 0) test_failed();
+                        check_encoder(enc, f, &enc_peak);
+#ifndef DISABLE_FLOAT_API
+                        if (api)
+                           ret = opus_decode_float(dec, packet, len, fout, MAX_FRAME_SAMP, 0);
+                        else
+#endif
+                           ret = opus_decode(dec, packet, len, out, MAX_FRAME_SAMP, 0);
+                        if (ret != frame_size) test_failed();
+                        check_decoder(dec, f, &dec_peak);
+                        /* Packet loss concealment, then FEC */
+                        ret = opus_decode(dec, NULL, 0, out, frame_size, 0);
+                        if (ret != frame_size) test_failed();
+                        check_decoder(dec, f, &dec_peak);
+                        ret = opus_decode(dec, packet, len, out, frame_size, 1);
+                        if (ret != frame_size) test_failed();
+                        check_decoder(dec, f, &dec_peak);
+                     }
+                  }
+                  /* The lifetime peak survives a reset */
+                  if (opus_encoder_ctl(enc, OPUS_RESET_STATE) != OPUS_OK) test_failed();
+                  if (opus_encoder_ctl(enc, OPUS_GET_PEAK_SCRATCH_USAGE(&peak)) != OPUS_OK || peak != enc_peak) test_failed();
+                  if (opus_decoder_ctl(dec, OPUS_RESET_STATE) != OPUS_OK) test_failed();
+                  if (opus_decoder_ctl(dec, OPUS_GET_PEAK_SCRATCH_USAGE(&peak)) != OPUS_OK || peak != dec_peak) test_failed();
+                  opus_encoder_destroy(enc);
+                  opus_decoder_destroy(dec);
+               }
+            }
+         }
+      }
+   }
+   fprintf(stdout,"    encoder/decoder sweep ........................ OK.\n");
+}
+
+static void test_multistream(void)
+{
+   int channels, f, api;
+
+   for (channels=1;channels<=MAX_CHANNELS;channels++)
+   {
+      for (f=0;f<NB_FRAME_SIZES;f++)
+      {
+         OpusMSEncoder *enc;
+         OpusMSDecoder *dec;
+         unsigned char mapping[MAX_CHANNELS];
+         opus_int32 enc_peak=0, dec_peak=0;
+         int streams, coupled_streams;
+         int frame_size, err, i;
+
+         frame_size = 48000/400*frame_units[f];
+         enc = opus_multistream_surround_encoder_create(48000, channels, 1, &streams,
+               &coupled_streams, mapping, OPUS_APPLICATION_AUDIO, &err);
+         if (err != OPUS_OK || enc == NULL) test_failed();
+         dec = opus_multistream_decoder_create(48000, channels, streams,
+               coupled_streams, mapping, &err);
+         if (err != OPUS_OK || dec == NULL) test_failed();
+         for (api=0;api<2;api++)
+         {
+            for (i=0;i<2;i++)
+            {
+               unsigned char packet[MAX_PACKET*MAX_CHANNELS];
+               int len, ret;
+               if (opus_multistream_encoder_ctl(enc, OPUS_SET_BITRATE(i ? 128000*channels : 16000*channels)) != OPUS_OK) test_failed();
+               generate_signal(frame_size*channels);
+#ifndef DISABLE_FLOAT_API
+               if (api)
+                  len = opus_multistream_encode_float(enc, fpcm, frame_size, packet, sizeof(packet));
+               else
+#endif
+                  len = opus_multistream_encode(enc, pcm, frame_size, packet, sizeof(packet));
+               if (len < 0) test_failed();
+               check_ms_encoder(enc, f, &enc_peak);
+#ifndef DISABLE_FLOAT_API
+               if (api)
+                  ret = opus_multistream_decode_float(dec, packet, len, fout, MAX_FRAME_SAMP, 0);
+               else
+#endif
+                  ret = opus_multistream_decode(dec, packet, len, out, MAX_FRAME_SAMP, 0);
+               if (ret != frame_size) test_failed();
+               check_ms_decoder(dec, f, &dec_peak);
+               ret = opus_multistream_decode(dec, NULL, 0, out, frame_size, 0);
+               if (ret != frame_size) test_failed();
+               check_ms_decoder(dec, f, &dec_peak);
+            }
+         }
+         opus_multistream_encoder_destroy(enc);
+         opus_multistream_decoder_destroy(dec);
+      }
+   }
+   fprintf(stdout,"    multistream sweep ............................ OK.\n");
+}
+
+/* Deep redundancy (DRED) recovery runs the neural vocoder from within the
+   decoder, so it gets its own check. Skipped when DRED is not built in. */
+static void test_dred(void)
+{
+   OpusEncoder *enc;
+   OpusDecoder *dec;
+   OpusDREDDecoder *dred_dec;
+   OpusDRED *dred;
+   opus_int32 dec_peak=0;
+   int i, err;
+   int nb_recovered=0;
+
+   err = OPUS_OK;
+   dred = opus_dred_alloc(&err);
+   if (err == OPUS_UNIMPLEMENTED)
+   {
+      fprintf(stdout,"    DRED ......................................... skipped.\n");
+      return;
+   }
+   if (err != OPUS_OK || dred == NULL) test_failed();
+   dred_dec = opus_dred_decoder_create(&err);
+   if (err != OPUS_OK || dred_dec == NULL) test_failed();
+   enc = opus_encoder_create(16000, 1, OPUS_APPLICATION_VOIP, &err);
+   if (err != OPUS_OK || enc == NULL) test_failed();
+   dec = opus_decoder_create(16000, 1, &err);
+   if (err != OPUS_OK || dec == NULL) test_failed();
+   if (opus_encoder_ctl(enc, OPUS_SET_BITRATE(32000)) != OPUS_OK) test_failed();
+   if (opus_encoder_ctl(enc, OPUS_SET_PACKET_LOSS_PERC(20)) != OPUS_OK) test_failed();
+   if (opus_encoder_ctl(enc, OPUS_SET_DRED_DURATION(100)) != OPUS_OK) test_failed();
+   for (i=0;i<50;i++)
+   {
+      unsigned char packet[MAX_PACKET];
+      int len, ret, dred_end;
+      generate_signal(320);
+      len = opus_encode(enc, pcm, 320, packet, MAX_PACKET);
+      if (len < 0) test_failed();
+      /* Lose every other packet and recover it from the next one */
+      if (!(i&1))
+         continue;
+      ret = opus_dred_parse(dred_dec, dred, packet, len, 16000, 16000, &dred_end, 0);
+      if (ret < 0) test_failed();
+      if (ret >= 320)
+      {
+         ret = opus_decoder_dred_decode(dec, dred, 320, out, 320);
+         nb_recovered++;
+      } else {
+         ret = opus_decode(dec, NULL, 0, out, 320, 0);
+      }
+      if (ret != 320) test_failed();
+      check_decoder(dec, 3, &dec_peak);
+      ret = opus_decode(dec, packet, len, out, 320, 0);
+      if (ret != 320) test_failed();
+      check_decoder(dec, 3, &dec_peak);
+   }
+   if (nb_recovered == 0) test_failed();
+   opus_encoder_destroy(enc);
+   opus_decoder_destroy(dec);
+   opus_dred_free(dred);
+   opus_dred_decoder_destroy(dred_dec);
+   fprintf(stdout,"    DRED ......................................... OK.\n");
+}
+
+static void print_summary(void)
+{
+   int obj, f;
+   opus_int32 max_usage[NB_OBJECTS] = {0};
+   fprintf(stdout,"\n  Largest scratch usage per call (bytes):\n");
+   fprintf(stdout,"    %-8s", "frame");
+   for (obj=0;obj<NB_OBJECTS;obj++)
+      fprintf(stdout," %11s", object_names[obj]);
+   fprintf(stdout,"\n");
+   for (f=0;f<NB_FRAME_SIZES;f++)
+   {
+      fprintf(stdout,"    %5.1f ms", frame_units[f]*2.5);
+      for (obj=0;obj<NB_OBJECTS;obj++)
+      {
+         fprintf(stdout," %11ld", (long)usage[obj][f]);
+         if (usage[obj][f] > max_usage[obj])
+            max_usage[obj] = usage[obj][f];
+      }
+      fprintf(stdout,"\n");
+   }
+   fprintf(stdout,"    %-8s", "all");
+   for (obj=0;obj<NB_OBJECTS;obj++)
+      fprintf(stdout," %11ld", (long)max_usage[obj]);
+   fprintf(stdout,"\n\n");
+}
+
+/* PLC, FEC and DRED requests are not limited to the 120 ms a packet can
+   hold, so the library must not size temporary buffers from them. */
+static void test_long_requests(void)
+{
+   OpusEncoder *enc;
+   OpusDecoder *dec;
+   unsigned char packet[MAX_PACKET];
+   int len, ret, err;
+   enc = opus_encoder_create(48000, 2, OPUS_APPLICATION_VOIP, &err);
+   if (err != OPUS_OK || enc == NULL) test_failed();
+   dec = opus_decoder_create(48000, 2, &err);
+   if (err != OPUS_OK || dec == NULL) test_failed();
+   if (opus_encoder_ctl(enc, OPUS_SET_INBAND_FEC(1)) != OPUS_OK) test_failed();
+   if (opus_encoder_ctl(enc, OPUS_SET_PACKET_LOSS_PERC(20)) != OPUS_OK) test_failed();
+   if (opus_encoder_ctl(enc, OPUS_SET_FORCE_MODE(MODE_SILK_ONLY)) != OPUS_OK) test_failed();
+   generate_signal(960*2);
+   len = opus_encode(enc, pcm, 960, packet, MAX_PACKET);
+   if (len < 0) test_failed();
+   if (opus_decode(dec, packet, len, out, MAX_FRAME_SAMP, 0) != 960) test_failed();
+   /* 240 ms of PLC, then 250 ms ending with FEC */
+   ret = opus_decode(dec, NULL, 0, out, 2*MAX_FRAME_SAMP, 0);
+   if (ret != 2*MAX_FRAME_SAMP) test_failed();
+   ret = opus_decode(dec, packet, len, out, 2*MAX_FRAME_SAMP+480, 1);
+   if (ret != 2*MAX_FRAME_SAMP+480) test_failed();
+#ifndef DISABLE_FLOAT_API
+   ret = opus_decode_float(dec, NULL, 0, fout, 2*MAX_FRAME_SAMP, 0);
+   if (ret != 2*MAX_FRAME_SAMP) test_failed();
+   ret = opus_decode_float(dec, packet, len, fout, 2*MAX_FRAME_SAMP+480, 1);
+   if (ret != 2*MAX_FRAME_SAMP+480) test_failed();
+#endif
+   opus_encoder_destroy(enc);
+   opus_decoder_destroy(dec);
+   fprintf(stdout,"    long PLC/FEC requests ........................ OK.\n");
+}
+
+int main(int _argc, char **_argv)
+{
+   const char * oversion;
+   (void)_argc;
+   (void)_argv;
+
+   iseed = 0;
+   Rw = Rz = iseed;
+
+   oversion = opus_get_version_string();
+   if (!oversion) test_failed();
+   fprintf(stdout,"Testing scratch usage reporting of %s.\n", oversion);
+
+   test_long_requests();
+
+   if (!test_availability())
+   {
+      fprintf(stdout,"  Scratch usage is not available in this build.\n");
+      fprintf(stdout,"All scratch usage tests passed.\n");
+      return EXIT_SUCCESS;
+   }
+   test_encoder_decoder();
+   test_multistream();
+   test_dred();
+   print_summary();
+   fprintf(stdout,"All scratch usage tests passed.\n");
+   return EXIT_SUCCESS;
+}